@@ -94,6 +94,22 @@ bool writeMatrix(std::string const& filename, MatrixInt const& matrix)
     return true;
 }
 
+/** Prints the values of a matrix to the console, one row per line.*/
+void printMatrix(MatrixInt const& matrix)
+{
+    unsigned int rowCount = matrix.getRowCount();
+    unsigned int columnCount = matrix.getColumnCount();
+
+    for (size_t i = 0; i < rowCount; ++i)
+    {
+        for (size_t j = 0; j < columnCount; ++j)
+        {
+            std::cout << matrix.data()[i * columnCount + j] << " ";
+        }
+        std::cout << std::endl;
+    }
+}
+
 int main()
 {
     std::string matrix1path;
@@ -119,6 +135,10 @@ int main()
         loadMatrix(matrix2path, matrix2))
     {
         MatrixInt resultMatrix = matrix1 * matrix2;
+
+        std::cout << "Result Matrix: " << std::endl;
+        printMatrix(resultMatrix);
+
         writeMatrix("matrix3.txt", resultMatrix);
     }
     else
@@ -0,0 +1,217 @@
+#ifndef Matrix_hpp
+#define Matrix_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace expr
+{
+    template<class E>
+    class Expression;
+
+    enum class Mode;
+}
+
+static constexpr unsigned int DynamicSize = 0; ///< Dimension of matrices whose size is set at runtime
+
+/**
+* Matrix with values of the arithmetic type T.
+* Matrix<T> has a size set at runtime and stores its values on the heap (see below).
+* Matrix<T, R, C> has a size fixed at compile time and stores its values inline (see MatrixFixed.hpp).
+*/
+template<class T, unsigned int R = DynamicSize, unsigned int C = DynamicSize>
+class Matrix;
+
+/**
+* Simple implementation of a matrix whose size is set at runtime.
+* The values are stored in row-major order, aligned to a cache line.
+*/
+template<class T>
+class Matrix<T, DynamicSize, DynamicSize>
+{
+    static_assert(std::is_arithmetic<T>::value, "Matrix values must be of an arithmetic type");
+
+private:
+    T* m_raw_data;              ///< Pointer to raw data storage of the matrix
+    unsigned int m_row_cnt;     ///< Number of rows of the matrix
+    unsigned int m_column_cnt;  ///< Number of columns of the matrix
+
+    /** Allocates uninitialized storage for the given number of values. */
+    static T* allocate(std::size_t count);
+    /** Releases storage obtained from allocate. */
+    static void deallocate(T* data) noexcept;
+
+    /** Combines the value of an expression with this matrix of the same size. */
+    template<class E>
+    void accumulate(E const& value, expr::Mode mode);
+
+public:
+    using value_type = T;                               ///< Type of the values
+    static constexpr std::size_t alignment = 64;        ///< Alignment of the storage in bytes
+
+    /**
+     * Default Constructor.
+     * Create matrix of size 0 with sets raw data storage pointer to nullptr.
+     */
+    Matrix();
+    /**
+     * Constructor that creates a matrix of given size, intially filled with zeros.
+     * If row or coloumn count is zero, raw data storage pointer is set to nullptr.
+     */
+    Matrix(unsigned int row_cnt, unsigned int column_cnt);
+    ~Matrix();
+    /** Copy constructor */
+    Matrix(Matrix const& other);
+    /** Move constructor */
+    Matrix(Matrix&& other) noexcept;
+    /** Copy-assignment operator */
+    Matrix& operator=(Matrix const& rhs);
+    /** Move-assigment operator */
+    Matrix& operator=(Matrix&& other) noexcept;
+
+    /** Converting constructor, e.g. to accumulate products of int matrices in 64 bits. */
+    template<class U>
+    explicit Matrix(Matrix<U> const& other);
+
+    /**
+    * Constructor that evaluates a matrix expression such as A * B + C (see MatrixExpression.hpp).
+    * If the sizes of the operands do not match, a matrix of size zero is created.
+    * Large int products are computed by Strassen-Winograd recursion (MatrixStrassen.hpp), smaller
+    * ones by the cache-blocked kernel in MatrixMultiply.hpp.
+    */
+    template<class E>
+    Matrix(expr::Expression<E> const& expression);
+    /**
+    * Assignment of a matrix expression. If this matrix already has the size of the result and is
+    * not an operand, the result is written into its storage without allocating.
+    */
+    template<class E>
+    Matrix& operator=(expr::Expression<E> const& expression);
+    /** Adds the value of an expression; products are accumulated by the multiplication kernel. */
+    template<class E>
+    Matrix& operator+=(expr::Expression<E> const& expression);
+    /** Subtracts the value of an expression. */
+    template<class E>
+    Matrix& operator-=(expr::Expression<E> const& expression);
+    /** Adds a matrix of the same size. */
+    Matrix& operator+=(Matrix const& rhs);
+    /** Subtracts a matrix of the same size. */
+    Matrix& operator-=(Matrix const& rhs);
+
+    /** Read/write access to the internal data storage of the matrix. */
+    T* data() noexcept {
+        return m_raw_data;
+    }
+
+    /** Read only access to the internal data storage of the matrix. */
+    T const* data() const noexcept {
+        return m_raw_data;
+    }
+
+    /** Returns the number of rows of the matrix. */
+    unsigned int getRowCount() const noexcept {
+        return m_row_cnt;
+    }
+
+    /** Returns the number of columns of the matrix. */
+    unsigned int getColumnCount() const noexcept {
+        return m_column_cnt;
+    }
+};
+
+template<class T>
+T* Matrix<T, DynamicSize, DynamicSize>::allocate(std::size_t count)
+{
+    return static_cast<T*>(::operator new[](count * sizeof(T), std::align_val_t(alignment)));
+}
+
+template<class T>
+void Matrix<T, DynamicSize, DynamicSize>::deallocate(T* data) noexcept
+{
+    if (data != nullptr) {
+        ::operator delete[](data, std::align_val_t(alignment));
+    }
+}
+
+template<class T>
+Matrix<T, DynamicSize, DynamicSize>::Matrix() : m_raw_data(nullptr), m_row_cnt(0), m_column_cnt(0) {
+}
+
+template<class T>
+Matrix<T, DynamicSize, DynamicSize>::Matrix(unsigned int row_cnt, unsigned int column_cnt)
+    : m_raw_data(nullptr), m_row_cnt(row_cnt), m_column_cnt(column_cnt)
+{
+    if (row_cnt > 0 && column_cnt > 0) {
+        m_raw_data = allocate(std::size_t(row_cnt) * column_cnt);
+        std::fill_n(m_raw_data, std::size_t(row_cnt) * column_cnt, T());
+    }
+}
+
+template<class T>
+Matrix<T, DynamicSize, DynamicSize>::~Matrix() {
+    deallocate(m_raw_data);
+}
+
+template<class T>
+Matrix<T, DynamicSize, DynamicSize>::Matrix(Matrix const& other)
+    : m_raw_data(nullptr), m_row_cnt(other.m_row_cnt), m_column_cnt(other.m_column_cnt)
+{
+    if (other.m_raw_data != nullptr) {
+        m_raw_data = allocate(std::size_t(m_row_cnt) * m_column_cnt);
+        std::copy_n(other.m_raw_data, std::size_t(m_row_cnt) * m_column_cnt, m_raw_data);
+    }
+}
+
+template<class T>
+Matrix<T, DynamicSize, DynamicSize>::Matrix(Matrix&& other) noexcept : Matrix() {
+    std::swap(m_raw_data, other.m_raw_data);
+    std::swap(m_row_cnt, other.m_row_cnt);
+    std::swap(m_column_cnt, other.m_column_cnt);
+}
+
+template<class T>
+Matrix<T, DynamicSize, DynamicSize>& Matrix<T, DynamicSize, DynamicSize>::operator=(Matrix const& rhs) {
+    if (this != &rhs) {
+        Matrix tmp(rhs);
+        std::swap(m_raw_data, tmp.m_raw_data);
+        std::swap(m_row_cnt, tmp.m_row_cnt);
+        std::swap(m_column_cnt, tmp.m_column_cnt);
+    }
+
+    return *this;
+}
+
+template<class T>
+Matrix<T, DynamicSize, DynamicSize>& Matrix<T, DynamicSize, DynamicSize>::operator=(Matrix&& rhs) noexcept {
+    if (this != &rhs) {
+        std::swap(m_raw_data, rhs.m_raw_data);
+        std::swap(m_row_cnt, rhs.m_row_cnt);
+        std::swap(m_column_cnt, rhs.m_column_cnt);
+    }
+
+    return *this;
+}
+
+template<class T>
+template<class U>
+Matrix<T, DynamicSize, DynamicSize>::Matrix(Matrix<U> const& other)
+    : m_raw_data(nullptr), m_row_cnt(other.getRowCount()), m_column_cnt(other.getColumnCount())
+{
+    if (other.data() != nullptr) {
+        std::size_t const size = std::size_t(m_row_cnt) * m_column_cnt;
+        m_raw_data = allocate(size);
+
+        for (std::size_t i = 0; i < size; ++i) {
+            m_raw_data[i] = static_cast<T>(other.data()[i]);
+        }
+    }
+}
+
+// Fixed-size matrices, operators and the definitions of the expression templates above
+#include "MatrixFixed.hpp"
+#include "MatrixExpression.hpp"
+
+#endif //!Matrix_hpp
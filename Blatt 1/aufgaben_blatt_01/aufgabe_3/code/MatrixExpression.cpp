@@ -0,0 +1,56 @@
+#include "MatrixExpression.hpp"
+
+#include <iostream>
+#include <limits>
+
+
+expr::ChainOrder::ChainOrder(std::vector<std::size_t> sizes)
+    : m_count(sizes.size() - 1), m_sizes(std::move(sizes)), m_split(m_count * m_count, 0)
+{
+    // Textbook matrix chain ordering in O(count^3), negligible compared to any of the products
+    std::vector<double> cost(m_count * m_count, 0.0);
+
+    for (std::size_t length = 2; length <= m_count; ++length) {
+        for (std::size_t i = 0; i + length <= m_count; ++i) {
+            std::size_t const j = i + length - 1;
+            double best = std::numeric_limits<double>::infinity();
+
+            for (std::size_t k = i; k < j; ++k) {
+                double const candidate = cost[i * m_count + k] + cost[(k + 1) * m_count + j]
+                    + double(m_sizes[i]) * double(m_sizes[k + 1]) * double(m_sizes[j + 1]);
+
+                if (candidate < best) {
+                    best = candidate;
+                    m_split[i * m_count + j] = k;
+                }
+            }
+
+            cost[i * m_count + j] = best;
+        }
+    }
+}
+
+std::size_t expr::ChainOrder::workspace(std::size_t first, std::size_t last) const
+{
+    if (first == last) {
+        return 0;
+    }
+
+    std::size_t const k = split(first, last);
+    std::size_t size = workspace(first, k) + workspace(k + 1, last);
+
+    if (first != k) {
+        size += rows(first) * columns(k);
+    }
+
+    if (k + 1 != last) {
+        size += rows(k + 1) * columns(last);
+    }
+
+    return size;
+}
+
+void expr::reportSizeMismatch(char const* operation)
+{
+    std::cerr << "Matrix " << operation << " size mismatch." << std::endl;
+}
@@ -0,0 +1,528 @@
+#ifndef MatrixExpression_hpp
+#define MatrixExpression_hpp
+
+#include "Matrix.hpp"
+#include "MatrixMultiply.hpp"
+#include "MatrixStrassen.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+* Expression templates for matrices whose size is set at runtime (Matrix<T>).
+*
+* Sums, differences and products of matrices are not computed by the operators, they return
+* lightweight nodes that reference their operands. The expression is evaluated when it is
+* assigned to a Matrix: directly into the storage of the destination if it already has the
+* right size, so that e.g. "C = A * B + D" needs no temporary matrix. "C += A * B" accumulates
+* into C inside the multiplication kernel. Products of three or more matrices are evaluated in
+* the order with the fewest multiply-adds (see multiplyChain).
+*
+* Nodes reference the matrices they were built from, so an expression must be evaluated before
+* its operands go out of scope, i.e. it should not be stored with auto.
+* Only matrices and products of matrices can be multiplied; a sum has to be assigned to a
+* Matrix before it is used as a factor. All operands must have the same value type.
+*/
+namespace expr
+{
+    /** How the value of an expression is combined with the destination. */
+    enum class Mode
+    {
+        Assign,   ///< C = value
+        Add,      ///< C += value
+        Subtract  ///< C -= value
+    };
+
+    /** Prints an error message for operands of the given operation with incompatible sizes. */
+    void reportSizeMismatch(char const* operation);
+
+    /** Parenthesization of a chain of matrices with the fewest multiply-adds. */
+    class ChainOrder
+    {
+    private:
+        std::size_t m_count;                ///< Number of matrices
+        std::vector<std::size_t> m_sizes;   ///< Matrix i is m_sizes[i] x m_sizes[i + 1]
+        std::vector<std::size_t> m_split;   ///< Last factor of the left subchain of the chain i..j
+
+    public:
+        /**
+         * Constructor. Computes the parenthesization of count matrices, where matrix i has
+         * sizes[i] rows and sizes[i + 1] columns.
+         */
+        ChainOrder(std::vector<std::size_t> sizes);
+
+        /** Returns the last factor of the left subchain of the chain first..last. */
+        std::size_t split(std::size_t first, std::size_t last) const {
+            return m_split[first * m_count + last];
+        }
+
+        /** Returns the number of rows of the product of the chain starting at first. */
+        std::size_t rows(std::size_t first) const {
+            return m_sizes[first];
+        }
+
+        /** Returns the number of columns of the product of the chain ending at last. */
+        std::size_t columns(std::size_t last) const {
+            return m_sizes[last + 1];
+        }
+
+        /** Returns the number of values needed for the intermediate products of the chain first..last. */
+        std::size_t workspace(std::size_t first, std::size_t last) const;
+    };
+
+    /** Computes C = A * B for int matrices, large products with Strassen-Winograd. */
+    inline void multiplyAssign(int const* a, int const* b, int* c, std::size_t rows, std::size_t depth, std::size_t columns)
+    {
+        gemm::multiplyStrassen(a, b, c, rows, columns, depth);
+    }
+
+    /** Computes C = A * B. */
+    template<class T>
+    void multiplyAssign(T const* a, T const* b, T* c, std::size_t rows, std::size_t depth, std::size_t columns)
+    {
+        std::fill_n(c, rows * columns, T());
+        gemm::multiplyAdd(a, b, c, rows, columns, depth);
+    }
+
+    /** Combines the product A * B (rows x depth times depth x columns) with C. */
+    template<class T>
+    void multiplyPair(T const* a, T const* b, T* c, std::size_t rows, std::size_t depth, std::size_t columns, Mode mode)
+    {
+        switch (mode) {
+        case Mode::Assign:
+            multiplyAssign(a, b, c, rows, depth, columns);
+            break;
+        case Mode::Add:
+            // Fused: the kernel adds its results to C
+            gemm::multiplyAdd(a, b, c, rows, columns, depth);
+            break;
+        case Mode::Subtract:
+        {
+            std::vector<T> product(rows * columns);
+            multiplyAssign(a, b, product.data(), rows, depth, columns);
+
+            for (std::size_t i = 0; i < product.size(); ++i) {
+                c[i] -= product[i];
+            }
+            break;
+        }
+        }
+    }
+
+    /**
+     * Combines the product of the chain first..last with C. Subchains of more than one matrix
+     * are evaluated into the workspace first, which is advanced past the used storage.
+     */
+    template<class T>
+    void multiplyOrdered(ChainOrder const& order, Matrix<T> const* const* factors, std::size_t first, std::size_t last,
+        T* c, Mode mode, T*& workspace)
+    {
+        std::size_t const k = order.split(first, last);
+        T const* lhs = factors[first]->data();
+        T const* rhs = factors[last]->data();
+
+        if (first != k) {
+            T* product = workspace;
+            workspace += order.rows(first) * order.columns(k);
+            multiplyOrdered(order, factors, first, k, product, Mode::Assign, workspace);
+            lhs = product;
+        }
+
+        if (k + 1 != last) {
+            T* product = workspace;
+            workspace += order.rows(k + 1) * order.columns(last);
+            multiplyOrdered(order, factors, k + 1, last, product, Mode::Assign, workspace);
+            rhs = product;
+        }
+
+        multiplyPair(lhs, rhs, c, order.rows(first), order.columns(k), order.columns(last), mode);
+    }
+
+    /**
+     * Computes C = product, C += product or C -= product of count >= 2 matrices.
+     * The parenthesization is chosen by dynamic programming over the matrix dimensions; the
+     * intermediate products are stored in a single buffer allocated once.
+     */
+    template<class T>
+    void multiplyChain(Matrix<T> const* const* factors, std::size_t count, T* c, Mode mode)
+    {
+        if (count == 2) {
+            multiplyPair(factors[0]->data(), factors[1]->data(), c,
+                factors[0]->getRowCount(), factors[0]->getColumnCount(), factors[1]->getColumnCount(), mode);
+            return;
+        }
+
+        std::vector<std::size_t> sizes(count + 1);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            sizes[i] = factors[i]->getRowCount();
+        }
+        sizes[count] = factors[count - 1]->getColumnCount();
+
+        ChainOrder const order(std::move(sizes));
+        std::vector<T> workspace(order.workspace(0, count - 1));
+        T* next = workspace.data();
+
+        multiplyOrdered(order, factors, 0, count - 1, c, mode, next);
+    }
+
+    /** Common base class of all expression nodes, identifies them as operands. */
+    class ExpressionBase
+    {
+    };
+
+    /** Base class of all expression nodes (curiously recurring template pattern). */
+    template<class E>
+    class Expression : public ExpressionBase
+    {
+    public:
+        /** Returns the node as its actual type. */
+        E const& self() const noexcept {
+            return static_cast<E const&>(*this);
+        }
+    };
+
+    /** Leaf node referencing a matrix. */
+    template<class T>
+    class Terminal : public Expression<Terminal<T>>
+    {
+    private:
+        Matrix<T> const& m_matrix; ///< Referenced matrix
+
+    public:
+        using value_type = T;                           ///< Type of the values
+        static constexpr std::size_t factor_count = 1;  ///< Number of matrices if used as a factor
+
+        explicit Terminal(Matrix<T> const& matrix) noexcept : m_matrix(matrix) {
+        }
+
+        unsigned int getRowCount() const noexcept {
+            return m_matrix.getRowCount();
+        }
+
+        unsigned int getColumnCount() const noexcept {
+            return m_matrix.getColumnCount();
+        }
+
+        /** Checks the sizes of all operands, reporting the first mismatch. */
+        bool checkSizes() const {
+            return true;
+        }
+
+        /** Checks whether the expression reads the given storage. */
+        bool references(T const* data) const noexcept {
+            return data != nullptr && m_matrix.data() == data;
+        }
+
+        /** Stores the factors of a product in the given array. */
+        void collect(Matrix<T> const** factors) const noexcept {
+            factors[0] = &m_matrix;
+        }
+
+        /** Combines the value of the expression with the storage c of the same size. */
+        void evaluate(T* c, Mode mode) const {
+            T const* values = m_matrix.data();
+            std::size_t const size = std::size_t(getRowCount()) * getColumnCount();
+
+            switch (mode) {
+            case Mode::Assign:
+                std::copy(values, values + size, c);
+                break;
+            case Mode::Add:
+                for (std::size_t i = 0; i < size; ++i) {
+                    c[i] += values[i];
+                }
+                break;
+            case Mode::Subtract:
+                for (std::size_t i = 0; i < size; ++i) {
+                    c[i] -= values[i];
+                }
+                break;
+            }
+        }
+    };
+
+    /** Node of the sum (or difference, if Negate is set) of two expressions of the same size. */
+    template<class L, class R, bool Negate>
+    class Sum : public Expression<Sum<L, R, Negate>>
+    {
+        static_assert(std::is_same<typename L::value_type, typename R::value_type>::value, "Operands must have the same value type");
+
+    private:
+        L m_lhs; ///< Left operand
+        R m_rhs; ///< Right operand
+
+    public:
+        using value_type = typename L::value_type; ///< Type of the values
+
+        Sum(L const& lhs, R const& rhs) : m_lhs(lhs), m_rhs(rhs) {
+        }
+
+        unsigned int getRowCount() const noexcept {
+            return m_lhs.getRowCount();
+        }
+
+        unsigned int getColumnCount() const noexcept {
+            return m_lhs.getColumnCount();
+        }
+
+        bool checkSizes() const {
+            if (!m_lhs.checkSizes() || !m_rhs.checkSizes()) {
+                return false;
+            }
+
+            if (m_lhs.getRowCount() != m_rhs.getRowCount() || m_lhs.getColumnCount() != m_rhs.getColumnCount()) {
+                reportSizeMismatch("addition");
+                return false;
+            }
+
+            return true;
+        }
+
+        bool references(value_type const* data) const noexcept {
+            return m_lhs.references(data) || m_rhs.references(data);
+        }
+
+        void evaluate(value_type* c, Mode mode) const {
+            // The right operand is added or subtracted after the left one was combined with c
+            bool const subtract_rhs = (mode == Mode::Subtract) != Negate;
+
+            m_lhs.evaluate(c, mode);
+            m_rhs.evaluate(c, subtract_rhs ? Mode::Subtract : Mode::Add);
+        }
+    };
+
+    /** Checks whether nodes of type E can be factors of a product. */
+    template<class E>
+    struct IsFactor : std::false_type
+    {
+    };
+
+    template<class L, class R>
+    class Product;
+
+    template<class T>
+    struct IsFactor<Terminal<T>> : std::true_type
+    {
+    };
+
+    template<class L, class R>
+    struct IsFactor<Product<L, R>> : std::true_type
+    {
+    };
+
+    /** Node of a product of two or more matrices. */
+    template<class L, class R>
+    class Product : public Expression<Product<L, R>>
+    {
+        static_assert(IsFactor<L>::value && IsFactor<R>::value,
+            "Only matrices and products can be multiplied lazily, assign a sum to a Matrix first");
+        static_assert(std::is_same<typename L::value_type, typename R::value_type>::value, "Factors must have the same value type");
+
+    private:
+        L m_lhs; ///< Left factor
+        R m_rhs; ///< Right factor
+
+    public:
+        using value_type = typename L::value_type; ///< Type of the values
+        static constexpr std::size_t factor_count = L::factor_count + R::factor_count; ///< Number of matrices
+
+        Product(L const& lhs, R const& rhs) : m_lhs(lhs), m_rhs(rhs) {
+        }
+
+        unsigned int getRowCount() const noexcept {
+            return m_lhs.getRowCount();
+        }
+
+        unsigned int getColumnCount() const noexcept {
+            return m_rhs.getColumnCount();
+        }
+
+        bool checkSizes() const {
+            if (!m_lhs.checkSizes() || !m_rhs.checkSizes()) {
+                return false;
+            }
+
+            if (m_lhs.getColumnCount() != m_rhs.getRowCount()) {
+                reportSizeMismatch("multiplication");
+                return false;
+            }
+
+            return true;
+        }
+
+        bool references(value_type const* data) const noexcept {
+            return m_lhs.references(data) || m_rhs.references(data);
+        }
+
+        void collect(Matrix<value_type> const** factors) const noexcept {
+            m_lhs.collect(factors);
+            m_rhs.collect(factors + L::factor_count);
+        }
+
+        void evaluate(value_type* c, Mode mode) const {
+            Matrix<value_type> const* factors[factor_count];
+            collect(factors);
+            multiplyChain(factors, factor_count, c, mode);
+        }
+    };
+
+    /** Node type of an operand: matrices are referenced by a Terminal, nodes are stored by value. */
+    template<class T>
+    struct NodeOf
+    {
+        using type = T;
+    };
+
+    template<class T>
+    struct NodeOf<Matrix<T>>
+    {
+        using type = Terminal<T>;
+    };
+
+    template<class T>
+    using Node = typename NodeOf<T>::type;
+
+    /** Checks whether values of type T can be operands of a matrix expression. */
+    template<class T>
+    struct IsOperand : std::integral_constant<bool, std::is_base_of<ExpressionBase, Node<T>>::value>
+    {
+    };
+
+    /** Returns the node of a matrix operand. */
+    template<class T>
+    Terminal<T> node(Matrix<T> const& matrix) noexcept {
+        return Terminal<T>(matrix);
+    }
+
+    /** Returns the node of an expression operand. */
+    template<class E>
+    E const& node(Expression<E> const& expression) noexcept {
+        return expression.self();
+    }
+}
+
+/** Lazy sum of two matrices or expressions. */
+template<class L, class R, class = typename std::enable_if<expr::IsOperand<L>::value && expr::IsOperand<R>::value>::type>
+expr::Sum<expr::Node<L>, expr::Node<R>, false> operator+(L const& lhs, R const& rhs)
+{
+    return expr::Sum<expr::Node<L>, expr::Node<R>, false>(expr::node(lhs), expr::node(rhs));
+}
+
+/** Lazy difference of two matrices or expressions. */
+template<class L, class R, class = typename std::enable_if<expr::IsOperand<L>::value && expr::IsOperand<R>::value>::type>
+expr::Sum<expr::Node<L>, expr::Node<R>, true> operator-(L const& lhs, R const& rhs)
+{
+    return expr::Sum<expr::Node<L>, expr::Node<R>, true>(expr::node(lhs), expr::node(rhs));
+}
+
+/** Lazy product of two matrices or products. */
+template<class L, class R, class = typename std::enable_if<expr::IsOperand<L>::value && expr::IsOperand<R>::value>::type>
+expr::Product<expr::Node<L>, expr::Node<R>> operator*(L const& lhs, R const& rhs)
+{
+    return expr::Product<expr::Node<L>, expr::Node<R>>(expr::node(lhs), expr::node(rhs));
+}
+
+template<class T>
+template<class E>
+Matrix<T, DynamicSize, DynamicSize>::Matrix(expr::Expression<E> const& expression) : Matrix()
+{
+    static_assert(std::is_same<typename E::value_type, T>::value, "Expression must have the value type of the matrix");
+
+    E const& value = expression.self();
+
+    if (value.checkSizes()) {
+        *this = Matrix(value.getRowCount(), value.getColumnCount());
+
+        if (m_raw_data != nullptr) {
+            value.evaluate(m_raw_data, expr::Mode::Assign);
+        }
+    }
+}
+
+template<class T>
+template<class E>
+Matrix<T, DynamicSize, DynamicSize>& Matrix<T, DynamicSize, DynamicSize>::operator=(expr::Expression<E> const& expression)
+{
+    E const& value = expression.self();
+
+    if (!value.checkSizes()) {
+        *this = Matrix();
+    }
+    else if (value.references(m_raw_data)) {
+        // The destination is an operand, so its values must not be overwritten while evaluating
+        *this = Matrix(expression);
+    }
+    else {
+        if (m_row_cnt != value.getRowCount() || m_column_cnt != value.getColumnCount()) {
+            *this = Matrix(value.getRowCount(), value.getColumnCount());
+        }
+
+        if (m_raw_data != nullptr) {
+            value.evaluate(m_raw_data, expr::Mode::Assign);
+        }
+    }
+
+    return *this;
+}
+
+template<class T>
+template<class E>
+Matrix<T, DynamicSize, DynamicSize>& Matrix<T, DynamicSize, DynamicSize>::operator+=(expr::Expression<E> const& expression)
+{
+    accumulate(expression.self(), expr::Mode::Add);
+    return *this;
+}
+
+template<class T>
+template<class E>
+Matrix<T, DynamicSize, DynamicSize>& Matrix<T, DynamicSize, DynamicSize>::operator-=(expr::Expression<E> const& expression)
+{
+    accumulate(expression.self(), expr::Mode::Subtract);
+    return *this;
+}
+
+template<class T>
+Matrix<T, DynamicSize, DynamicSize>& Matrix<T, DynamicSize, DynamicSize>::operator+=(Matrix const& rhs)
+{
+    accumulate(expr::Terminal<T>(rhs), expr::Mode::Add);
+    return *this;
+}
+
+template<class T>
+Matrix<T, DynamicSize, DynamicSize>& Matrix<T, DynamicSize, DynamicSize>::operator-=(Matrix const& rhs)
+{
+    accumulate(expr::Terminal<T>(rhs), expr::Mode::Subtract);
+    return *this;
+}
+
+template<class T>
+template<class E>
+void Matrix<T, DynamicSize, DynamicSize>::accumulate(E const& value, expr::Mode mode)
+{
+    if (!value.checkSizes()) {
+        return;
+    }
+
+    if (m_row_cnt != value.getRowCount() || m_column_cnt != value.getColumnCount()) {
+        expr::reportSizeMismatch("addition");
+        return;
+    }
+
+    if (m_raw_data == nullptr) {
+        return;
+    }
+
+    if (value.references(m_raw_data)) {
+        Matrix const evaluated(value);
+        expr::Terminal<T>(evaluated).evaluate(m_raw_data, mode);
+    }
+    else {
+        value.evaluate(m_raw_data, mode);
+    }
+}
+
+#endif //!MatrixExpression_hpp
@@ -0,0 +1,166 @@
+#ifndef MatrixFixed_hpp
+#define MatrixFixed_hpp
+
+#include "Matrix.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace fixed
+{
+    /**
+     * Returns the alignment of the inline storage of size bytes: the largest vector register
+     * width (16 or 32 bytes) the storage fills, so that e.g. a 4 x 4 float matrix can be loaded
+     * with two aligned AVX loads.
+     */
+    constexpr std::size_t alignment(std::size_t size, std::size_t value_alignment) noexcept {
+        return (size >= 32) ? 32 : (size >= 16) ? 16 : value_alignment;
+    }
+
+    /** Checks whether all types V can initialize values of type T. */
+    template<class T, class... V>
+    using AreValues = std::conjunction<std::is_convertible<V, T>...>;
+}
+
+/**
+* Matrix whose size is fixed at compile time, e.g. Matrix<float, 4, 4>.
+* The values are stored inline in row-major order, so no heap allocation takes place, and all
+* operations are constexpr and fully unrolled over the compile-time dimensions.
+*/
+template<class T, unsigned int R, unsigned int C>
+class Matrix
+{
+    static_assert(std::is_arithmetic<T>::value, "Matrix values must be of an arithmetic type");
+    static_assert(R != DynamicSize && C != DynamicSize, "Either both or no dimensions must be fixed");
+
+private:
+    alignas(fixed::alignment(sizeof(T) * R * C, alignof(T))) T m_data[R * C]; ///< Values in row-major order
+
+    /** Applies op to the values of both matrices with the same index. */
+    template<class Op, std::size_t... I>
+    static constexpr Matrix combine(Matrix const& lhs, Matrix const& rhs, Op op, std::index_sequence<I...>) {
+        return Matrix(op(lhs.m_data[I], rhs.m_data[I])...);
+    }
+
+    /** Dot product of a row of A and a column of B, unrolled over the depth. */
+    template<unsigned int K, std::size_t... P>
+    static constexpr T dot(Matrix<T, R, K> const& a, Matrix<T, K, C> const& b, std::size_t row, std::size_t column,
+        std::index_sequence<P...>) {
+        return ((a(row, P) * b(P, column)) + ...);
+    }
+
+    /** Computes all values of the product A * B, unrolled over the rows and columns. */
+    template<unsigned int K, std::size_t... I>
+    static constexpr Matrix multiply(Matrix<T, R, K> const& a, Matrix<T, K, C> const& b, std::index_sequence<I...>) {
+        return Matrix(dot(a, b, I / C, I % C, std::make_index_sequence<K>())...);
+    }
+
+public:
+    using value_type = T; ///< Type of the values
+
+    /** Constructor that creates a matrix filled with zeros. */
+    constexpr Matrix() : m_data{} {
+    }
+
+    /** Constructor that takes all R * C values in row-major order. */
+    template<class... V, class = typename std::enable_if<sizeof...(V) == R * C && fixed::AreValues<T, V...>::value>::type>
+    constexpr Matrix(V... values) : m_data{ static_cast<T>(values)... } {
+    }
+
+    /** Returns the identity matrix. */
+    static constexpr Matrix identity() {
+        static_assert(R == C, "Only square matrices have an identity");
+
+        Matrix result;
+
+        for (std::size_t i = 0; i < R; ++i) {
+            result.m_data[i * C + i] = T(1);
+        }
+
+        return result;
+    }
+
+    /** Read/write access to the value in the given row and column. */
+    constexpr T& operator()(std::size_t row, std::size_t column) noexcept {
+        return m_data[row * C + column];
+    }
+
+    /** Read only access to the value in the given row and column. */
+    constexpr T const& operator()(std::size_t row, std::size_t column) const noexcept {
+        return m_data[row * C + column];
+    }
+
+    /** Read/write access to the internal data storage of the matrix. */
+    constexpr T* data() noexcept {
+        return m_data;
+    }
+
+    /** Read only access to the internal data storage of the matrix. */
+    constexpr T const* data() const noexcept {
+        return m_data;
+    }
+
+    /** Returns the number of rows of the matrix. */
+    static constexpr unsigned int getRowCount() noexcept {
+        return R;
+    }
+
+    /** Returns the number of columns of the matrix. */
+    static constexpr unsigned int getColumnCount() noexcept {
+        return C;
+    }
+
+    /** Converts the matrix to a matrix whose size is set at runtime. */
+    Matrix<T> toDynamic() const {
+        Matrix<T> result(R, C);
+        std::copy_n(m_data, R * C, result.data());
+        return result;
+    }
+
+    constexpr friend Matrix operator+(Matrix const& lhs, Matrix const& rhs) {
+        return combine(lhs, rhs, [](T x, T y) { return T(x + y); }, std::make_index_sequence<R * C>());
+    }
+
+    constexpr friend Matrix operator-(Matrix const& lhs, Matrix const& rhs) {
+        return combine(lhs, rhs, [](T x, T y) { return T(x - y); }, std::make_index_sequence<R * C>());
+    }
+
+    constexpr Matrix& operator+=(Matrix const& rhs) {
+        return *this = *this + rhs;
+    }
+
+    constexpr Matrix& operator-=(Matrix const& rhs) {
+        return *this = *this - rhs;
+    }
+
+    constexpr friend bool operator==(Matrix const& lhs, Matrix const& rhs) {
+        for (std::size_t i = 0; i < R * C; ++i) {
+            if (lhs.m_data[i] != rhs.m_data[i]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    constexpr friend bool operator!=(Matrix const& lhs, Matrix const& rhs) {
+        return !(lhs == rhs);
+    }
+
+    /** Product of an R x K and a K x C matrix. */
+    template<unsigned int K>
+    static constexpr Matrix product(Matrix<T, R, K> const& a, Matrix<T, K, C> const& b) {
+        return multiply(a, b, std::make_index_sequence<R * C>());
+    }
+};
+
+/** Product of two fixed-size matrices, computed without loops or heap allocations. */
+template<class T, unsigned int R, unsigned int K, unsigned int C,
+    class = typename std::enable_if<R != DynamicSize && K != DynamicSize && C != DynamicSize>::type>
+constexpr Matrix<T, R, C> operator*(Matrix<T, R, K> const& lhs, Matrix<T, K, C> const& rhs)
+{
+    return Matrix<T, R, C>::product(lhs, rhs);
+}
+
+#endif //!MatrixFixed_hpp
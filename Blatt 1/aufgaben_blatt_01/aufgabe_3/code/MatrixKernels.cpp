@@ -0,0 +1,260 @@
+#include "MatrixKernels.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define GEMM_X86
+#endif
+
+#if defined(GEMM_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Kernels for newer instruction sets are compiled for them individually, the rest of the
+// program keeps the baseline instruction set. MSVC accepts the intrinsics without flags.
+#if defined(__GNUC__) || defined(__clang__)
+#define GEMM_TARGET(isa) __attribute__((target(isa)))
+#else
+#define GEMM_TARGET(isa)
+#endif
+
+namespace gemm
+{
+    namespace
+    {
+        /**
+         * Portable kernel with a 4 x 8 tile, vectorized by the compiler for the baseline instruction set.
+         */
+        void scalarKernel(std::size_t depth, int const* a, int const* b, int* c, std::size_t ldc, std::size_t rows, std::size_t columns)
+        {
+            static constexpr std::size_t MR = 4;
+            static constexpr std::size_t NR = 8;
+
+            int tile[MR][NR] = {};
+
+            for (std::size_t p = 0; p < depth; ++p) {
+                for (std::size_t r = 0; r < MR; ++r) {
+                    int const value = a[r];
+
+                    for (std::size_t col = 0; col < NR; ++col) {
+                        tile[r][col] += value * b[col];
+                    }
+                }
+                a += MR;
+                b += NR;
+            }
+
+            for (std::size_t r = 0; r < rows; ++r) {
+                for (std::size_t col = 0; col < columns; ++col) {
+                    c[r * ldc + col] += tile[r][col];
+                }
+            }
+        }
+
+#ifdef GEMM_X86
+        /**
+         * AVX2 kernel with a 6 x 16 tile: 12 accumulators of 8 values, two vectors of B and one
+         * broadcast value of A use 15 of the 16 ymm registers. Every step of the k loop issues
+         * 12 vpmulld/vpaddd pairs.
+         */
+        GEMM_TARGET("avx2")
+        void avx2Kernel(std::size_t depth, int const* a, int const* b, int* c, std::size_t ldc, std::size_t rows, std::size_t columns)
+        {
+            static constexpr std::size_t MR = 6;
+            static constexpr std::size_t NR = 16;
+
+            __m256i tile[MR][2];
+
+            for (std::size_t r = 0; r < MR; ++r) {
+                tile[r][0] = _mm256_setzero_si256();
+                tile[r][1] = _mm256_setzero_si256();
+            }
+
+            for (std::size_t p = 0; p < depth; ++p) {
+                __m256i const b0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b));
+                __m256i const b1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + 8));
+
+                for (std::size_t r = 0; r < MR; ++r) {
+                    __m256i const value = _mm256_set1_epi32(a[r]);
+
+                    tile[r][0] = _mm256_add_epi32(tile[r][0], _mm256_mullo_epi32(value, b0));
+                    tile[r][1] = _mm256_add_epi32(tile[r][1], _mm256_mullo_epi32(value, b1));
+                }
+                a += MR;
+                b += NR;
+            }
+
+            if (rows == MR && columns == NR) {
+                for (std::size_t r = 0; r < MR; ++r) {
+                    __m256i* row = reinterpret_cast<__m256i*>(c + r * ldc);
+
+                    _mm256_storeu_si256(row, _mm256_add_epi32(_mm256_loadu_si256(row), tile[r][0]));
+                    _mm256_storeu_si256(row + 1, _mm256_add_epi32(_mm256_loadu_si256(row + 1), tile[r][1]));
+                }
+                return;
+            }
+
+            // Edge tile: only part of the tile lies inside C
+            int values[MR][NR];
+
+            for (std::size_t r = 0; r < MR; ++r) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(values[r]), tile[r][0]);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(values[r] + 8), tile[r][1]);
+            }
+
+            for (std::size_t r = 0; r < rows; ++r) {
+                for (std::size_t col = 0; col < columns; ++col) {
+                    c[r * ldc + col] += values[r][col];
+                }
+            }
+        }
+
+        /**
+         * AVX-512 kernel with an 8 x 32 tile: 16 accumulators of 16 values in half of the 32 zmm
+         * registers. Edge tiles are written with masked loads and stores.
+         */
+        GEMM_TARGET("avx512f")
+        void avx512Kernel(std::size_t depth, int const* a, int const* b, int* c, std::size_t ldc, std::size_t rows, std::size_t columns)
+        {
+            static constexpr std::size_t MR = 8;
+            static constexpr std::size_t NR = 32;
+
+            __m512i tile[MR][2];
+
+            for (std::size_t r = 0; r < MR; ++r) {
+                tile[r][0] = _mm512_setzero_si512();
+                tile[r][1] = _mm512_setzero_si512();
+            }
+
+            for (std::size_t p = 0; p < depth; ++p) {
+                __m512i const b0 = _mm512_loadu_si512(b);
+                __m512i const b1 = _mm512_loadu_si512(b + 16);
+
+                for (std::size_t r = 0; r < MR; ++r) {
+                    __m512i const value = _mm512_set1_epi32(a[r]);
+
+                    tile[r][0] = _mm512_add_epi32(tile[r][0], _mm512_mullo_epi32(value, b0));
+                    tile[r][1] = _mm512_add_epi32(tile[r][1], _mm512_mullo_epi32(value, b1));
+                }
+                a += MR;
+                b += NR;
+            }
+
+            // Masks of the valid columns of both halves of the tile
+            std::size_t const columns0 = (columns < 16) ? columns : 16;
+            std::size_t const columns1 = columns - columns0;
+            __mmask16 const mask0 = static_cast<__mmask16>((1u << columns0) - 1u);
+            __mmask16 const mask1 = static_cast<__mmask16>((1u << columns1) - 1u);
+
+            for (std::size_t r = 0; r < rows; ++r) {
+                int* row = c + r * ldc;
+
+                _mm512_mask_storeu_epi32(row, mask0, _mm512_add_epi32(_mm512_maskz_loadu_epi32(mask0, row), tile[r][0]));
+                _mm512_mask_storeu_epi32(row + 16, mask1, _mm512_add_epi32(_mm512_maskz_loadu_epi32(mask1, row + 16), tile[r][1]));
+            }
+        }
+
+        /** Checks whether the CPU and the operating system support AVX2. */
+        bool hasAvx2()
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+
+            if (info[0] < 7) {
+                return false;
+            }
+
+            // OSXSAVE and AVX, then the saved register state (XMM and YMM)
+            __cpuid(info, 1);
+
+            if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x6) != 0x6) {
+                return false;
+            }
+
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return false;
+#endif
+        }
+
+        /** Checks whether the CPU and the operating system support AVX-512F. */
+        bool hasAvx512()
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512f");
+#elif defined(_MSC_VER)
+            if (!hasAvx2()) {
+                return false;
+            }
+
+            // Opmask and upper ZMM state must be saved by the operating system
+            if ((_xgetbv(0) & 0xe6) != 0xe6) {
+                return false;
+            }
+
+            int info[4];
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 16)) != 0;
+#else
+            return false;
+#endif
+        }
+#endif
+
+        /** Detects the kernels supported by the CPU. */
+        std::vector<Kernel> detectKernels()
+        {
+            std::vector<Kernel> kernels;
+            kernels.push_back(Kernel{ "scalar", 4, 8, &scalarKernel });
+
+#ifdef GEMM_X86
+            if (hasAvx2()) {
+                kernels.push_back(Kernel{ "avx2", 6, 16, &avx2Kernel });
+            }
+
+            if (hasAvx512()) {
+                kernels.push_back(Kernel{ "avx512", 8, 32, &avx512Kernel });
+            }
+#endif
+
+            return kernels;
+        }
+
+        /** Selects the fastest kernel or the one requested by GEMM_KERNEL. */
+        Kernel const* selectKernel()
+        {
+            std::vector<Kernel> const& kernels = availableKernels();
+            char const* requested = std::getenv("GEMM_KERNEL");
+
+            if (requested != nullptr) {
+                for (Kernel const& kernel : kernels) {
+                    if (std::strcmp(kernel.name, requested) == 0) {
+                        return &kernel;
+                    }
+                }
+            }
+
+            return &kernels.back();
+        }
+    }
+}
+
+std::vector<gemm::Kernel> const& gemm::availableKernels()
+{
+    static std::vector<Kernel> const kernels = detectKernels();
+    return kernels;
+}
+
+gemm::Kernel const& gemm::activeKernel()
+{
+    static Kernel const* const kernel = selectKernel();
+    return *kernel;
+}
@@ -0,0 +1,40 @@
+#ifndef MatrixKernels_hpp
+#define MatrixKernels_hpp
+
+#include <cstddef>
+#include <vector>
+
+namespace gemm
+{
+    /**
+     * Micro-kernel computing an mr x nr tile of C += A * B from packed slivers.
+     * a holds depth steps of mr values of A, b holds depth steps of nr values of B (see packA/packB).
+     * Only the first rows x columns values of the tile are written to C, which has a row stride of ldc.
+     */
+    using MicroKernel = void (*)(std::size_t depth, int const* a, int const* b, int* c, std::size_t ldc, std::size_t rows, std::size_t columns);
+
+    /**
+     * Micro-kernel together with the tile size it computes.
+     */
+    struct Kernel
+    {
+        char const* name;      ///< Name of the instruction set ("scalar", "avx2", "avx512")
+        std::size_t mr;        ///< Rows of the register tile
+        std::size_t nr;        ///< Columns of the register tile
+        MicroKernel compute;   ///< Kernel function
+    };
+
+    /**
+     * Returns all kernels the CPU can execute, the scalar fallback first and the fastest last.
+     * The instruction sets are detected at runtime, so one binary runs on every x86-64 CPU.
+     */
+    std::vector<Kernel> const& availableKernels();
+
+    /**
+     * Returns the kernel used by multiplyAdd: the fastest available one, unless the environment
+     * variable GEMM_KERNEL names another available kernel (e.g. GEMM_KERNEL=scalar).
+     */
+    Kernel const& activeKernel();
+}
+
+#endif //!MatrixKernels_hpp
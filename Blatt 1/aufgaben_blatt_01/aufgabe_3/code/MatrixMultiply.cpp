@@ -0,0 +1,211 @@
+#include "MatrixMultiply.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gemm
+{
+    namespace
+    {
+        /**
+         * Packs a rows x depth block of A into slivers of mr rows.
+         * Within a sliver the values are stored column by column, so that the micro-kernel reads
+         * the mr values of one step of the k loop from consecutive addresses. Missing rows of the
+         * last sliver are filled with zeros.
+         */
+        void packA(int const* a, std::size_t lda, std::size_t rows, std::size_t depth, std::size_t mr, int* packed)
+        {
+            for (std::size_t i = 0; i < rows; i += mr) {
+                std::size_t const valid = std::min(mr, rows - i);
+
+                for (std::size_t p = 0; p < depth; ++p) {
+                    for (std::size_t r = 0; r < mr; ++r) {
+                        packed[r] = (r < valid) ? a[(i + r) * lda + p] : 0;
+                    }
+                    packed += mr;
+                }
+            }
+        }
+
+        /**
+         * Packs a depth x columns block of B into slivers of nr columns.
+         * Within a sliver the values are stored row by row. Missing columns of the last sliver
+         * are filled with zeros.
+         */
+        void packB(int const* b, std::size_t ldb, std::size_t depth, std::size_t columns, std::size_t nr, int* packed)
+        {
+            for (std::size_t j = 0; j < columns; j += nr) {
+                std::size_t const valid = std::min(nr, columns - j);
+
+                for (std::size_t p = 0; p < depth; ++p) {
+                    int const* row = b + p * ldb + j;
+
+                    for (std::size_t c = 0; c < nr; ++c) {
+                        packed[c] = (c < valid) ? row[c] : 0;
+                    }
+                    packed += nr;
+                }
+            }
+        }
+
+        std::mutex poolMutex;                   ///< Guards the shared pool
+        std::unique_ptr<ThreadPool> sharedPool; ///< Pool used for large products, created on first use
+
+        /** Returns the shared pool, creating it with the configured number of threads on first use. */
+        ThreadPool& sharedThreadPool()
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+
+            if (!sharedPool) {
+                std::size_t thread_cnt = 0;
+                char const* requested = std::getenv("GEMM_THREADS");
+
+                if (requested != nullptr) {
+                    thread_cnt = static_cast<std::size_t>(std::strtoul(requested, nullptr, 10));
+                }
+
+                sharedPool = std::make_unique<ThreadPool>(thread_cnt);
+            }
+
+            return *sharedPool;
+        }
+
+        /**
+         * Computes C += A * B on the given pool. Each panel of B is packed by all threads together
+         * and then shared; the tiles of C below it are handed out to the threads one at a time.
+         */
+        void multiplyAddParallel(int const* a, std::size_t lda, int const* b, std::size_t ldb, int* c, std::size_t ldc,
+            std::size_t rows, std::size_t columns, std::size_t depth, Kernel const& kernel, ThreadPool& threads)
+        {
+            std::size_t const mr = kernel.mr;
+            std::size_t const nr = kernel.nr;
+
+            std::vector<int> packedB(std::min(NC, (columns + nr - 1) / nr * nr) * KC);
+
+            for (std::size_t jc = 0; jc < columns; jc += NC) {
+                std::size_t const nc = std::min(NC, columns - jc);
+                std::size_t const column_tiles = (nc + NT - 1) / NT;
+                std::size_t const row_tiles = (rows + MC - 1) / MC;
+
+                for (std::size_t pc = 0; pc < depth; pc += KC) {
+                    std::size_t const kc = std::min(KC, depth - pc);
+
+                    // NT is a multiple of nr, so every tile packs whole slivers into its own part of the panel
+                    threads.run(column_tiles, [&](std::size_t tile) {
+                        std::size_t const jt = tile * NT;
+                        packB(b + pc * ldb + jc + jt, ldb, kc, std::min(NT, nc - jt), nr, packedB.data() + jt * kc);
+                    });
+
+                    threads.run(row_tiles * column_tiles, [&](std::size_t tile) {
+                        std::size_t const ic = (tile / column_tiles) * MC;
+                        std::size_t const jt = (tile % column_tiles) * NT;
+                        std::size_t const mc = std::min(MC, rows - ic);
+                        std::size_t const nt = std::min(NT, nc - jt);
+
+                        // Every thread keeps its own panel of A across products
+                        thread_local std::vector<int> packedA;
+                        packedA.resize(MC * KC);
+
+                        packA(a + ic * lda + pc, lda, mc, kc, mr, packedA.data());
+
+                        for (std::size_t jr = jt; jr < jt + nt; jr += nr) {
+                            for (std::size_t ir = 0; ir < mc; ir += mr) {
+                                kernel.compute(kc, packedA.data() + ir * kc, packedB.data() + jr * kc,
+                                    c + (ic + ir) * ldc + jc + jr, ldc, std::min(mr, mc - ir), std::min(nr, nc - jr));
+                            }
+                        }
+                    });
+                }
+            }
+        }
+    }
+}
+
+void gemm::setThreadCount(std::size_t thread_cnt)
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    sharedPool.reset();
+
+    if (thread_cnt != 0) {
+        sharedPool = std::make_unique<ThreadPool>(thread_cnt);
+    }
+}
+
+ThreadPool& gemm::threadPool()
+{
+    return sharedThreadPool();
+}
+
+std::size_t gemm::getThreadCount()
+{
+    return threadPool().getThreadCount();
+}
+
+void gemm::multiplyAdd(int const* a, int const* b, int* c, std::size_t rows, std::size_t columns, std::size_t depth)
+{
+    multiplyAdd(a, b, c, rows, columns, depth, activeKernel());
+}
+
+void gemm::multiplyAdd(int const* a, int const* b, int* c, std::size_t rows, std::size_t columns, std::size_t depth, Kernel const& kernel)
+{
+    multiplyAdd(a, depth, b, columns, c, columns, rows, columns, depth, kernel);
+}
+
+void gemm::multiplyAdd(int const* a, std::size_t lda, int const* b, std::size_t ldb, int* c, std::size_t ldc,
+    std::size_t rows, std::size_t columns, std::size_t depth, Kernel const& kernel)
+{
+    if (rows == 0 || columns == 0 || depth == 0) {
+        return;
+    }
+
+    // Tiny products, e.g. 4 x 4, are dominated by allocating and filling the packed panels
+    if (rows * columns * depth < PACKING_THRESHOLD) {
+        multiplyAddSimple(a, lda, b, ldb, c, ldc, rows, columns, depth);
+        return;
+    }
+
+    // Small products do not amortize the synchronization of the threads
+    if (rows * columns * depth >= PARALLEL_THRESHOLD && (rows > MC || columns > NT)) {
+        ThreadPool& threads = threadPool();
+
+        if (threads.getThreadCount() > 1) {
+            multiplyAddParallel(a, lda, b, ldb, c, ldc, rows, columns, depth, kernel, threads);
+            return;
+        }
+    }
+
+    std::size_t const mr = kernel.mr;
+    std::size_t const nr = kernel.nr;
+
+    // Packed panels, padded to whole slivers
+    std::vector<int> packedA(MC * KC);
+    std::vector<int> packedB(std::min(NC, (columns + nr - 1) / nr * nr) * KC);
+
+    for (std::size_t jc = 0; jc < columns; jc += NC) {
+        std::size_t const nc = std::min(NC, columns - jc);
+
+        for (std::size_t pc = 0; pc < depth; pc += KC) {
+            std::size_t const kc = std::min(KC, depth - pc);
+
+            packB(b + pc * ldb + jc, ldb, kc, nc, nr, packedB.data());
+
+            for (std::size_t ic = 0; ic < rows; ic += MC) {
+                std::size_t const mc = std::min(MC, rows - ic);
+
+                packA(a + ic * lda + pc, lda, mc, kc, mr, packedA.data());
+
+                // Register tiles of the block; the packed sliver of B stays in L1 for all slivers of A
+                for (std::size_t jr = 0; jr < nc; jr += nr) {
+                    for (std::size_t ir = 0; ir < mc; ir += mr) {
+                        kernel.compute(kc, packedA.data() + ir * kc, packedB.data() + jr * kc,
+                            c + (ic + ir) * ldc + jc + jr, ldc, std::min(mr, mc - ir), std::min(nr, nc - jr));
+                    }
+                }
+            }
+        }
+    }
+}
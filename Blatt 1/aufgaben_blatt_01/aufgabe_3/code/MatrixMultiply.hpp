@@ -0,0 +1,105 @@
+#ifndef MatrixMultiply_hpp
+#define MatrixMultiply_hpp
+
+#include "MatrixKernels.hpp"
+
+#include <cstddef>
+
+class ThreadPool;
+
+/**
+* Cache-blocked integer matrix multiplication (GEMM).
+*
+* The product is computed in blocks: a KC x NC panel of B and an MC x KC panel of A are packed
+* into contiguous buffers, so that the innermost loops read memory strictly sequentially. The
+* packed panels are consumed by a micro-kernel that keeps an mr x nr tile of C in registers
+* for the whole KC loop (see MatrixKernels.hpp for the tile sizes of the instruction sets).
+* Panels at the matrix borders are padded with zeros when packed; the micro-kernel always
+* computes full tiles and only the valid part is written back.
+*
+* Large products are distributed over a shared thread pool: every panel of B is packed once
+* and shared by all threads, the corresponding block of C is split into tiles of MC rows and
+* NT columns, and each thread packs its own panels of A for the tiles it computes.
+*/
+namespace gemm
+{
+    static constexpr std::size_t MC = 96;   ///< Rows of a packed panel of A (multiple of every mr, fits into L2)
+    static constexpr std::size_t KC = 256;  ///< Depth of the packed panels of A and B
+    static constexpr std::size_t NC = 2048; ///< Columns of a packed panel of B (multiple of every nr, fits into L3)
+    static constexpr std::size_t NT = 512;  ///< Columns of a tile of C computed by one thread (multiple of every nr)
+
+    static constexpr std::size_t PARALLEL_THRESHOLD = 128 * 128 * 128; ///< Multiply-adds below which the product is computed serially
+    static constexpr std::size_t PACKING_THRESHOLD = 32 * 32 * 32;      ///< Multiply-adds below which packing does not pay off
+
+    /**
+     * Sets the number of threads used for large products, including the calling thread.
+     * Zero selects the value of the environment variable GEMM_THREADS or, if unset, one thread
+     * per hardware thread. Must not be called while a product is computed.
+     */
+    void setThreadCount(std::size_t thread_cnt);
+
+    /** Returns the number of threads used for large products. */
+    std::size_t getThreadCount();
+
+    /** Returns the thread pool shared by all products. */
+    ThreadPool& threadPool();
+
+    /**
+     * Computes C += A * B for row-major matrices with the active micro-kernel.
+     * A is rows x depth, B is depth x columns and C is rows x columns.
+     */
+    void multiplyAdd(int const* a, int const* b, int* c, std::size_t rows, std::size_t columns, std::size_t depth);
+
+    /**
+     * Computes C += A * B with the given micro-kernel.
+     */
+    void multiplyAdd(int const* a, int const* b, int* c, std::size_t rows, std::size_t columns, std::size_t depth, Kernel const& kernel);
+
+    /**
+     * Computes C += A * B for row-major submatrices with the given micro-kernel.
+     * lda, ldb and ldc are the distances between consecutive rows of A, B and C in elements.
+     */
+    void multiplyAdd(int const* a, std::size_t lda, int const* b, std::size_t ldb, int* c, std::size_t ldc,
+        std::size_t rows, std::size_t columns, std::size_t depth, Kernel const& kernel);
+
+    /**
+     * Computes C += A * B for row-major submatrices with plain loops. The innermost loop runs
+     * along the rows of B and C, so the compiler vectorizes it for any arithmetic type.
+     */
+    template<class T>
+    void multiplyAddSimple(T const* a, std::size_t lda, T const* b, std::size_t ldb, T* c, std::size_t ldc,
+        std::size_t rows, std::size_t columns, std::size_t depth)
+    {
+        for (std::size_t i = 0; i < rows; ++i) {
+            T* row = c + i * ldc;
+
+            for (std::size_t p = 0; p < depth; ++p) {
+                T const value = a[i * lda + p];
+                T const* values = b + p * ldb;
+
+                for (std::size_t j = 0; j < columns; ++j) {
+                    row[j] += value * values[j];
+                }
+            }
+        }
+    }
+
+    /**
+     * Computes C += A * B for value types without micro-kernels, e.g. int64, float and double.
+     * The loops are blocked so that the KC x NT block of B in use stays in the cache.
+     */
+    template<class T>
+    void multiplyAdd(T const* a, T const* b, T* c, std::size_t rows, std::size_t columns, std::size_t depth)
+    {
+        for (std::size_t jc = 0; jc < columns; jc += NT) {
+            std::size_t const nc = (columns - jc < NT) ? columns - jc : NT;
+
+            for (std::size_t pc = 0; pc < depth; pc += KC) {
+                std::size_t const kc = (depth - pc < KC) ? depth - pc : KC;
+                multiplyAddSimple(a + pc, depth, b + pc * columns + jc, columns, c + jc, columns, rows, nc, kc);
+            }
+        }
+    }
+}
+
+#endif //!MatrixMultiply_hpp
@@ -0,0 +1,344 @@
+#include "MatrixStrassen.hpp"
+#include "MatrixMultiply.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <vector>
+
+namespace gemm
+{
+    namespace
+    {
+        static constexpr std::size_t DEFAULT_STRASSEN_CROSSOVER = 512; ///< Crossover size used if none is configured
+
+        std::atomic<std::size_t> strassenCrossover(0); ///< Configured crossover size, zero if not yet determined
+
+        /** Parameters shared by all recursion levels. */
+        struct Recursion
+        {
+            Kernel const& kernel;   ///< Micro-kernel of the blocked products at the leaves
+            std::size_t crossover;  ///< Products with a dimension not larger than this are leaves
+        };
+
+        /** Checks whether a product is computed by the blocked kernel. */
+        bool isLeaf(Recursion const& recursion, std::size_t rows, std::size_t depth, std::size_t columns)
+        {
+            return std::min({ rows, depth, columns }) <= recursion.crossover;
+        }
+
+        /** Sets a rows x columns submatrix to zero. */
+        void clear(int* c, std::size_t ldc, std::size_t rows, std::size_t columns)
+        {
+            for (std::size_t i = 0; i < rows; ++i) {
+                std::fill_n(c + i * ldc, columns, 0);
+            }
+        }
+
+        /** Computes Z = X + Y for rows x columns submatrices. Z may be X or Y. */
+        void add(int const* x, std::size_t ldx, int const* y, std::size_t ldy, int* z, std::size_t ldz, std::size_t rows, std::size_t columns)
+        {
+            // Unsigned arithmetic wraps around instead of overflowing, like the products of the kernels
+            for (std::size_t i = 0; i < rows; ++i) {
+                for (std::size_t j = 0; j < columns; ++j) {
+                    z[i * ldz + j] = static_cast<int>(static_cast<unsigned>(x[i * ldx + j]) + static_cast<unsigned>(y[i * ldy + j]));
+                }
+            }
+        }
+
+        /** Computes Z = X - Y for rows x columns submatrices. Z may be X or Y. */
+        void subtract(int const* x, std::size_t ldx, int const* y, std::size_t ldy, int* z, std::size_t ldz, std::size_t rows, std::size_t columns)
+        {
+            for (std::size_t i = 0; i < rows; ++i) {
+                for (std::size_t j = 0; j < columns; ++j) {
+                    z[i * ldz + j] = static_cast<int>(static_cast<unsigned>(x[i * ldx + j]) - static_cast<unsigned>(y[i * ldy + j]));
+                }
+            }
+        }
+
+        /** Computes C = A * B with the blocked kernel. */
+        void multiplyLeaf(Recursion const& recursion, int const* a, std::size_t lda, int const* b, std::size_t ldb, int* c, std::size_t ldc,
+            std::size_t rows, std::size_t depth, std::size_t columns)
+        {
+            clear(c, ldc, rows, columns);
+            multiplyAdd(a, lda, b, ldb, c, ldc, rows, columns, depth, recursion.kernel);
+        }
+
+        /**
+         * Completes C = A * B after the product of the even-sized leading parts was computed:
+         * adds the contribution of a trailing depth and computes a trailing column and row of C.
+         */
+        void multiplyPeeled(Recursion const& recursion, int const* a, std::size_t lda, int const* b, std::size_t ldb, int* c, std::size_t ldc,
+            std::size_t rows, std::size_t depth, std::size_t columns)
+        {
+            std::size_t const rows_even = rows & ~std::size_t(1);
+            std::size_t const depth_even = depth & ~std::size_t(1);
+            std::size_t const columns_even = columns & ~std::size_t(1);
+
+            if (depth_even < depth) {
+                multiplyAdd(a + depth_even, lda, b + depth_even * ldb, ldb, c, ldc, rows_even, columns_even, depth - depth_even, recursion.kernel);
+            }
+
+            if (columns_even < columns) {
+                multiplyLeaf(recursion, a, lda, b + columns_even, ldb, c + columns_even, ldc, rows_even, depth, columns - columns_even);
+            }
+
+            if (rows_even < rows) {
+                multiplyLeaf(recursion, a + rows_even * lda, lda, b, ldb, c + rows_even * ldc, ldc, rows - rows_even, depth, columns);
+            }
+        }
+
+        /** Returns the workspace needed by multiplySequential. */
+        std::size_t sequentialWorkspace(Recursion const& recursion, std::size_t rows, std::size_t depth, std::size_t columns)
+        {
+            if (isLeaf(recursion, rows, depth, columns)) {
+                return 0;
+            }
+
+            std::size_t const mh = rows / 2;
+            std::size_t const kh = depth / 2;
+            std::size_t const nh = columns / 2;
+
+            return mh * kh + kh * nh + mh * nh + sequentialWorkspace(recursion, mh, kh, nh);
+        }
+
+        /**
+         * Computes C = A * B on the calling thread. Besides the quadrants of C, only one temporary
+         * of the size of a quadrant of A, B and C each is used per level (schedule of Douglas et al.).
+         */
+        void multiplySequential(Recursion const& recursion, int const* a, std::size_t lda, int const* b, std::size_t ldb, int* c, std::size_t ldc,
+            std::size_t rows, std::size_t depth, std::size_t columns, int* workspace)
+        {
+            if (isLeaf(recursion, rows, depth, columns)) {
+                multiplyLeaf(recursion, a, lda, b, ldb, c, ldc, rows, depth, columns);
+                return;
+            }
+
+            std::size_t const mh = rows / 2;
+            std::size_t const kh = depth / 2;
+            std::size_t const nh = columns / 2;
+
+            int const* a11 = a;
+            int const* a12 = a + kh;
+            int const* a21 = a + mh * lda;
+            int const* a22 = a21 + kh;
+            int const* b11 = b;
+            int const* b12 = b + nh;
+            int const* b21 = b + kh * ldb;
+            int const* b22 = b21 + nh;
+            int* c11 = c;
+            int* c12 = c + nh;
+            int* c21 = c + mh * ldc;
+            int* c22 = c21 + nh;
+
+            int* x = workspace;
+            int* y = x + mh * kh;
+            int* z = y + kh * nh;
+            int* next = z + mh * nh;
+
+            // C21 = P7 = (A11 - A21) (B22 - B12)
+            subtract(a11, lda, a21, lda, x, kh, mh, kh);
+            subtract(b22, ldb, b12, ldb, y, nh, kh, nh);
+            multiplySequential(recursion, x, kh, y, nh, c21, ldc, mh, kh, nh, next);
+
+            // C22 = P5 = (A21 + A22) (B12 - B11)
+            add(a21, lda, a22, lda, x, kh, mh, kh);
+            subtract(b12, ldb, b11, ldb, y, nh, kh, nh);
+            multiplySequential(recursion, x, kh, y, nh, c22, ldc, mh, kh, nh, next);
+
+            // C12 = P6 = (A21 + A22 - A11) (B22 - B12 + B11)
+            subtract(x, kh, a11, lda, x, kh, mh, kh);
+            subtract(b22, ldb, y, nh, y, nh, kh, nh);
+            multiplySequential(recursion, x, kh, y, nh, c12, ldc, mh, kh, nh, next);
+
+            // C11 = P3 = (A12 - A21 - A22 + A11) B22
+            subtract(a12, lda, x, kh, x, kh, mh, kh);
+            multiplySequential(recursion, x, kh, b22, ldb, c11, ldc, mh, kh, nh, next);
+
+            // Z = P1 = A11 B11
+            multiplySequential(recursion, a11, lda, b11, ldb, z, nh, mh, kh, nh, next);
+
+            add(c12, ldc, z, nh, c12, ldc, mh, nh);     // C12 = U2 = P1 + P6
+            add(c21, ldc, c12, ldc, c21, ldc, mh, nh);  // C21 = U3 = U2 + P7
+            add(c12, ldc, c22, ldc, c12, ldc, mh, nh);  // C12 = U4 = U2 + P5
+            add(c21, ldc, c22, ldc, c22, ldc, mh, nh);  // C22 = U7 = U3 + P5
+            add(c12, ldc, c11, ldc, c12, ldc, mh, nh);  // C12 = U5 = U4 + P3
+
+            // C11 = P4 = A22 (B22 - B12 + B11 - B21)
+            subtract(y, nh, b21, ldb, y, nh, kh, nh);
+            multiplySequential(recursion, a22, lda, y, nh, c11, ldc, mh, kh, nh, next);
+            subtract(c21, ldc, c11, ldc, c21, ldc, mh, nh); // C21 = U6 = U3 - P4
+
+            // C11 = U1 = P2 + P1 = A12 B21 + P1
+            multiplySequential(recursion, a12, lda, b21, ldb, c11, ldc, mh, kh, nh, next);
+            add(c11, ldc, z, nh, c11, ldc, mh, nh);
+
+            multiplyPeeled(recursion, a, lda, b, ldb, c, ldc, rows, depth, columns);
+        }
+
+        /** Returns the workspace needed by multiplyParallel. */
+        std::size_t parallelWorkspace(Recursion const& recursion, std::size_t rows, std::size_t depth, std::size_t columns)
+        {
+            if (isLeaf(recursion, rows, depth, columns)) {
+                return 0;
+            }
+
+            std::size_t const mh = rows / 2;
+            std::size_t const kh = depth / 2;
+            std::size_t const nh = columns / 2;
+
+            return 4 * mh * kh + 4 * kh * nh + 3 * mh * nh + 7 * sequentialWorkspace(recursion, mh, kh, nh);
+        }
+
+        /**
+         * Computes C = A * B with the 7 products of the first level running in parallel.
+         * All operands of the products are formed first, each product then recurses sequentially
+         * in its own part of the workspace, and the quadrants of C are combined in a single pass.
+         * With more than 7 threads, the idle ones join the parallel blocked products at the leaves.
+         */
+        void multiplyParallel(Recursion const& recursion, int const* a, std::size_t lda, int const* b, std::size_t ldb, int* c, std::size_t ldc,
+            std::size_t rows, std::size_t depth, std::size_t columns, int* workspace, ThreadPool& threads)
+        {
+            if (isLeaf(recursion, rows, depth, columns)) {
+                multiplyLeaf(recursion, a, lda, b, ldb, c, ldc, rows, depth, columns);
+                return;
+            }
+
+            std::size_t const mh = rows / 2;
+            std::size_t const kh = depth / 2;
+            std::size_t const nh = columns / 2;
+
+            int const* a11 = a;
+            int const* a12 = a + kh;
+            int const* a21 = a + mh * lda;
+            int const* a22 = a21 + kh;
+            int const* b11 = b;
+            int const* b12 = b + nh;
+            int const* b21 = b + kh * ldb;
+            int const* b22 = b21 + nh;
+            int* c11 = c;
+            int* c12 = c + nh;
+            int* c21 = c + mh * ldc;
+            int* c22 = c21 + nh;
+
+            int* s1 = workspace;
+            int* s2 = s1 + mh * kh;
+            int* s3 = s2 + mh * kh;
+            int* s4 = s3 + mh * kh;
+            int* t1 = s4 + mh * kh;
+            int* t2 = t1 + kh * nh;
+            int* t3 = t2 + kh * nh;
+            int* t4 = t3 + kh * nh;
+            int* p1 = t4 + kh * nh;
+            int* p3 = p1 + mh * nh;
+            int* p4 = p3 + mh * nh;
+            int* next = p4 + mh * nh;
+
+            add(a21, lda, a22, lda, s1, kh, mh, kh);        // S1 = A21 + A22
+            subtract(s1, kh, a11, lda, s2, kh, mh, kh);     // S2 = S1 - A11
+            subtract(a11, lda, a21, lda, s3, kh, mh, kh);   // S3 = A11 - A21
+            subtract(a12, lda, s2, kh, s4, kh, mh, kh);     // S4 = A12 - S2
+            subtract(b12, ldb, b11, ldb, t1, nh, kh, nh);   // T1 = B12 - B11
+            subtract(b22, ldb, t1, nh, t2, nh, kh, nh);     // T2 = B22 - T1
+            subtract(b22, ldb, b12, ldb, t3, nh, kh, nh);   // T3 = B22 - B12
+            subtract(t2, nh, b21, ldb, t4, nh, kh, nh);     // T4 = T2 - B21
+
+            // P2, P5, P6 and P7 are written to the quadrants of C, the others to the workspace
+            struct Product
+            {
+                int const* a;
+                std::size_t lda;
+                int const* b;
+                std::size_t ldb;
+                int* c;
+                std::size_t ldc;
+            };
+
+            Product const products[7] = {
+                { a11, lda, b11, ldb, p1, nh },     // P1 = A11 B11
+                { a12, lda, b21, ldb, c11, ldc },   // P2 = A12 B21
+                { s4, kh, b22, ldb, p3, nh },       // P3 = S4 B22
+                { a22, lda, t4, nh, p4, nh },       // P4 = A22 T4
+                { s1, kh, t1, nh, c22, ldc },       // P5 = S1 T1
+                { s2, kh, t2, nh, c12, ldc },       // P6 = S2 T2
+                { s3, kh, t3, nh, c21, ldc },       // P7 = S3 T3
+            };
+
+            std::size_t const product_workspace = sequentialWorkspace(recursion, mh, kh, nh);
+
+            threads.run(7, [&](std::size_t i) {
+                Product const& product = products[i];
+                multiplySequential(recursion, product.a, product.lda, product.b, product.ldb, product.c, product.ldc,
+                    mh, kh, nh, next + i * product_workspace);
+            });
+
+            // C11 = P1 + P2, C12 = U2 + P5 + P3, C21 = U2 + P7 - P4, C22 = U2 + P7 + P5 with U2 = P1 + P6
+            threads.run(mh, [&](std::size_t i) {
+                for (std::size_t j = 0; j < nh; ++j) {
+                    unsigned const product1 = static_cast<unsigned>(p1[i * nh + j]);
+                    unsigned const product5 = static_cast<unsigned>(c22[i * ldc + j]);
+                    unsigned const u2 = product1 + static_cast<unsigned>(c12[i * ldc + j]);
+                    unsigned const u3 = u2 + static_cast<unsigned>(c21[i * ldc + j]);
+
+                    c11[i * ldc + j] = static_cast<int>(product1 + static_cast<unsigned>(c11[i * ldc + j]));
+                    c12[i * ldc + j] = static_cast<int>(u2 + product5 + static_cast<unsigned>(p3[i * nh + j]));
+                    c21[i * ldc + j] = static_cast<int>(u3 - static_cast<unsigned>(p4[i * nh + j]));
+                    c22[i * ldc + j] = static_cast<int>(u3 + product5);
+                }
+            });
+
+            multiplyPeeled(recursion, a, lda, b, ldb, c, ldc, rows, depth, columns);
+        }
+    }
+}
+
+void gemm::setStrassenCrossover(std::size_t crossover)
+{
+    strassenCrossover = (crossover == 0) ? 0 : std::max(crossover, MIN_STRASSEN_CROSSOVER);
+}
+
+std::size_t gemm::getStrassenCrossover()
+{
+    std::size_t crossover = strassenCrossover;
+
+    if (crossover == 0) {
+        char const* requested = std::getenv("GEMM_STRASSEN_CROSSOVER");
+
+        if (requested != nullptr) {
+            crossover = static_cast<std::size_t>(std::strtoul(requested, nullptr, 10));
+        }
+
+        crossover = (crossover == 0) ? DEFAULT_STRASSEN_CROSSOVER : std::max(crossover, MIN_STRASSEN_CROSSOVER);
+        strassenCrossover = crossover;
+    }
+
+    return crossover;
+}
+
+void gemm::multiplyStrassen(int const* a, int const* b, int* c, std::size_t rows, std::size_t columns, std::size_t depth)
+{
+    multiplyStrassen(a, b, c, rows, columns, depth, activeKernel());
+}
+
+void gemm::multiplyStrassen(int const* a, int const* b, int* c, std::size_t rows, std::size_t columns, std::size_t depth, Kernel const& kernel)
+{
+    Recursion const recursion{ kernel, getStrassenCrossover() };
+
+    if (isLeaf(recursion, rows, depth, columns)) {
+        multiplyLeaf(recursion, a, depth, b, columns, c, columns, rows, depth, columns);
+        return;
+    }
+
+    ThreadPool& threads = threadPool();
+
+    // The workspace of all levels is allocated once
+    if (threads.getThreadCount() > 1) {
+        std::vector<int> workspace(parallelWorkspace(recursion, rows, depth, columns));
+        multiplyParallel(recursion, a, depth, b, columns, c, columns, rows, depth, columns, workspace.data(), threads);
+    }
+    else {
+        std::vector<int> workspace(sequentialWorkspace(recursion, rows, depth, columns));
+        multiplySequential(recursion, a, depth, b, columns, c, columns, rows, depth, columns, workspace.data());
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef MatrixStrassen_hpp
+#define MatrixStrassen_hpp
+
+#include "MatrixKernels.hpp"
+
+#include <cstddef>
+
+/**
+* Strassen-Winograd multiplication of large integer matrices.
+*
+* Every recursion level splits the even-sized leading part of A, B and C into quadrants and
+* computes the product with 7 instead of 8 half-sized products and 15 additions. A trailing
+* odd row, column or depth is peeled off and handled by the blocked kernel, so any size is
+* supported without padding. The recursion stops at the crossover size, below which the
+* blocked kernel of MatrixMultiply.hpp is faster.
+*
+* The workspace of all levels is allocated once before the recursion starts. On the first level
+* the 7 sub-products are independent and computed in parallel on the shared thread pool.
+* Integer arithmetic is exact modulo 2^32, so the result equals the one of the blocked kernel.
+*/
+namespace gemm
+{
+    static constexpr std::size_t MIN_STRASSEN_CROSSOVER = 16; ///< Smallest accepted crossover size
+
+    /**
+     * Sets the crossover size: products with a dimension not larger than it are computed by the
+     * blocked kernel. Zero selects the value of the environment variable GEMM_STRASSEN_CROSSOVER
+     * or, if unset, the default. Must not be called while a product is computed.
+     */
+    void setStrassenCrossover(std::size_t crossover);
+
+    /** Returns the crossover size. */
+    std::size_t getStrassenCrossover();
+
+    /**
+     * Computes C = A * B for row-major matrices with the active micro-kernel at the leaves.
+     * A is rows x depth, B is depth x columns and C is rows x columns.
+     */
+    void multiplyStrassen(int const* a, int const* b, int* c, std::size_t rows, std::size_t columns, std::size_t depth);
+
+    /**
+     * Computes C = A * B with the given micro-kernel at the leaves.
+     */
+    void multiplyStrassen(int const* a, int const* b, int* c, std::size_t rows, std::size_t columns, std::size_t depth, Kernel const& kernel);
+}
+
+#endif //!MatrixStrassen_hpp
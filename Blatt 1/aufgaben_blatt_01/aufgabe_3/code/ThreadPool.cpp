@@ -0,0 +1,123 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t thread_cnt)
+    : m_stopping(false)
+{
+    if (thread_cnt == 0) {
+        thread_cnt = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // The calling thread takes part in every batch
+    for (std::size_t i = 1; i < thread_cnt; ++i) {
+        m_workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_wake.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(std::size_t count, std::function<void(std::size_t)> const& task)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // Nothing to distribute
+    if (m_workers.empty() || count == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    Batch batch{ task, count, { 0 }, 0, nullptr };
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_batches.push_back(&batch);
+    }
+
+    m_wake.notify_all();
+    execute(batch);
+
+    std::exception_ptr error;
+
+    {
+        // All tasks are handed out; wait for the workers still executing one of them
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_batches.erase(std::find(m_batches.begin(), m_batches.end(), &batch));
+        m_done.wait(lock, [&batch]() { return batch.helpers == 0; });
+
+        error = batch.error;
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::work() {
+    while (true) {
+        Batch* batch;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, &batch]() { return m_stopping || (batch = findBatch()) != nullptr; });
+
+            if (m_stopping) {
+                return;
+            }
+
+            // Registered under the lock, so the batch outlives the tasks this worker executes
+            ++batch->helpers;
+        }
+
+        execute(*batch);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (--batch->helpers == 0) {
+                m_done.notify_all();
+            }
+        }
+    }
+}
+
+ThreadPool::Batch* ThreadPool::findBatch() const {
+    // Nested batches are preferred, they block a thread of an outer batch
+    for (auto batch = m_batches.rbegin(); batch != m_batches.rend(); ++batch) {
+        if ((*batch)->next < (*batch)->count) {
+            return *batch;
+        }
+    }
+
+    return nullptr;
+}
+
+void ThreadPool::execute(Batch& batch) {
+    for (std::size_t i = batch.next++; i < batch.count; i = batch.next++) {
+        try {
+            batch.task(i);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!batch.error) {
+                batch.error = std::current_exception();
+            }
+        }
+    }
+}
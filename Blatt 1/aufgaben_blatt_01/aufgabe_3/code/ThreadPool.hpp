@@ -0,0 +1,75 @@
+#ifndef ThreadPool_hpp
+#define ThreadPool_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* Fixed-size pool of worker threads executing batches of independent tasks.
+* The calling thread takes part in every batch, so a pool of n threads starts n - 1 workers.
+* Tasks are handed out through an atomic counter, which balances tiles of different cost.
+* Batches may be started from within a task; idle workers then help with the nested batch.
+*/
+class ThreadPool
+{
+private:
+    /** Tasks started by one call of run. */
+    struct Batch
+    {
+        std::function<void(std::size_t)> const& task;  ///< Task of the batch
+        std::size_t count;                              ///< Number of tasks
+        std::atomic<std::size_t> next;                  ///< Next task index to hand out
+        std::size_t helpers;                            ///< Workers currently executing tasks of the batch
+        std::exception_ptr error;                       ///< First exception thrown by a task
+    };
+
+    std::vector<std::thread> m_workers;                     ///< Worker threads
+    std::mutex m_mutex;                                     ///< Guards the batch list and the batch states
+    std::condition_variable m_wake;                         ///< Signals a new batch or shutdown to the workers
+    std::condition_variable m_done;                         ///< Signals that a worker left a batch
+    std::vector<Batch*> m_batches;                          ///< Batches that may have tasks left, innermost last
+    bool m_stopping;                                        ///< Set when the pool is destroyed
+
+    /** Main loop of a worker thread. */
+    void work();
+
+    /** Returns the innermost batch with tasks left, or nullptr. Requires m_mutex. */
+    Batch* findBatch() const;
+
+    /** Executes tasks of the batch until none are left. */
+    void execute(Batch& batch);
+
+public:
+    /**
+     * Constructor. Creates a pool with the given number of threads including the calling thread.
+     * A thread count of zero uses one thread per hardware thread.
+     */
+    explicit ThreadPool(std::size_t thread_cnt = 0);
+    /** Destructor. Waits for the workers to finish. */
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const& other) = delete;
+    ThreadPool& operator=(ThreadPool const& rhs) = delete;
+
+    /** Returns the number of threads taking part in a batch, including the calling thread. */
+    std::size_t getThreadCount() const noexcept {
+        return m_workers.size() + 1;
+    }
+
+    /**
+     * Executes task(0), ..., task(count - 1) in parallel and waits for their completion.
+     * The first exception thrown by a task is rethrown after all tasks have finished.
+     * Called from within a task, the calling thread works on the nested batch together with
+     * the workers that are idle, so nested parallelism uses all threads of the pool.
+     */
+    void run(std::size_t count, std::function<void(std::size_t)> const& task);
+};
+
+#endif //!ThreadPool_hpp
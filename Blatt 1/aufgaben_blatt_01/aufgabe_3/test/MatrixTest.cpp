@@ -0,0 +1,320 @@
+/**
+ * Randomized comparison of the optimized matrix multiplication against a naive reference.
+ * Run by ctest with one and with several threads (GEMM_THREADS), see CMakeLists.txt.
+ */
+#include "MatrixInt.hpp"
+#include "MatrixKernels.hpp"
+#include "MatrixMultiply.hpp"
+#include "MatrixStrassen.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/** Checks whether the product of matrices of types L and R is defined. */
+template<class L, class R, class = void>
+struct CanMultiply : std::false_type {};
+
+template<class L, class R>
+struct CanMultiply<L, R, std::void_t<decltype(std::declval<L const&>() * std::declval<R const&>())>> : std::true_type {};
+
+// Fixed-size matrices are multiplied at compile time, and mismatching dimensions do not compile
+static_assert(CanMultiply<Matrix<int, 2, 3>, Matrix<int, 3, 4>>::value, "2 x 3 times 3 x 4 is defined");
+static_assert(!CanMultiply<Matrix<int, 2, 3>, Matrix<int, 2, 3>>::value, "2 x 3 times 2 x 3 is rejected");
+static_assert(!CanMultiply<Matrix<int, 3, 2>, Matrix<int, 3, 2>>::value, "3 x 2 times 3 x 2 is rejected");
+static_assert(std::is_same<decltype(Matrix<int, 2, 3>() * Matrix<int, 3, 4>()), Matrix<int, 2, 4>>::value, "product is 2 x 4");
+
+namespace fixedsize
+{
+    constexpr Matrix<int, 2, 3> a(1, 2, 3, 4, 5, 6);
+    constexpr Matrix<int, 3, 2> b(7, 8, 9, 10, 11, 12);
+    constexpr Matrix<int, 2, 2> product = a * b;
+
+    /** Returns lhs after lhs += rhs. */
+    constexpr Matrix<int, 2, 2> addAssign(Matrix<int, 2, 2> lhs, Matrix<int, 2, 2> const& rhs) {
+        lhs += rhs;
+        return lhs;
+    }
+
+    /** Returns lhs after lhs -= rhs. */
+    constexpr Matrix<int, 2, 2> subtractAssign(Matrix<int, 2, 2> lhs, Matrix<int, 2, 2> const& rhs) {
+        lhs -= rhs;
+        return lhs;
+    }
+
+    static_assert(product == Matrix<int, 2, 2>(58, 64, 139, 154), "constexpr product");
+    static_assert(product(1, 0) == 139 && product(0, 1) == 64, "row-major access");
+    static_assert(product * Matrix<int, 2, 2>::identity() == product, "identity");
+    static_assert(product + product - product == product, "constexpr sum and difference");
+    static_assert(addAssign(product, Matrix<int, 2, 2>(1, 1, 1, 1)) == Matrix<int, 2, 2>(59, 65, 140, 155), "constexpr +=");
+    static_assert(subtractAssign(product, Matrix<int, 2, 2>(8, 14, 39, 54)) == Matrix<int, 2, 2>(50, 50, 100, 100), "constexpr -=");
+    static_assert(product != Matrix<int, 2, 2>(), "inequality");
+}
+
+namespace
+{
+    std::mt19937 generator(42);  ///< Fixed seed, so that failures can be reproduced
+    int failures = 0;            ///< Number of failed checks
+
+    /** Reports a failed check. */
+    void check(bool passed, std::string const& name) {
+        if (!passed) {
+            std::cerr << "FAILED: " << name << std::endl;
+            ++failures;
+        }
+    }
+
+    /** Returns a uniformly distributed size in [1, max]. */
+    std::size_t randomSize(std::size_t max) {
+        return 1 + generator() % max;
+    }
+
+    /** Returns count random values in [-100, 100]. */
+    std::vector<int> randomValues(std::size_t count) {
+        std::vector<int> values(count);
+
+        for (int& value : values) {
+            value = int(generator() % 201) - 100;
+        }
+
+        return values;
+    }
+
+    /** Returns a matrix filled with random values. */
+    MatrixInt randomMatrix(unsigned int rows, unsigned int columns) {
+        MatrixInt matrix(rows, columns);
+        std::vector<int> const values = randomValues(std::size_t(rows) * columns);
+        std::copy(values.begin(), values.end(), matrix.data());
+        return matrix;
+    }
+
+    /** Computes C += A * B with the textbook triple loop. */
+    void multiplyReference(int const* a, int const* b, int* c, std::size_t rows, std::size_t columns, std::size_t depth) {
+        for (std::size_t i = 0; i < rows; ++i) {
+            for (std::size_t k = 0; k < depth; ++k) {
+                for (std::size_t j = 0; j < columns; ++j) {
+                    c[i * columns + j] += a[i * depth + k] * b[k * columns + j];
+                }
+            }
+        }
+    }
+
+    /** Returns A * B computed by multiplyReference. */
+    MatrixInt multiplyReference(MatrixInt const& a, MatrixInt const& b) {
+        MatrixInt c(a.getRowCount(), b.getColumnCount());
+        multiplyReference(a.data(), b.data(), c.data(), a.getRowCount(), b.getColumnCount(), a.getColumnCount());
+        return c;
+    }
+
+    /** Returns lhs + sign * rhs. */
+    MatrixInt addReference(MatrixInt lhs, MatrixInt const& rhs, int sign = 1) {
+        for (std::size_t i = 0; i < std::size_t(lhs.getRowCount()) * lhs.getColumnCount(); ++i) {
+            lhs.data()[i] += sign * rhs.data()[i];
+        }
+
+        return lhs;
+    }
+
+    /** Compares the sizes and values of two matrices. */
+    template<class T>
+    bool equal(Matrix<T> const& lhs, Matrix<T> const& rhs) {
+        return lhs.getRowCount() == rhs.getRowCount() && lhs.getColumnCount() == rhs.getColumnCount()
+            && std::equal(lhs.data(), lhs.data() + std::size_t(lhs.getRowCount()) * lhs.getColumnCount(), rhs.data());
+    }
+
+    /** Returns "rows x columns x depth" for failure messages. */
+    std::string shape(std::size_t rows, std::size_t columns, std::size_t depth) {
+        return std::to_string(rows) + " x " + std::to_string(columns) + " x " + std::to_string(depth);
+    }
+
+    /**
+     * Compares C += A * B computed by multiply with the reference for random shapes: small ones,
+     * ones that span several packed panels, and tall or wide ones with partial tiles.
+     */
+    template<class Multiply>
+    void checkRandomProducts(std::string const& name, Multiply multiply) {
+        for (int test = 0; test < 40; ++test) {
+            std::size_t rows = randomSize(200), columns = randomSize(200), depth = randomSize(300);
+
+            if (test % 10 == 0) {
+                rows = randomSize(1500);
+                columns = randomSize(20);
+                depth = randomSize(20);
+            }
+            else if (test % 10 == 1) {
+                rows = randomSize(20);
+                columns = randomSize(1500);
+                depth = randomSize(400);
+            }
+
+            std::vector<int> const a = randomValues(rows * depth);
+            std::vector<int> const b = randomValues(depth * columns);
+            std::vector<int> c = randomValues(rows * columns);
+            std::vector<int> expected = c;
+
+            multiplyReference(a.data(), b.data(), expected.data(), rows, columns, depth);
+            multiply(a.data(), b.data(), c.data(), rows, columns, depth);
+
+            check(c == expected, name + ", " + shape(rows, columns, depth));
+        }
+    }
+
+    /** Checks the blocked multiplication with the default kernel and MatrixInt::operator*. */
+    void testMultiply() {
+        checkRandomProducts("blocked multiply", [](int const* a, int const* b, int* c, std::size_t rows, std::size_t columns, std::size_t depth) {
+            gemm::multiplyAdd(a, b, c, rows, columns, depth);
+        });
+
+        MatrixInt const a = randomMatrix(300, 200), b = randomMatrix(200, 250);
+        MatrixInt const product = a * b;
+        check(equal(product, multiplyReference(a, b)), "MatrixInt 300 x 250 x 200 product");
+    }
+
+    /** Checks every micro-kernel the CPU can execute, not only the one selected by default. */
+    void testKernels() {
+        for (gemm::Kernel const& kernel : gemm::availableKernels()) {
+            checkRandomProducts(std::string(kernel.name) + " kernel", [&kernel](int const* a, int const* b, int* c, std::size_t rows, std::size_t columns, std::size_t depth) {
+                gemm::multiplyAdd(a, b, c, rows, columns, depth, kernel);
+            });
+        }
+    }
+
+    /** Checks Strassen-Winograd with a small crossover, so that odd sizes are peeled on several levels. */
+    void testStrassen() {
+        std::size_t const crossover = gemm::getStrassenCrossover();
+        gemm::setStrassenCrossover(16);
+
+        for (int test = 0; test < 40; ++test) {
+            std::size_t const rows = randomSize(200), columns = randomSize(200), depth = randomSize(200);
+
+            std::vector<int> const a = randomValues(rows * depth);
+            std::vector<int> const b = randomValues(depth * columns);
+            std::vector<int> c = randomValues(rows * columns);
+            std::vector<int> expected(rows * columns, 0);
+
+            multiplyReference(a.data(), b.data(), expected.data(), rows, columns, depth);
+            gemm::multiplyStrassen(a.data(), b.data(), c.data(), rows, columns, depth);
+
+            check(c == expected, "Strassen, " + shape(rows, columns, depth));
+        }
+
+        // Leaves large enough for the blocked multiply to start nested batches on the thread pool
+        gemm::setStrassenCrossover(256);
+
+        std::size_t const size = 600;
+        std::vector<int> const a = randomValues(size * size);
+        std::vector<int> const b = randomValues(size * size);
+        std::vector<int> c(size * size);
+        std::vector<int> expected(size * size, 0);
+
+        multiplyReference(a.data(), b.data(), expected.data(), size, size, size);
+        gemm::multiplyStrassen(a.data(), b.data(), c.data(), size, size, size);
+
+        check(c == expected, "Strassen with parallel leaves, " + shape(size, size, size));
+
+        gemm::setStrassenCrossover(crossover);
+    }
+
+    /** Checks matrix expressions: chains, sums, compound assignment and operands aliasing the target. */
+    void testExpressions() {
+        MatrixInt const a = randomMatrix(37, 5), b = randomMatrix(5, 80), c = randomMatrix(80, 3), d = randomMatrix(3, 61);
+        MatrixInt const e = randomMatrix(37, 80), s = randomMatrix(40, 40), t = randomMatrix(40, 40);
+        MatrixInt const ab = multiplyReference(a, b);
+
+        MatrixInt chain = a * b * c * d;
+        check(equal(chain, multiplyReference(multiplyReference(ab, c), d)), "chain A * B * C * D");
+
+        MatrixInt grouped = a * (b * c) * d;
+        check(equal(grouped, chain), "chain A * (B * C) * D");
+
+        MatrixInt sum = a * b + e - e;
+        check(equal(sum, ab), "A * B + E - E");
+
+        MatrixInt assigned = e;
+        int const* storage = assigned.data();
+        assigned = a * b + e;
+        check(equal(assigned, addReference(ab, e)) && assigned.data() == storage, "assignment reuses the storage");
+
+        MatrixInt added = e;
+        added += a * b;
+        check(equal(added, addReference(e, ab)), "X += A * B");
+
+        MatrixInt subtracted = e;
+        subtracted -= a * b;
+        check(equal(subtracted, addReference(e, ab, -1)), "X -= A * B");
+
+        MatrixInt aliased = s;
+        aliased = aliased * t;
+        check(equal(aliased, multiplyReference(s, t)), "X = X * T");
+
+        MatrixInt accumulated = s;
+        accumulated += accumulated * t;
+        check(equal(accumulated, addReference(s, multiplyReference(s, t))), "X += X * T");
+
+        MatrixInt difference = s;
+        difference -= t - difference;
+        check(equal(difference, addReference(addReference(s, t, -1), s)), "X -= T - X");
+
+
+        MatrixInt const mismatch = a * c;
+        check(mismatch.getRowCount() == 0 && mismatch.getColumnCount() == 0, "size mismatch yields an empty matrix");
+    }
+
+    /**
+     * Checks products of non-int matrices, which use the generic blocked loop instead of the
+     * kernels. The values are small integers, so float and double results are exact.
+     */
+    template<class T>
+    void testGeneric(std::string const& name) {
+        for (int test = 0; test < 20; ++test) {
+            unsigned int const rows = unsigned(randomSize(120)), columns = unsigned(randomSize(120)), depth = unsigned(randomSize(120));
+
+            MatrixInt const a = randomMatrix(rows, depth), b = randomMatrix(depth, columns), c = randomMatrix(rows, columns);
+            Matrix<T> const a_converted(a), b_converted(b);
+
+            Matrix<T> product = a_converted * b_converted;
+            check(equal(product, Matrix<T>(multiplyReference(a, b))), name + " product, " + shape(rows, columns, depth));
+
+            Matrix<T> accumulated(c);
+            accumulated += a_converted * b_converted;
+            check(equal(accumulated, Matrix<T>(addReference(c, multiplyReference(a, b)))), name + " +=, " + shape(rows, columns, depth));
+        }
+    }
+
+    /** Checks a fixed-size product of random values against the reference and the dynamic matrix. */
+    void testFixed() {
+        Matrix<int, 4, 4> a, b;
+
+        for (std::size_t i = 0; i < 16; ++i) {
+            a.data()[i] = int(generator() % 201) - 100;
+            b.data()[i] = int(generator() % 201) - 100;
+        }
+
+        Matrix<int, 4, 4> const product = a * b;
+        check(equal(product.toDynamic(), multiplyReference(a.toDynamic(), b.toDynamic())), "fixed-size 4 x 4 product");
+    }
+}
+
+int main()
+{
+    testMultiply();
+    testKernels();
+    testStrassen();
+    testExpressions();
+    testGeneric<float>("float");
+    testGeneric<double>("double");
+    testFixed();
+
+    if (failures != 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -1,27 +1,139 @@
 #include "ColorSpaces.hpp"
 
 #include "Image.hpp"
+#include "ImageAllocations.hpp"
 #include "ImageIO.hpp"
 #include "ImageConverter.hpp"
 #include "ImageManipulation.hpp"
+#include "ImageMetrics.hpp"
+#include "StageProfiler.hpp"
 
+#include <cmath>
 #include <exception>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
 
+namespace
+{
+    /// <summary>
+    /// Compare two images if both use the given color space
+    /// </summary>
+    /// <param name="first">First image</param>
+    /// <param name="second">Second image</param>
+    /// <param name="comparison">Result</param>
+    /// <returns>True if both images use the color space</returns>
+    template <cg::color_space_t color_space>
+    bool compare_as(const cg::image_base& first, const cg::image_base& second, cg::image_comparison& comparison)
+    {
+        const auto* first_image = dynamic_cast<const cg::image<color_space>*>(&first);
+        const auto* second_image = dynamic_cast<const cg::image<color_space>*>(&second);
+
+        if (first_image == nullptr || second_image == nullptr)
+        {
+            return false;
+        }
+
+        comparison = cg::image_metrics::compare(*first_image, *second_image);
+
+        return true;
+    }
+
+    /// <summary>
+    /// Parse a report option of the form --name, --name=text or --name=json
+    /// </summary>
+    /// <param name="option">Command line argument</param>
+    /// <param name="name">Option name including the dashes</param>
+    /// <param name="enabled">Set if the option was given</param>
+    /// <param name="format">Set to the requested format</param>
+    /// <returns>True if the argument is this option</returns>
+    bool parse_report_option(const std::string& option, const std::string& name, bool& enabled, cg::report_format_t& format)
+    {
+        if (option == name || option == name + "=text")
+        {
+            format = cg::report_format_t::Text;
+        }
+        else if (option == name + "=json")
+        {
+            format = cg::report_format_t::JSON;
+        }
+        else if (option.compare(0, name.size() + 1, name + "=") == 0)
+        {
+            throw std::runtime_error("Invalid report format: " + option);
+        }
+        else
+        {
+            return false;
+        }
+
+        enabled = true;
+
+        return true;
+    }
+}
+
 int main(const int argc, const char** argv)
 {
+    // Compare two images instead of running an exercise
+    if (argc >= 2 && std::string(argv[1]) == "compare")
+    {
+        if (argc != 4 && argc != 5)
+        {
+            std::cerr << "Error: No images to compare specified" << std::endl;
+            std::cout << "Call program with parameters compare <first> <second> [<tolerance>]" << std::endl << std::endl;
+
+            return 2;
+        }
+
+        try
+        {
+            return compare_images(argv[2], argv[3], (argc == 5) ? std::stod(argv[4]) : 0.0);
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "Invalid tolerance: " << argv[4] << std::endl;
+
+            return 2;
+        }
+    }
+
+    // Optional reports on stderr: stage times, throughput and memory, and image allocations
+    bool profile = false;
+    bool allocations = false;
+    cg::report_format_t profile_format = cg::report_format_t::Text;
+    cg::report_format_t allocations_format = cg::report_format_t::Text;
+    int first_file = 1;
+
+    try
+    {
+        while (first_file < argc && (parse_report_option(argv[first_file], "--profile", profile, profile_format) ||
+            parse_report_option(argv[first_file], "--allocations", allocations, allocations_format)))
+        {
+            ++first_file;
+        }
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cerr << e.what() << std::endl;
+
+        return 1;
+    }
+
+    cg::image_allocations::enable(allocations);
+
     // Read command line arguments
-    if (argc != 3)
+    if (argc - first_file != 2)
     {
         std::cerr << "Error: No input and output file specified" << std::endl;
-        std::cout << "Call program with parameters <source> <target>" << std::endl << std::endl;
+        std::cout << "Call program with parameters [--profile[=text|json]] [--allocations[=text|json]] <source> <target>" << std::endl;
+        std::cout << "or compare <first> <second> [<tolerance>]" << std::endl << std::endl;
 
         return 1;
     }
 
-    std::string source_file(argv[1]);
-    std::string target_file(argv[2]);
+    std::string source_file(argv[first_file]);
+    std::string target_file(argv[first_file + 1]);
 
     std::cout << "Source file: " << source_file << std::endl;
     std::cout << "Target file: " << target_file << std::endl << std::endl;
@@ -31,28 +143,39 @@ int main(const int argc, const char** argv)
     std::cout << "Select exercise [1-4]: ";
     std::cin >> exercise;
 
+    cg::stage_profiler profiler("aufgabe" + std::to_string(exercise), profile);
+
     switch (exercise)
     {
     case 1:
-        aufgabe1(source_file, target_file);
+        aufgabe1(source_file, target_file, profiler);
         break;
     case 2:
-        aufgabe2(source_file, target_file);
+        aufgabe2(source_file, target_file, profiler);
         break;
     case 3:
-        aufgabe3(source_file, target_file);
+        aufgabe3(source_file, target_file, profiler);
         break;
     case 4:
-        aufgabe4(source_file, target_file);
+        aufgabe4(source_file, target_file, profiler);
         break;
     default:
         std::cerr << "Invalid exercise: " << exercise << std::endl;
+
+        return 0;
+    }
+
+    profiler.report(std::cerr, profile_format);
+
+    if (allocations)
+    {
+        cg::image_allocations::report(std::cerr, allocations_format);
     }
 
     return 0;
 }
 
-void aufgabe1(const std::string& source_file, const std::string& target_file)
+void aufgabe1(const std::string& source_file, const std::string& target_file, cg::stage_profiler& profiler)
 {
     try
     {
@@ -64,9 +187,15 @@ void aufgabe1(const std::string& source_file, const std::string& target_file)
         //    a function from image_io
 
         // ...
+        profiler.begin("load", "load_rgb_image");
         auto rgb_image = cg::image_io::load_rgb_image(source_file);
+        profiler.end(cg::stage_profiler::pixels(rgb_image), cg::stage_profiler::file_size(source_file));
+        profiler.begin("convert", "rgb_to_gray");
         auto grayscale_image = cg::image_converter::rgb_to_gray(rgb_image);
+        profiler.end(cg::stage_profiler::pixels(grayscale_image), cg::stage_profiler::bytes(rgb_image) + cg::stage_profiler::bytes(grayscale_image));
+        profiler.begin("save", "save_grayscale_image");
         cg::image_io::save_grayscale_image(target_file, grayscale_image);
+        profiler.end(cg::stage_profiler::pixels(grayscale_image), cg::stage_profiler::file_size(target_file));
 
         std::cout << "File successfully created" << std::endl << std::endl;
     }
@@ -80,7 +209,7 @@ void aufgabe1(const std::string& source_file, const std::string& target_file)
     }
 }
 
-void aufgabe2(const std::string& source_file, const std::string& target_file)
+void aufgabe2(const std::string& source_file, const std::string& target_file, cg::stage_profiler& profiler)
 {
     try
     {
@@ -93,9 +222,15 @@ void aufgabe2(const std::string& source_file, const std::string& target_file)
         //    a function from image_io
 
         // ...
+        profiler.begin("load", "load_grayscale_image");
         auto grayscale_image = cg::image_io::load_grayscale_image(source_file);
+        profiler.end(cg::stage_profiler::pixels(grayscale_image), cg::stage_profiler::file_size(source_file));
+        profiler.begin("convert", "gray_to_bw");
         auto bw_image = cg::image_converter::gray_to_bw(grayscale_image);
+        profiler.end(cg::stage_profiler::pixels(bw_image), cg::stage_profiler::bytes(grayscale_image) + cg::stage_profiler::bytes(bw_image));
+        profiler.begin("save", "save_bw_image");
         cg::image_io::save_bw_image(target_file, bw_image);
+        profiler.end(cg::stage_profiler::pixels(bw_image), cg::stage_profiler::file_size(target_file));
 
         std::cout << "File successfully created" << std::endl << std::endl;
     }
@@ -109,7 +244,7 @@ void aufgabe2(const std::string& source_file, const std::string& target_file)
     }
 }
 
-void aufgabe3(const std::string& source_file, const std::string& target_file)
+void aufgabe3(const std::string& source_file, const std::string& target_file, cg::stage_profiler& profiler)
 {
     try
     {
@@ -122,10 +257,18 @@ void aufgabe3(const std::string& source_file, const std::string& target_file)
         //    function from image_io
 
         // ...
+        profiler.begin("load", "load_rgb_image");
         auto rgb_image = cg::image_io::load_rgb_image(source_file);
+        profiler.end(cg::stage_profiler::pixels(rgb_image), cg::stage_profiler::file_size(source_file));
+        profiler.begin("convert", "rgb_to_hsv");
         auto hsv_image = cg::image_converter::rgb_to_hsv(rgb_image);
+        profiler.end(cg::stage_profiler::pixels(hsv_image), cg::stage_profiler::bytes(rgb_image) + cg::stage_profiler::bytes(hsv_image));
+        profiler.begin("convert", "hsv_to_rgb");
         auto rgb_image_re = cg::image_converter::hsv_to_rgb(hsv_image);
+        profiler.end(cg::stage_profiler::pixels(rgb_image_re), cg::stage_profiler::bytes(hsv_image) + cg::stage_profiler::bytes(rgb_image_re));
+        profiler.begin("save", "save_rgb_image");
         cg::image_io::save_rgb_image(target_file, rgb_image_re);
+        profiler.end(cg::stage_profiler::pixels(rgb_image_re), cg::stage_profiler::file_size(target_file));
 
         std::cout << "File successfully created" << std::endl << std::endl;
     }
@@ -139,7 +282,7 @@ void aufgabe3(const std::string& source_file, const std::string& target_file)
     }
 }
 
-void aufgabe4(const std::string& source_file, const std::string& target_file)
+void aufgabe4(const std::string& source_file, const std::string& target_file, cg::stage_profiler& profiler)
 {
     try
     {
@@ -155,11 +298,21 @@ void aufgabe4(const std::string& source_file, const std::string& target_file)
         //    function from image_io
 
         // ...
+        profiler.begin("load", "load_rgb_image");
         auto rgb_image = cg::image_io::load_rgb_image(source_file);
+        profiler.end(cg::stage_profiler::pixels(rgb_image), cg::stage_profiler::file_size(source_file));
+        profiler.begin("convert", "rgb_to_hsv");
         auto hsv_image = cg::image_converter::rgb_to_hsv(rgb_image);
+        profiler.end(cg::stage_profiler::pixels(hsv_image), cg::stage_profiler::bytes(rgb_image) + cg::stage_profiler::bytes(hsv_image));
+        profiler.begin("effect", "modify_in_hsv");
         auto effect_hsv_image = cg::image_manipulation::modify_in_hsv(hsv_image);
+        profiler.end(cg::stage_profiler::pixels(effect_hsv_image), cg::stage_profiler::bytes(hsv_image) + cg::stage_profiler::bytes(effect_hsv_image));
+        profiler.begin("convert", "hsv_to_rgb");
         auto effect_rgb_image = cg::image_converter::hsv_to_rgb(effect_hsv_image);
+        profiler.end(cg::stage_profiler::pixels(effect_rgb_image), cg::stage_profiler::bytes(effect_hsv_image) + cg::stage_profiler::bytes(effect_rgb_image));
+        profiler.begin("save", "save_rgb_image");
         cg::image_io::save_rgb_image(target_file, effect_rgb_image);
+        profiler.end(cg::stage_profiler::pixels(effect_rgb_image), cg::stage_profiler::file_size(target_file));
 
         std::cout << "File successfully created" << std::endl << std::endl;
     }
@@ -172,3 +325,54 @@ void aufgabe4(const std::string& source_file, const std::string& target_file)
         std::cerr << "Unknown error" << std::endl;
     }
 }
+
+int compare_images(const std::string& first_file, const std::string& second_file, const double tolerance)
+{
+    try
+    {
+        if (!(tolerance >= 0.0))
+        {
+            throw std::runtime_error("Tolerance must not be negative");
+        }
+
+        const auto first = cg::image_io::load_image(first_file);
+        const auto second = cg::image_io::load_image(second_file);
+
+        cg::image_comparison comparison;
+
+        if (!compare_as<cg::color_space_t::BW>(*first, *second, comparison) &&
+            !compare_as<cg::color_space_t::Gray>(*first, *second, comparison) &&
+            !compare_as<cg::color_space_t::RGB>(*first, *second, comparison) &&
+            !compare_as<cg::color_space_t::RGBA>(*first, *second, comparison))
+        {
+            throw std::runtime_error("Images must have the same color space");
+        }
+
+        std::cout << "Max. absolute difference: " << comparison.max_abs_diff << std::endl;
+        std::cout << "MSE: " << comparison.mse << std::endl;
+        std::cout << "PSNR: " << comparison.psnr << " dB" << std::endl;
+        std::cout << "SSIM: " << comparison.ssim << std::endl << std::endl;
+
+        // NaN values never match
+        if (comparison.max_abs_diff <= tolerance && !std::isnan(comparison.mse))
+        {
+            std::cout << "Images match (tolerance " << tolerance << ")" << std::endl;
+
+            return 0;
+        }
+
+        std::cout << "Images differ (tolerance " << tolerance << ")" << std::endl;
+
+        return 1;
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown error" << std::endl;
+    }
+
+    return 2;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "StageProfiler.hpp"
+
 #include <string>
 
 /// <summary>
@@ -9,9 +11,18 @@ int main(int argc, const char** argv);
 
 /// <summary>
 /// Exercises
+/// Each stage (load, convert, effect, save) is recorded by the profiler if it is enabled.
 /// </summary>
-void aufgabe1(const std::string& source_file, const std::string& target_file);
-void aufgabe2(const std::string& source_file, const std::string& target_file);
-void aufgabe3(const std::string& source_file, const std::string& target_file);
-void aufgabe4(const std::string& source_file, const std::string& target_file);
+void aufgabe1(const std::string& source_file, const std::string& target_file, cg::stage_profiler& profiler);
+void aufgabe2(const std::string& source_file, const std::string& target_file, cg::stage_profiler& profiler);
+void aufgabe3(const std::string& source_file, const std::string& target_file, cg::stage_profiler& profiler);
+void aufgabe4(const std::string& source_file, const std::string& target_file, cg::stage_profiler& profiler);
 
+/// <summary>
+/// Compare two image files of the same size and color space
+/// </summary>
+/// <param name="first_file">First image file</param>
+/// <param name="second_file">Second image file</param>
+/// <param name="tolerance">Largest allowed absolute difference of any channel value</param>
+/// <returns>Exit code: 0 if the images match, 1 if they differ, 2 on errors</returns>
+int compare_images(const std::string& first_file, const std::string& second_file, double tolerance);
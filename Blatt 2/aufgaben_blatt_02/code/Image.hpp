@@ -2,11 +2,14 @@
 
 #include "ImageTraits.hpp"
 #include "ImageBase.hpp"
+#include "ImageAllocations.hpp"
 
 #include <array>
+#include <cstddef>
 #include <exception>
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 #include <vector>
 
 namespace cg
@@ -25,15 +28,15 @@ namespace cg
 		/// Tuple type for storing all color channels of a pixel
 		using tuple_type = std::array<value_type, color_channels<color_space>::value>;
 
-		/// Data type for containing all pixels of the image
-		using data_type = std::vector<tuple_type>;
+		/// Data type for containing all pixels of the image (allocations are counted by image_allocations)
+		using data_type = std::vector<tuple_type, image_allocator<tuple_type>>;
 
 		/// <summary>
 		/// Constructor
 		/// </summary>
 		/// <param name="width">Image width</param>
 		/// <param name="height">Image height</param>
-		image(unsigned int width, unsigned int height);
+		image(std::size_t width, std::size_t height);
 
 		/// <summary>
 		/// Get color space
@@ -64,11 +67,25 @@ namespace cg
 		/// <param name="i">Index in x direction</param>
 		/// <param name="j">Index in y direction</param>
 		/// <returns>Pixel value</returns>
-		const tuple_type& at(unsigned int i, unsigned int j) const;
-		tuple_type& at(unsigned int i, unsigned int j);
+		const tuple_type& at(std::size_t i, std::size_t j) const;
+		tuple_type& at(std::size_t i, std::size_t j);
 
-		const tuple_type& operator()(unsigned int i, unsigned int j) const;
-		tuple_type& operator()(unsigned int i, unsigned int j);
+		const tuple_type& operator()(std::size_t i, std::size_t j) const;
+		tuple_type& operator()(std::size_t i, std::size_t j);
+
+		/// <summary>
+		/// Access the pixel storage (row-major, without bounds checks)
+		/// </summary>
+		/// <returns>Pixel data</returns>
+		const data_type& get_data() const;
+		data_type& get_data();
+
+		/// <summary>
+		/// Access the color values of all pixels as interleaved floats (row-major, without bounds checks)
+		/// </summary>
+		/// <returns>Pointer to the first value</returns>
+		const value_type* get_values() const;
+		value_type* get_values();
 
 	private:
 		/// <summary>
@@ -77,7 +94,7 @@ namespace cg
 		/// <param name="i">Index in x direction</param>
 		/// <param name="j">Index in y direction</param>
 		/// <returns>Pixel index</returns>
-		unsigned int index(const unsigned int i, const unsigned int j) const;
+		std::size_t index(std::size_t i, std::size_t j) const;
 
 		/// Image data
 		data_type data;
@@ -85,9 +102,14 @@ namespace cg
 }
 
 template <cg::color_space_t color_space>
-inline cg::image<color_space>::image(const unsigned int width, const unsigned int height)
+inline cg::image<color_space>::image(const std::size_t width, const std::size_t height)
 	: cg::image_base(width, height)
 {
+	if (height != 0 && width > this->data.max_size() / height)
+	{
+		throw std::runtime_error("Image too large");
+	}
+
 	this->data.resize(width * height);
 }
 
@@ -126,31 +148,59 @@ inline void cg::image<color_space>::initialize(const tuple_type& initial_value)
 }
 
 template <cg::color_space_t color_space>
-inline const typename cg::image<color_space>::tuple_type& cg::image<color_space>::at(const unsigned int i, const unsigned int j) const
+inline const typename cg::image<color_space>::tuple_type& cg::image<color_space>::at(const std::size_t i, const std::size_t j) const
 {
 	return this->data[index(i, j)];
 }
 
 template <cg::color_space_t color_space>
-inline typename cg::image<color_space>::tuple_type& cg::image<color_space>::at(const unsigned int i, const unsigned int j)
+inline typename cg::image<color_space>::tuple_type& cg::image<color_space>::at(const std::size_t i, const std::size_t j)
 {
 	return this->data[index(i, j)];
 }
 
 template <cg::color_space_t color_space>
-inline const typename cg::image<color_space>::tuple_type& cg::image<color_space>::operator()(const unsigned int i, const unsigned int j) const
+inline const typename cg::image<color_space>::tuple_type& cg::image<color_space>::operator()(const std::size_t i, const std::size_t j) const
 {
 	return at(i, j);
 }
 
 template <cg::color_space_t color_space>
-inline typename cg::image<color_space>::tuple_type& cg::image<color_space>::operator()(const unsigned int i, const unsigned int j)
+inline typename cg::image<color_space>::tuple_type& cg::image<color_space>::operator()(const std::size_t i, const std::size_t j)
 {
 	return at(i, j);
 }
 
 template <cg::color_space_t color_space>
-inline unsigned int cg::image<color_space>::index(const unsigned int i, const unsigned int j) const
+inline const typename cg::image<color_space>::data_type& cg::image<color_space>::get_data() const
+{
+	return this->data;
+}
+
+template <cg::color_space_t color_space>
+inline typename cg::image<color_space>::data_type& cg::image<color_space>::get_data()
+{
+	return this->data;
+}
+
+template <cg::color_space_t color_space>
+inline const typename cg::image<color_space>::value_type* cg::image<color_space>::get_values() const
+{
+	static_assert(sizeof(tuple_type) == color_channels<color_space>::value * sizeof(value_type), "Pixels must be stored as tightly packed values");
+
+	return reinterpret_cast<const value_type*>(this->data.data());
+}
+
+template <cg::color_space_t color_space>
+inline typename cg::image<color_space>::value_type* cg::image<color_space>::get_values()
+{
+	static_assert(sizeof(tuple_type) == color_channels<color_space>::value * sizeof(value_type), "Pixels must be stored as tightly packed values");
+
+	return reinterpret_cast<value_type*>(this->data.data());
+}
+
+template <cg::color_space_t color_space>
+inline std::size_t cg::image<color_space>::index(const std::size_t i, const std::size_t j) const
 {
 	if (i >= this->width || j >= this->height)
 	{
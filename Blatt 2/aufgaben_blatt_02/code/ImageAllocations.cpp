@@ -0,0 +1,224 @@
+#include "ImageAllocations.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace cg
+{
+	namespace
+	{
+		/// Name of allocations outside any site
+		const char* const unattributed_site = "unattributed";
+
+		/// <summary>
+		/// Counters of one call site
+		/// </summary>
+		struct site_counters
+		{
+			std::uint64_t allocations = 0;
+			std::uint64_t allocated_bytes = 0;
+			std::uint64_t live_bytes = 0;
+			std::uint64_t peak_bytes = 0;
+		};
+
+		/// <summary>
+		/// Counted buffer that is still alive
+		/// </summary>
+		struct live_buffer
+		{
+			std::size_t bytes;
+			site_counters* site;
+		};
+
+		/// <summary>
+		/// Counters of all buffers, guarded by one mutex (pixel buffers are large and allocated rarely)
+		/// </summary>
+		struct allocation_counters
+		{
+			std::mutex mutex;
+			image_allocations::statistics totals = {};
+
+			/// Sites by name (names are compared by content, the same literal may exist in several translation units)
+			std::map<std::string, site_counters> sites;
+
+			/// Buffers counted at allocation, so that their size and site are known when they are freed
+			std::unordered_map<const void*, live_buffer> buffers;
+		};
+
+		/// <summary>
+		/// Get the counters, created on first use
+		/// </summary>
+		/// <returns>Counters</returns>
+		allocation_counters& counters()
+		{
+			// Never destroyed, images with static storage duration may be freed after it
+			static allocation_counters* instance = new allocation_counters();
+			return *instance;
+		}
+
+		/// Outermost site of the current thread
+		thread_local const char* current_site = nullptr;
+	}
+}
+
+std::atomic<bool> cg::image_allocations::enabled(false);
+std::atomic<std::size_t> cg::image_allocations::live_buffers(0);
+
+void cg::image_allocations::enable(const bool state)
+{
+	enabled.store(state, std::memory_order_relaxed);
+}
+
+void cg::image_allocations::reset()
+{
+	auto& all = counters();
+	std::lock_guard<std::mutex> lock(all.mutex);
+
+	const std::uint64_t live = all.totals.live_bytes;
+	all.totals = statistics{ 0, 0, 0, live, live };
+
+	for (auto& site : all.sites)
+	{
+		site.second.allocations = 0;
+		site.second.allocated_bytes = 0;
+		site.second.peak_bytes = site.second.live_bytes;
+	}
+}
+
+cg::image_allocations::statistics cg::image_allocations::get_statistics()
+{
+	auto& all = counters();
+	std::lock_guard<std::mutex> lock(all.mutex);
+
+	return all.totals;
+}
+
+std::vector<cg::image_allocations::site_statistics> cg::image_allocations::get_sites()
+{
+	std::vector<site_statistics> sites;
+
+	{
+		auto& all = counters();
+		std::lock_guard<std::mutex> lock(all.mutex);
+
+		for (const auto& site : all.sites)
+		{
+			sites.push_back(site_statistics{ site.first, site.second.allocations, site.second.allocated_bytes, site.second.live_bytes, site.second.peak_bytes });
+		}
+	}
+
+	std::stable_sort(sites.begin(), sites.end(), [](const site_statistics& first, const site_statistics& second)
+	{
+		return first.allocated_bytes > second.allocated_bytes;
+	});
+
+	return sites;
+}
+
+void cg::image_allocations::report(std::ostream& out, const report_format_t format)
+{
+	const auto totals = get_statistics();
+	const auto sites = get_sites();
+
+	// Format into a buffer first, so that the report is not interleaved with other output and the stream state is kept
+	std::ostringstream buffer;
+
+	if (format == report_format_t::JSON)
+	{
+		for (const auto& site : sites)
+		{
+			buffer << "{\"site\":\"" << escape_json(site.site) << "\",\"allocations\":" << site.allocations << ",\"allocated_bytes\":" << site.allocated_bytes
+				<< ",\"live_bytes\":" << site.live_bytes << ",\"peak_bytes\":" << site.peak_bytes << "}" << std::endl;
+		}
+
+		buffer << "{\"site\":\"total\",\"allocations\":" << totals.allocations << ",\"deallocations\":" << totals.deallocations
+			<< ",\"allocated_bytes\":" << totals.allocated_bytes << ",\"live_bytes\":" << totals.live_bytes << ",\"peak_bytes\":" << totals.peak_bytes << "}" << std::endl;
+	}
+	else
+	{
+		const auto mib = [](const std::uint64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+
+		buffer << "Image allocations" << std::endl;
+		buffer << std::left << std::setw(40) << "site" << std::right << std::setw(8) << "count" << std::setw(14) << "total MiB"
+			<< std::setw(12) << "live MiB" << std::setw(12) << "peak MiB" << std::endl;
+		buffer << std::fixed << std::setprecision(2);
+
+		for (const auto& site : sites)
+		{
+			buffer << std::left << std::setw(40) << site.site << std::right << std::setw(8) << site.allocations << std::setw(14) << mib(site.allocated_bytes)
+				<< std::setw(12) << mib(site.live_bytes) << std::setw(12) << mib(site.peak_bytes) << std::endl;
+		}
+
+		buffer << std::left << std::setw(40) << "total" << std::right << std::setw(8) << totals.allocations << std::setw(14) << mib(totals.allocated_bytes)
+			<< std::setw(12) << mib(totals.live_bytes) << std::setw(12) << mib(totals.peak_bytes) << std::endl;
+		buffer << "Buffers freed: " << totals.deallocations << std::endl;
+	}
+
+	out << buffer.str() << std::flush;
+}
+
+void cg::image_allocations::allocated(const void* buffer, const std::size_t bytes)
+{
+	auto& all = counters();
+	std::lock_guard<std::mutex> lock(all.mutex);
+
+	auto& site = all.sites[(current_site != nullptr) ? current_site : unattributed_site];
+	++site.allocations;
+	site.allocated_bytes += bytes;
+	site.live_bytes += bytes;
+	site.peak_bytes = std::max(site.peak_bytes, site.live_bytes);
+
+	++all.totals.allocations;
+	all.totals.allocated_bytes += bytes;
+	all.totals.live_bytes += bytes;
+	all.totals.peak_bytes = std::max(all.totals.peak_bytes, all.totals.live_bytes);
+
+	all.buffers[buffer] = live_buffer{ bytes, &site };
+	++live_buffers;
+}
+
+void cg::image_allocations::deallocated(const void* buffer)
+{
+	auto& all = counters();
+	std::lock_guard<std::mutex> lock(all.mutex);
+
+	const auto found = all.buffers.find(buffer);
+
+	if (found == all.buffers.end())
+	{
+		return;
+	}
+
+	found->second.site->live_bytes -= found->second.bytes;
+
+	++all.totals.deallocations;
+	all.totals.live_bytes -= found->second.bytes;
+
+	all.buffers.erase(found);
+	--live_buffers;
+}
+
+cg::allocation_site::allocation_site(const char* name) : active(current_site == nullptr)
+{
+	if (this->active)
+	{
+		current_site = name;
+	}
+}
+
+cg::allocation_site::~allocation_site()
+{
+	if (this->active)
+	{
+		current_site = nullptr;
+	}
+}
+
+const char* cg::allocation_site::current()
+{
+	return current_site;
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "ReportFormat.hpp"
+#include "Trace.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cg
+{
+	/// <summary>
+	/// Optional accounting of the pixel buffers of all images
+	/// Images allocate their pixels through image_allocator, which reports to this class while accounting
+	/// is enabled. Allocations are attributed to the outermost allocation_site of the allocating thread
+	/// (usually the public loader, converter or manipulation called by the application); allocations
+	/// outside any site are reported as "unattributed". While disabled, an allocation costs one atomic load.
+	/// </summary>
+	class image_allocations
+	{
+	public:
+		/// <summary>
+		/// Totals over all pixel buffers
+		/// </summary>
+		struct statistics
+		{
+			/// Number of buffers allocated and freed
+			std::uint64_t allocations;
+			std::uint64_t deallocations;
+
+			/// Bytes of all buffers allocated
+			std::uint64_t allocated_bytes;
+
+			/// Bytes of the buffers currently alive and their maximum (high-water mark)
+			std::uint64_t live_bytes;
+			std::uint64_t peak_bytes;
+		};
+
+		/// <summary>
+		/// Totals of the buffers allocated by one call site
+		/// </summary>
+		struct site_statistics
+		{
+			/// Name of the call site
+			std::string site;
+
+			/// Number of buffers and their bytes
+			std::uint64_t allocations;
+			std::uint64_t allocated_bytes;
+
+			/// Bytes of the buffers of this site currently alive and their maximum
+			std::uint64_t live_bytes;
+			std::uint64_t peak_bytes;
+		};
+
+		/// <summary>
+		/// Enable or disable accounting
+		/// Buffers allocated while disabled are never counted, not even when they are freed.
+		/// </summary>
+		/// <param name="state">Account allocations</param>
+		static void enable(bool state = true);
+
+		/// <summary>
+		/// Check whether accounting is enabled
+		/// </summary>
+		/// <returns>True if enabled</returns>
+		static bool is_enabled();
+
+		/// <summary>
+		/// Reset all counters; buffers alive stay counted as live
+		/// </summary>
+		static void reset();
+
+		/// <summary>
+		/// Get the totals
+		/// </summary>
+		/// <returns>Statistics</returns>
+		static statistics get_statistics();
+
+		/// <summary>
+		/// Get the totals per call site
+		/// </summary>
+		/// <returns>Statistics, sorted by allocated bytes in descending order</returns>
+		static std::vector<site_statistics> get_sites();
+
+		/// <summary>
+		/// Write the totals and the per-site breakdown
+		/// JSON reports have one object per site and a final one for the totals.
+		/// </summary>
+		/// <param name="out">Stream (e.g. std::cerr)</param>
+		/// <param name="format">Output format</param>
+		static void report(std::ostream& out, report_format_t format);
+
+	private:
+		template <typename value_t>
+		friend class image_allocator;
+
+		/// <summary>
+		/// Count an allocated buffer
+		/// </summary>
+		/// <param name="buffer">Buffer</param>
+		/// <param name="bytes">Size in bytes</param>
+		static void allocated(const void* buffer, std::size_t bytes);
+
+		/// <summary>
+		/// Count a freed buffer (ignored if it was not counted)
+		/// </summary>
+		/// <param name="buffer">Buffer</param>
+		static void deallocated(const void* buffer);
+
+		/// <summary>
+		/// Check whether any counted buffer is alive
+		/// </summary>
+		/// <returns>True if buffers allocated while enabled were not freed yet</returns>
+		static bool has_live_buffers();
+
+		/// Accounting switch
+		static std::atomic<bool> enabled;
+
+		/// Number of counted buffers alive
+		static std::atomic<std::size_t> live_buffers;
+	};
+
+	/// <summary>
+	/// Names the allocations of the calling thread while it exists, unless an outer site is active
+	/// </summary>
+	class allocation_site
+	{
+	public:
+		/// <summary>
+		/// Constructor
+		/// </summary>
+		/// <param name="name">Name of the site; must be a string literal (only the pointer is kept)</param>
+		explicit allocation_site(const char* name);
+
+		/// <summary>
+		/// Destructor, restores the previous site
+		/// </summary>
+		~allocation_site();
+
+		allocation_site(const allocation_site&) = delete;
+		allocation_site& operator=(const allocation_site&) = delete;
+
+		/// <summary>
+		/// Get the active site of the calling thread
+		/// </summary>
+		/// <returns>Name (nullptr outside any site)</returns>
+		static const char* current();
+
+	private:
+		/// Site was activated by this object
+		bool active;
+	};
+
+	/// <summary>
+	/// Allocator of the pixel buffers, reporting to image_allocations
+	/// </summary>
+	/// <tparam name="value_t">Element type</tparam>
+	template <typename value_t>
+	class image_allocator
+	{
+	public:
+		using value_type = value_t;
+
+		image_allocator() = default;
+
+		template <typename other_t>
+		image_allocator(const image_allocator<other_t>&)
+		{
+		}
+
+		/// <summary>
+		/// Allocate uninitialized storage
+		/// </summary>
+		/// <param name="count">Number of elements</param>
+		/// <returns>Storage</returns>
+		value_t* allocate(std::size_t count);
+
+		/// <summary>
+		/// Free storage
+		/// </summary>
+		/// <param name="storage">Storage</param>
+		/// <param name="count">Number of elements</param>
+		void deallocate(value_t* storage, std::size_t count);
+	};
+
+	template <typename first_t, typename second_t>
+	inline bool operator==(const image_allocator<first_t>&, const image_allocator<second_t>&)
+	{
+		return true;
+	}
+
+	template <typename first_t, typename second_t>
+	inline bool operator!=(const image_allocator<first_t>&, const image_allocator<second_t>&)
+	{
+		return false;
+	}
+}
+
+inline bool cg::image_allocations::is_enabled()
+{
+	return enabled.load(std::memory_order_relaxed);
+}
+
+inline bool cg::image_allocations::has_live_buffers()
+{
+	return live_buffers.load(std::memory_order_relaxed) != 0;
+}
+
+template <typename value_t>
+inline value_t* cg::image_allocator<value_t>::allocate(const std::size_t count)
+{
+	value_t* storage = std::allocator<value_t>().allocate(count);
+
+	if (image_allocations::is_enabled())
+	{
+		image_allocations::allocated(storage, count * sizeof(value_t));
+	}
+
+	return storage;
+}
+
+template <typename value_t>
+inline void cg::image_allocator<value_t>::deallocate(value_t* storage, const std::size_t count)
+{
+	if (image_allocations::has_live_buffers())
+	{
+		image_allocations::deallocated(storage);
+	}
+
+	std::allocator<value_t>().deallocate(storage, count);
+}
+
+/// Names the image allocations and the trace span of a library operation
+#define CG_ALLOCATION_SITE_CONCAT_IMPL(first, second) first##second
+#define CG_ALLOCATION_SITE_CONCAT(first, second) CG_ALLOCATION_SITE_CONCAT_IMPL(first, second)
+#define CG_IMAGE_OPERATION(name) CG_TRACE_SCOPE(name); const ::cg::allocation_site CG_ALLOCATION_SITE_CONCAT(cg_allocation_site_, __LINE__)(name)
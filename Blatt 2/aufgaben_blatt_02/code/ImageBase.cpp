@@ -1,15 +1,15 @@
 #include "ImageBase.hpp"
 
-cg::image_base::image_base(const unsigned int width, const unsigned int height) : width(width), height(height)
+cg::image_base::image_base(const std::size_t width, const std::size_t height) : width(width), height(height)
 {
 }
 
-unsigned int cg::image_base::get_width() const
+std::size_t cg::image_base::get_width() const
 {
 	return this->width;
 }
 
-unsigned int cg::image_base::get_height() const
+std::size_t cg::image_base::get_height() const
 {
 	return this->height;
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "ImageTraits.hpp"
 
+#include <cstddef>
+
 namespace cg
 {
 	/// <summary>
@@ -15,14 +17,14 @@ namespace cg
 		/// </summary>
 		/// <param name="width">Image width</param>
 		/// <param name="height">Image height</param>
-		image_base(unsigned int width, unsigned int height);
+		image_base(std::size_t width, std::size_t height);
 
 		/// <summary>
 		/// Get width or height
 		/// </summary>
 		/// <returns>Width / height</returns>
-		unsigned int get_width() const;
-		unsigned int get_height() const;
+		std::size_t get_width() const;
+		std::size_t get_height() const;
 
 		/// <summary>
 		/// Initialize image to zero-values
@@ -31,7 +33,7 @@ namespace cg
 
 	protected:
 		/// Width and height
-		const unsigned int width;
-		const unsigned int height;
+		const std::size_t width;
+		const std::size_t height;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,364 @@
+#include "ImageComponents.hpp"
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace cg
+{
+	namespace
+	{
+		/// Minimum number of rows of a band
+		constexpr std::size_t min_band_rows = 32;
+
+		/// <summary>
+		/// Running statistics of a (partial) component
+		/// </summary>
+		struct component_sums
+		{
+			std::uint64_t area = 0;
+			std::size_t min_x = std::numeric_limits<std::size_t>::max();
+			std::size_t min_y = std::numeric_limits<std::size_t>::max();
+			std::size_t max_x = 0;
+			std::size_t max_y = 0;
+			std::uint64_t sum_x = 0;
+			std::uint64_t sum_y = 0;
+
+			/// <summary>
+			/// Add a pixel
+			/// </summary>
+			/// <param name="x">Column</param>
+			/// <param name="y">Row</param>
+			void add(const std::size_t x, const std::size_t y)
+			{
+				++this->area;
+				this->min_x = std::min(this->min_x, x);
+				this->min_y = std::min(this->min_y, y);
+				this->max_x = std::max(this->max_x, x);
+				this->max_y = std::max(this->max_y, y);
+				this->sum_x += x;
+				this->sum_y += y;
+			}
+
+			/// <summary>
+			/// Add the pixels of another part
+			/// </summary>
+			/// <param name="other">Other part</param>
+			void add(const component_sums& other)
+			{
+				this->area += other.area;
+				this->min_x = std::min(this->min_x, other.min_x);
+				this->min_y = std::min(this->min_y, other.min_y);
+				this->max_x = std::max(this->max_x, other.max_x);
+				this->max_y = std::max(this->max_y, other.max_y);
+				this->sum_x += other.sum_x;
+				this->sum_y += other.sum_y;
+			}
+		};
+
+		/// <summary>
+		/// Labeling state of a band of rows
+		/// </summary>
+		struct band
+		{
+			/// Rows [first_row, last_row)
+			std::size_t first_row;
+			std::size_t last_row;
+
+			/// Band-local component index of each provisional label (index 0 is background)
+			std::vector<std::uint32_t> compact;
+
+			/// Statistics per band-local component
+			std::vector<component_sums> sums;
+
+			/// Index of the first band-local component among all bands
+			std::size_t offset;
+		};
+
+		/// <summary>
+		/// Find the representative of a label, halving the path on the way
+		/// </summary>
+		/// <param name="parent">Parent of each label</param>
+		/// <param name="label">Label</param>
+		/// <returns>Representative (smallest label of the set)</returns>
+		inline std::uint32_t find(std::vector<std::uint32_t>& parent, std::uint32_t label)
+		{
+			while (parent[label] != label)
+			{
+				parent[label] = parent[parent[label]];
+				label = parent[label];
+			}
+
+			return label;
+		}
+
+		/// <summary>
+		/// Merge the sets of two labels; the smaller representative survives
+		/// </summary>
+		/// <param name="parent">Parent of each label</param>
+		/// <param name="first">First label</param>
+		/// <param name="second">Second label</param>
+		/// <returns>Representative of the merged set</returns>
+		inline std::uint32_t unite(std::vector<std::uint32_t>& parent, std::uint32_t first, std::uint32_t second)
+		{
+			first = find(parent, first);
+			second = find(parent, second);
+
+			if (first < second)
+			{
+				parent[second] = first;
+
+				return first;
+			}
+
+			parent[first] = second;
+
+			return second;
+		}
+
+		/// <summary>
+		/// Number the sets of a union-find structure consecutively
+		/// Since the smallest label represents each set, sets are numbered in the order of their first label.
+		/// </summary>
+		/// <param name="parent">Parent of each label</param>
+		/// <param name="first">First label to number</param>
+		/// <param name="numbers">Number of each label's set</param>
+		/// <returns>Number of sets</returns>
+		std::size_t number_sets(std::vector<std::uint32_t>& parent, const std::size_t first, std::vector<std::uint32_t>& numbers)
+		{
+			numbers.assign(parent.size(), 0);
+			std::uint32_t count = 0;
+
+			for (std::size_t label = first; label < parent.size(); ++label)
+			{
+				const auto root = find(parent, static_cast<std::uint32_t>(label));
+				numbers[label] = (root == label) ? count++ : numbers[root];
+			}
+
+			return count;
+		}
+
+		/// <summary>
+		/// Label the rows of one band independently of the other bands
+		/// </summary>
+		/// <param name="data">Pixel data</param>
+		/// <param name="width">Image width</param>
+		/// <param name="labels">Label per pixel; provisional band-local labels are written</param>
+		/// <param name="eight">Use 8-connectivity</param>
+		/// <param name="white">Components are white (otherwise black)</param>
+		/// <param name="current">Band</param>
+		void label_band(const float* data, const std::size_t width, std::uint32_t* labels, const bool eight, const bool white, band& current)
+		{
+			std::vector<std::uint32_t> parent(1, 0);
+			std::vector<component_sums> sums(1);
+
+			for (std::size_t y = current.first_row; y < current.last_row; ++y)
+			{
+				const float* row = data + y * width;
+				std::uint32_t* out = labels + y * width;
+				const std::uint32_t* up = (y > current.first_row) ? out - width : nullptr;
+
+				for (std::size_t x = 0; x < width; ++x)
+				{
+					if ((row[x] >= 0.5f) != white)
+					{
+						out[x] = 0;
+
+						continue;
+					}
+
+					const std::uint32_t left = (x > 0) ? out[x - 1] : 0;
+					const std::uint32_t above = up ? up[x] : 0;
+					std::uint32_t label = 0;
+
+					if (eight)
+					{
+						// The pixel above is connected to all other visited neighbors already
+						if (above != 0)
+						{
+							label = above;
+						}
+						else
+						{
+							const std::uint32_t above_left = (up && x > 0) ? up[x - 1] : 0;
+							const std::uint32_t above_right = (up && x + 1 < width) ? up[x + 1] : 0;
+							const std::uint32_t near = (left != 0) ? left : above_left;
+
+							if (near != 0 && above_right != 0)
+							{
+								label = unite(parent, near, above_right);
+							}
+							else
+							{
+								label = (near != 0) ? near : above_right;
+							}
+						}
+					}
+					else
+					{
+						if (left != 0 && above != 0)
+						{
+							label = (left == above) ? left : unite(parent, left, above);
+						}
+						else
+						{
+							label = (left != 0) ? left : above;
+						}
+					}
+
+					if (label == 0)
+					{
+						label = static_cast<std::uint32_t>(parent.size());
+						parent.push_back(label);
+						sums.emplace_back();
+					}
+
+					out[x] = label;
+					sums[label].add(x, y);
+				}
+			}
+
+			// Resolve the equivalences and gather the statistics per component
+			current.sums.assign(number_sets(parent, 1, current.compact), component_sums());
+
+			for (std::size_t label = 1; label < parent.size(); ++label)
+			{
+				current.sums[current.compact[label]].add(sums[label]);
+			}
+		}
+	}
+}
+
+cg::component_labels cg::image_components::label(const image<color_space_t::BW>& original, const connectivity_t connectivity, const float foreground)
+{
+	const std::size_t width = original.get_width();
+	const std::size_t height = original.get_height();
+	const bool eight = (connectivity == connectivity_t::eight);
+	const bool white = (foreground >= 0.5f);
+
+	if (width * height >= std::numeric_limits<std::uint32_t>::max())
+	{
+		throw std::runtime_error("Image too large for labeling");
+	}
+
+	component_labels result;
+	result.width = width;
+	result.height = height;
+	result.labels.resize(width * height);
+
+	if (width == 0 || height == 0)
+	{
+		return result;
+	}
+
+	const auto* data = original.get_values();
+	auto* labels = result.labels.data();
+
+	// Split into bands, a few per thread
+	auto& pool = thread_pool::shared();
+	const std::size_t band_count = std::max<std::size_t>(1, std::min((height + min_band_rows - 1) / min_band_rows, 4 * pool.get_thread_count()));
+	const std::size_t band_rows = (height + band_count - 1) / band_count;
+
+	std::vector<band> bands((height + band_rows - 1) / band_rows);
+
+	for (std::size_t index = 0; index < bands.size(); ++index)
+	{
+		bands[index].first_row = index * band_rows;
+		bands[index].last_row = std::min(bands[index].first_row + band_rows, height);
+	}
+
+	pool.run(bands.size(), [&](const std::size_t index)
+	{
+		label_band(data, width, labels, eight, white, bands[index]);
+	});
+
+	// Number all band-local components globally
+	std::size_t total = 0;
+
+	for (auto& current : bands)
+	{
+		current.offset = total;
+		total += current.sums.size();
+	}
+
+	std::vector<std::uint32_t> parent(total);
+
+	for (std::size_t index = 0; index < total; ++index)
+	{
+		parent[index] = static_cast<std::uint32_t>(index);
+	}
+
+	const auto global = [&](const band& current, const std::uint32_t label)
+	{
+		return static_cast<std::uint32_t>(current.offset + current.compact[label]);
+	};
+
+	// Merge components touching across band borders
+	for (std::size_t index = 1; index < bands.size(); ++index)
+	{
+		const band& lower = bands[index];
+		const band& upper = bands[index - 1];
+
+		const std::uint32_t* row = labels + lower.first_row * width;
+		const std::uint32_t* above = row - width;
+
+		for (std::size_t x = 0; x < width; ++x)
+		{
+			if (row[x] == 0)
+			{
+				continue;
+			}
+
+			const auto label = global(lower, row[x]);
+			const std::size_t first = (eight && x > 0) ? x - 1 : x;
+			const std::size_t last = (eight && x + 1 < width) ? x + 1 : x;
+
+			for (std::size_t neighbor = first; neighbor <= last; ++neighbor)
+			{
+				if (above[neighbor] != 0)
+				{
+					unite(parent, label, global(upper, above[neighbor]));
+				}
+			}
+		}
+	}
+
+	std::vector<std::uint32_t> numbers;
+	std::vector<component_sums> sums(number_sets(parent, 0, numbers));
+
+	for (const auto& current : bands)
+	{
+		for (std::size_t local = 0; local < current.sums.size(); ++local)
+		{
+			sums[numbers[current.offset + local]].add(current.sums[local]);
+		}
+	}
+
+	// Write the final labels
+	pool.run(bands.size(), [&](const std::size_t index)
+	{
+		const band& current = bands[index];
+
+		for (std::size_t position = current.first_row * width; position < current.last_row * width; ++position)
+		{
+			if (labels[position] != 0)
+			{
+				labels[position] = numbers[global(current, labels[position])] + 1;
+			}
+		}
+	});
+
+	result.components.reserve(sums.size());
+
+	for (const auto& component : sums)
+	{
+		const auto area = static_cast<double>(component.area);
+
+		result.components.push_back({ static_cast<std::size_t>(component.area), component.min_x, component.min_y, component.max_x, component.max_y,
+			static_cast<double>(component.sum_x) / area, static_cast<double>(component.sum_y) / area });
+	}
+
+	return result;
+}
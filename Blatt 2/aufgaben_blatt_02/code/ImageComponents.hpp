@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Image.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cg
+{
+	/// <summary>
+	/// Neighborhood of a pixel used for connecting pixels to components
+	/// </summary>
+	enum class connectivity_t
+	{
+		/// Horizontal and vertical neighbors
+		four,
+
+		/// Horizontal, vertical and diagonal neighbors
+		eight
+	};
+
+	/// <summary>
+	/// Statistics of a connected component
+	/// </summary>
+	struct connected_component
+	{
+		/// Number of pixels
+		std::size_t area;
+
+		/// Bounding box (inclusive)
+		std::size_t min_x, min_y;
+		std::size_t max_x, max_y;
+
+		/// Mean pixel position
+		double centroid_x, centroid_y;
+	};
+
+	/// <summary>
+	/// Result of connected-component labeling
+	/// </summary>
+	struct component_labels
+	{
+		/// Width and height of the labeled image
+		std::size_t width, height;
+
+		/// Label per pixel in row-major order; 0 for background, i + 1 for component i
+		std::vector<std::uint32_t> labels;
+
+		/// Components, ordered by their first pixel in row-major order
+		std::vector<connected_component> components;
+	};
+
+	/// <summary>
+	/// Class for finding connected components in black-and-white images
+	/// The image is split into bands of rows that are labeled in parallel with a union-find
+	/// two-pass algorithm, gathering the component statistics on the way. Components touching
+	/// across band borders are merged afterwards, and the final labels are written in parallel.
+	/// </summary>
+	class image_components
+	{
+	public:
+		/// <summary>
+		/// Label the connected components of a black-and-white image
+		/// </summary>
+		/// <param name="original">Black-and-white image</param>
+		/// <param name="connectivity">Pixel neighborhood</param>
+		/// <param name="foreground">Value of the pixels forming components (1 for white, 0 for black)</param>
+		/// <returns>Labels and statistics</returns>
+		static component_labels label(const image<color_space_t::BW>& original, connectivity_t connectivity = connectivity_t::eight, float foreground = 1.f);
+	};
+}
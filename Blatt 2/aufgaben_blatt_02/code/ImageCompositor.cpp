@@ -0,0 +1,179 @@
+#include "ImageCompositor.hpp"
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define CG_COMPOSITOR_SSE
+#endif
+
+namespace cg
+{
+	namespace
+	{
+		/// Minimum number of rows composited by one task
+		constexpr std::size_t row_grain = 16;
+
+		/// Minimum number of pixels converted by one task
+		constexpr std::size_t pixel_grain = 65536;
+
+		/// <summary>
+		/// Check whether a premultiplied RGBA pixel leaves everything below it unchanged
+		/// </summary>
+		/// <param name="pixel">Pixel</param>
+		/// <returns>True if all channels are zero</returns>
+		inline bool transparent(const float* pixel)
+		{
+			return pixel[3] == 0.f && pixel[0] == 0.f && pixel[1] == 0.f && pixel[2] == 0.f;
+		}
+
+		/// <summary>
+		/// Composite a premultiplied RGBA pixel over an RGB pixel
+		/// </summary>
+		/// <param name="source">Source pixel</param>
+		/// <param name="destination">Destination pixel</param>
+		inline void over_rgb(const float* source, float* destination)
+		{
+			const float remaining = 1.f - source[3];
+
+			destination[0] = source[0] + destination[0] * remaining;
+			destination[1] = source[1] + destination[1] * remaining;
+			destination[2] = source[2] + destination[2] * remaining;
+		}
+
+		/// <summary>
+		/// Composite a premultiplied RGBA pixel over another one
+		/// </summary>
+		/// <param name="source">Source pixel</param>
+		/// <param name="destination">Destination pixel</param>
+		inline void over_rgba(const float* source, float* destination)
+		{
+#ifdef CG_COMPOSITOR_SSE
+			const __m128 color = _mm_loadu_ps(source);
+			const __m128 remaining = _mm_sub_ps(_mm_set1_ps(1.f), _mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3)));
+
+			_mm_storeu_ps(destination, _mm_add_ps(color, _mm_mul_ps(_mm_loadu_ps(destination), remaining)));
+#else
+			over_rgb(source, destination);
+			destination[3] = source[3] + destination[3] * (1.f - source[3]);
+#endif
+		}
+	}
+}
+
+cg::image<cg::color_space_t::RGBA> cg::image_compositor::rgb_to_rgba(const image<color_space_t::RGB>& original, const float alpha)
+{
+	image<color_space_t::RGBA> converted(original.get_width(), original.get_height());
+
+	const auto& in = original.get_data();
+	auto& out = converted.get_data();
+
+	thread_pool::shared().parallel_for(0, in.size(), pixel_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		for (std::size_t index = first; index < last; ++index)
+		{
+			out[index] = {{ in[index][0] * alpha, in[index][1] * alpha, in[index][2] * alpha, alpha }};
+		}
+	});
+
+	return converted;
+}
+
+cg::image<cg::color_space_t::RGB> cg::image_compositor::rgba_to_rgb(const image<color_space_t::RGBA>& original, const std::array<float, 3>& background)
+{
+	image<color_space_t::RGB> converted(original.get_width(), original.get_height());
+	converted.initialize(background);
+
+	over(original, converted);
+
+	return converted;
+}
+
+void cg::image_compositor::over(const image<color_space_t::RGBA>& source, image<color_space_t::RGBA>& destination, const std::ptrdiff_t x, const std::ptrdiff_t y)
+{
+	static_assert(sizeof(image<color_space_t::RGBA>::tuple_type) == 4 * sizeof(float), "Pixels must be stored as tightly packed floats");
+
+	const auto area = clip(source, destination, x, y);
+
+	const auto* in = source.get_values();
+	auto* out = destination.get_values();
+
+	over(in + 4 * (area.source_y * source.get_width() + area.source_x), 4 * source.get_width(),
+		out + 4 * (area.destination_y * destination.get_width() + area.destination_x), 4 * destination.get_width(), 4, area.width, area.height);
+}
+
+void cg::image_compositor::over(const image<color_space_t::RGBA>& source, image<color_space_t::RGB>& destination, const std::ptrdiff_t x, const std::ptrdiff_t y)
+{
+	static_assert(sizeof(image<color_space_t::RGB>::tuple_type) == 3 * sizeof(float), "Pixels must be stored as tightly packed floats");
+
+	const auto area = clip(source, destination, x, y);
+
+	const auto* in = source.get_values();
+	auto* out = destination.get_values();
+
+	over(in + 4 * (area.source_y * source.get_width() + area.source_x), 4 * source.get_width(),
+		out + 3 * (area.destination_y * destination.get_width() + area.destination_x), 3 * destination.get_width(), 3, area.width, area.height);
+}
+
+cg::image_compositor::overlap cg::image_compositor::clip(const image_base& source, const image_base& destination, const std::ptrdiff_t x, const std::ptrdiff_t y)
+{
+	const auto clip_axis = [](const std::ptrdiff_t position, const std::size_t source_size, const std::size_t destination_size,
+		std::size_t& source_first, std::size_t& destination_first, std::size_t& size)
+	{
+		const auto first = std::max<std::ptrdiff_t>(position, 0);
+		const auto last = std::min<std::ptrdiff_t>(position + static_cast<std::ptrdiff_t>(source_size), static_cast<std::ptrdiff_t>(destination_size));
+
+		source_first = static_cast<std::size_t>(first - position);
+		destination_first = static_cast<std::size_t>(first);
+		size = (last > first) ? static_cast<std::size_t>(last - first) : 0;
+	};
+
+	overlap area;
+
+	clip_axis(x, source.get_width(), destination.get_width(), area.source_x, area.destination_x, area.width);
+	clip_axis(y, source.get_height(), destination.get_height(), area.source_y, area.destination_y, area.height);
+
+	if (area.width == 0 || area.height == 0)
+	{
+		area = overlap{ 0, 0, 0, 0, 0, 0 };
+	}
+
+	return area;
+}
+
+void cg::image_compositor::over(const float* source, const std::size_t source_stride, float* destination, const std::size_t destination_stride,
+	const std::size_t destination_channels, const std::size_t width, const std::size_t height)
+{
+	thread_pool::shared().parallel_for(0, height, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		for (std::size_t j = first; j < last; ++j)
+		{
+			const float* in = source + j * source_stride;
+			float* out = destination + j * destination_stride;
+
+			// Fully transparent pixels leave the destination unchanged; watermarks consist mostly of them
+			if (destination_channels == 4)
+			{
+				for (std::size_t i = 0; i < width; ++i, in += 4, out += 4)
+				{
+					if (!transparent(in))
+					{
+						over_rgba(in, out);
+					}
+				}
+			}
+			else
+			{
+				for (std::size_t i = 0; i < width; ++i, in += 4, out += 3)
+				{
+					if (!transparent(in))
+					{
+						over_rgb(in, out);
+					}
+				}
+			}
+		}
+	});
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Image.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace cg
+{
+	/// <summary>
+	/// Class for alpha compositing
+	/// RGBA images hold premultiplied color, so "over" is result = source + destination * (1 - source alpha)
+	/// for every channel. A source pixel is processed as one 4-wide SSE vector. Sources can be placed at
+	/// any offset; only the overlapping rectangle is touched, in place, and its rows are distributed over
+	/// the shared thread pool.
+	/// </summary>
+	class image_compositor
+	{
+	public:
+		/// <summary>
+		/// Convert an RGB image to RGBA
+		/// </summary>
+		/// <param name="original">RGB image</param>
+		/// <param name="alpha">Alpha of all pixels</param>
+		/// <returns>RGBA image</returns>
+		static image<color_space_t::RGBA> rgb_to_rgba(const image<color_space_t::RGB>& original, float alpha = 1.f);
+
+		/// <summary>
+		/// Convert an RGBA image to RGB by compositing it over an opaque background
+		/// </summary>
+		/// <param name="original">RGBA image</param>
+		/// <param name="background">Background color</param>
+		/// <returns>RGB image</returns>
+		static image<color_space_t::RGB> rgba_to_rgb(const image<color_space_t::RGBA>& original, const std::array<float, 3>& background = {{ 0.f, 0.f, 0.f }});
+
+		/// <summary>
+		/// Composite an image over another one in place
+		/// </summary>
+		/// <param name="source">Source image (e.g. a watermark)</param>
+		/// <param name="destination">Destination image</param>
+		/// <param name="x">Column of the destination where the left source column is placed (may be negative)</param>
+		/// <param name="y">Row of the destination where the top source row is placed (may be negative)</param>
+		static void over(const image<color_space_t::RGBA>& source, image<color_space_t::RGBA>& destination, std::ptrdiff_t x = 0, std::ptrdiff_t y = 0);
+
+		/// <summary>
+		/// Composite an image over an opaque RGB image in place
+		/// </summary>
+		/// <param name="source">Source image (e.g. a watermark)</param>
+		/// <param name="destination">Destination image</param>
+		/// <param name="x">Column of the destination where the left source column is placed (may be negative)</param>
+		/// <param name="y">Row of the destination where the top source row is placed (may be negative)</param>
+		static void over(const image<color_space_t::RGBA>& source, image<color_space_t::RGB>& destination, std::ptrdiff_t x = 0, std::ptrdiff_t y = 0);
+
+	private:
+		/// <summary>
+		/// Overlapping rectangle of a placed source and a destination
+		/// </summary>
+		struct overlap
+		{
+			/// First source column and row
+			std::size_t source_x, source_y;
+
+			/// First destination column and row
+			std::size_t destination_x, destination_y;
+
+			/// Size of the rectangle
+			std::size_t width, height;
+		};
+
+		/// <summary>
+		/// Clip a placed source against a destination
+		/// </summary>
+		/// <param name="source">Source image</param>
+		/// <param name="destination">Destination image</param>
+		/// <param name="x">Column of the left source column in the destination</param>
+		/// <param name="y">Row of the top source row in the destination</param>
+		/// <returns>Overlapping rectangle (empty if they do not overlap)</returns>
+		static overlap clip(const image_base& source, const image_base& destination, std::ptrdiff_t x, std::ptrdiff_t y);
+
+		/// <summary>
+		/// Composite rows of premultiplied RGBA pixels over rows of a destination
+		/// </summary>
+		/// <param name="source">First source pixel</param>
+		/// <param name="source_stride">Number of floats per source row</param>
+		/// <param name="destination">First destination pixel</param>
+		/// <param name="destination_stride">Number of floats per destination row</param>
+		/// <param name="destination_channels">Number of destination channels (3 or 4)</param>
+		/// <param name="width">Number of pixels per row</param>
+		/// <param name="height">Number of rows</param>
+		static void over(const float* source, std::size_t source_stride, float* destination, std::size_t destination_stride,
+			std::size_t destination_channels, std::size_t width, std::size_t height);
+	};
+}
@@ -1,180 +1,391 @@
 #include "ImageConverter.hpp"
 
+#include "ImageAllocations.hpp"
+#include "ImageHistogram.hpp"
+#include "ImageManipulation.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace cg
+{
+    namespace
+    {
+        /// Minimum number of rows dithered by one task
+        constexpr std::size_t dither_grain = 16;
+
+        /// Number of pixels after which a row of the error diffusion wavefront publishes its progress
+        constexpr std::size_t fs_block_size = 256;
+    }
+}
 
 cg::image<cg::color_space_t::HSV> cg::image_converter::rgb_to_hsv(const image<color_space_t::RGB>& original)
 {
+    CG_IMAGE_OPERATION("image_converter::rgb_to_hsv");
+
     // Convert RGB to HSV
-    cg::image<cg::color_space_t::HSV> converted(original.get_width(), original.get_height());
+    return image_manipulation::map_to<color_space_t::HSV>(original, [](const image<color_space_t::RGB>::tuple_type& pixel)
+    {
+        return rgb_to_hsv_pixel(pixel);
+    });
+}
+
+cg::image<cg::color_space_t::RGB> cg::image_converter::hsv_to_rgb(const image<color_space_t::HSV>& original)
+{
+    CG_IMAGE_OPERATION("image_converter::hsv_to_rgb");
 
-    for (unsigned int j = 0; j < original.get_height(); ++j)
+    // Convert HSV to RGB
+    return image_manipulation::map_to<color_space_t::RGB>(original, [](const image<color_space_t::HSV>::tuple_type& pixel)
     {
-        for (unsigned int i = 0; i < original.get_width(); ++i)
-        {
-            const float r = original(i, j)[0];
-            const float g = original(i, j)[1];
-            const float b = original(i, j)[2];
+        return hsv_to_rgb_pixel(pixel);
+    });
+}
 
-            const float c_max = std::max(std::max(r, g), b);
-            const float c_min = std::min(std::min(r, g), b);
-            const float delta = c_max - c_min;
+cg::image<cg::color_space_t::Gray> cg::image_converter::rgb_to_gray(const image<color_space_t::RGB>& original)
+{
+    CG_IMAGE_OPERATION("image_converter::rgb_to_gray");
 
-            float h = 0.f, s = 0.f, v = 0.f;
+    // Convert RGB to grayscale
+    return image_manipulation::map_to<color_space_t::Gray>(original, [](const image<color_space_t::RGB>::tuple_type& pixel)
+    {
+        return rgb_to_gray_pixel(pixel);
+    });
+}
 
-            ////////
-            // TODO:
-            // Implement the conversion from RGB to HSV as described in
-            // https://de.wikipedia.org/wiki/HSV-Farbraum#Umrechnung_RGB_in_HSV/HSL
+cg::image<cg::color_space_t::BW> cg::image_converter::gray_to_bw(const image<color_space_t::Gray>& original)
+{
+    CG_IMAGE_OPERATION("image_converter::gray_to_bw");
 
-            // ...
-            if (delta == 0) {
-                h = 0;
-            }
-            else if (c_max == r) {
-                h = 60.f * ((g - b) / delta);
-            }
-            else if (c_max == g) {
-                h = 60.f * (2 + (b - r) / delta);
-            }
-            else if (c_max == b) {
-                h = 60.f * (4 + (r - g) / delta);
-            }
-            if (h < 360) {
-                h += 360;
+    // Convert grayscale to black and white
+    return image_manipulation::map_to<color_space_t::BW>(original, [](const image<color_space_t::Gray>::tuple_type& pixel)
+    {
+        return gray_to_bw_pixel(pixel);
+    });
+}
+
+cg::image<cg::color_space_t::BW> cg::image_converter::gray_to_bw(const image<color_space_t::Gray>& original, const float threshold)
+{
+    CG_IMAGE_OPERATION("image_converter::gray_to_bw");
+
+    // Convert grayscale to black and white
+    return image_manipulation::map_to<color_space_t::BW>(original, [threshold](const image<color_space_t::Gray>::tuple_type& pixel)
+    {
+        return image<color_space_t::BW>::tuple_type{{ pixel[0] < threshold ? 0.f : 1.f }};
+    });
+}
+
+cg::image<cg::color_space_t::BW> cg::image_converter::gray_to_bw_adaptive(const image<color_space_t::Gray>& original)
+{
+    CG_IMAGE_OPERATION("image_converter::gray_to_bw_adaptive");
+
+    return gray_to_bw(original, image_histogram::otsu_threshold(original));
+}
+
+cg::image<cg::color_space_t::BW> cg::image_converter::gray_to_bw_ordered(const image<color_space_t::Gray>& original, const std::size_t matrix_size)
+{
+    CG_IMAGE_OPERATION("image_converter::gray_to_bw_ordered");
+
+    if (matrix_size != 2 && matrix_size != 4 && matrix_size != 8 && matrix_size != 16)
+    {
+        throw std::runtime_error("Bayer matrix size must be 2, 4, 8 or 16");
+    }
+
+    const std::size_t width = original.get_width();
+    const std::size_t height = original.get_height();
+
+    // Build the Bayer matrix recursively: M(2n) = [4 M(n), 4 M(n) + 2; 4 M(n) + 3, 4 M(n) + 1]
+    std::vector<std::size_t> matrix(1, 0);
+
+    for (std::size_t size = 1; size < matrix_size; size *= 2)
+    {
+        std::vector<std::size_t> larger(4 * size * size);
+
+        for (std::size_t j = 0; j < size; ++j)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                const std::size_t value = 4 * matrix[j * size + i];
+
+                larger[j * 2 * size + i] = value;
+                larger[j * 2 * size + i + size] = value + 2;
+                larger[(j + size) * 2 * size + i] = value + 3;
+                larger[(j + size) * 2 * size + i + size] = value + 1;
             }
-            h /= 360;
+        }
 
-            s = c_max == c_min ? 0 : (c_max - c_min) / c_max;
+        matrix.swap(larger);
+    }
 
-            v = c_max;
+    // Expand each matrix row to a full image row of thresholds, so that the comparison runs over contiguous data
+    std::vector<float> thresholds(matrix_size * width);
+    const float levels = static_cast<float>(matrix_size * matrix_size);
 
-            converted(i, j)[0] = h;
-            converted(i, j)[1] = s;
-            converted(i, j)[2] = v;
+    for (std::size_t j = 0; j < matrix_size; ++j)
+    {
+        for (std::size_t i = 0; i < width; ++i)
+        {
+            thresholds[j * width + i] = (static_cast<float>(matrix[j * matrix_size + i % matrix_size]) + 0.5f) / levels;
         }
     }
 
+    image<color_space_t::BW> converted(width, height);
+
+    const auto* in = original.get_values();
+    auto* out = converted.get_values();
+
+    thread_pool::shared().parallel_for(0, height, dither_grain, [&](const std::size_t first, const std::size_t last)
+    {
+        for (std::size_t j = first; j < last; ++j)
+        {
+            const float* row = in + j * width;
+            const float* threshold = thresholds.data() + (j % matrix_size) * width;
+            float* target = out + j * width;
+
+            for (std::size_t i = 0; i < width; ++i)
+            {
+                target[i] = (row[i] < threshold[i]) ? 0.f : 1.f;
+            }
+        }
+    });
+
     return converted;
 }
 
-cg::image<cg::color_space_t::RGB> cg::image_converter::hsv_to_rgb(const image<color_space_t::HSV>& original)
+cg::image<cg::color_space_t::BW> cg::image_converter::gray_to_bw_floyd_steinberg(const image<color_space_t::Gray>& original)
 {
-    // Convert HSV to RGB
-    image<color_space_t::RGB> converted(original.get_width(), original.get_height());
+    CG_IMAGE_OPERATION("image_converter::gray_to_bw_floyd_steinberg");
+
+    const std::size_t width = original.get_width();
+    const std::size_t height = original.get_height();
 
-    for (unsigned int j = 0; j < original.get_height(); ++j)
+    image<color_space_t::BW> converted(width, height);
+
+    if (width == 0 || height == 0)
     {
-        for (unsigned int i = 0; i < original.get_width(); ++i)
-        {
-            const float h = original(i, j)[0];
-            const float s = original(i, j)[1];
-            const float v = original(i, j)[2];
+        return converted;
+    }
+
+    const auto* in = original.get_values();
+    auto* out = converted.get_values();
 
-            float r = 0.f, g = 0.f, b = 0.f;
+    auto& pool = thread_pool::shared();
+    const std::size_t threads = pool.get_thread_count();
 
-            ////////
-            // TODO:
-            // Implement the conversion from HSV to RGB as described in
-            // https://de.wikipedia.org/wiki/HSV-Farbraum#Umrechnung_HSV_in_RGB
+    // Number of finished pixels per row
+    std::unique_ptr<std::atomic<std::size_t>[]> progress(new std::atomic<std::size_t>[height]);
+
+    for (std::size_t j = 0; j < height; ++j)
+    {
+        progress[j].store(0, std::memory_order_relaxed);
+    }
+
+    // Errors diffused into a row from the row above, in a ring of buffers padded by one pixel on both sides
+    const std::size_t ring_size = std::max<std::size_t>(4, 4 * threads + 2);
+    std::vector<float> errors(ring_size * (width + 2), 0.f);
+
+    const auto error_row = [&](const std::size_t j)
+    {
+        return errors.data() + (j % ring_size) * (width + 2) + 1;
+    };
+
+    const auto wait_for = [&](const std::size_t j, const std::size_t count)
+    {
+        while (progress[j].load(std::memory_order_acquire) < count)
+        {
+            std::this_thread::yield();
+        }
+    };
 
-            // ...
-            int h_i = std::floor(h * 6); // H = |_ h * 360 / 60 _|
-            float f = h * 6 - h_i;
-            float p = v * (1 - s);
-            float q = v * (1 - s * f);
-            float t = v * (1 - s * (1 - f));
+    // Rows are claimed in order, so the row above is always being processed by a running thread
+    std::atomic<std::size_t> next_row(0);
 
-            switch (h_i % 6)
+    pool.run(threads, [&](std::size_t)
+    {
+        for (std::size_t j = next_row++; j < height; j = next_row++)
+        {
+            // The buffer of the next row was last used by row j + 1 - ring_size, which must be finished
+            if (j + 1 < height)
             {
-            case 0:
-                r = v;
-                g = t;
-                b = p;
-                break;
-
-            case 1:
-                r = q;
-                g = v;
-                b = p;
-                break;
-
-            case 2:
-                r = p;
-                g = v;
-                b = t;
-                break;
-
-            case 3:
-                r = p;
-                g = q;
-                b = v;
-                break;
-
-            case 4:
-                r = t;
-                g = p;
-                b = v;
-                break;
-
-            case 5:
-                r = v;
-                g = p;
-                b = q;
-                break;
-
-            default:
-                break;
+                if (j + 1 >= ring_size)
+                {
+                    wait_for(j + 1 - ring_size, width);
+                }
+
+                std::fill(error_row(j + 1) - 1, error_row(j + 1) + width + 1, 0.f);
             }
 
-            converted(i, j)[0] = r;
-            converted(i, j)[1] = g;
-            converted(i, j)[2] = b;
+            const float* row = in + j * width;
+            const float* incoming = error_row(j);
+            float* below = error_row(j + 1);
+            float* target = out + j * width;
+
+            float carry = 0.f;
+
+            for (std::size_t block = 0; block < width; block += fs_block_size)
+            {
+                const std::size_t block_end = std::min(block + fs_block_size, width);
+
+                // Pixel i receives errors from pixels i - 1, i and i + 1 of the row above
+                if (j > 0)
+                {
+                    wait_for(j - 1, std::min(block_end + 1, width));
+                }
+
+                for (std::size_t i = block; i < block_end; ++i)
+                {
+                    const float value = row[i] + incoming[i] + carry;
+                    const float quantized = (value < 0.5f) ? 0.f : 1.f;
+                    const float error = value - quantized;
+
+                    target[i] = quantized;
+                    carry = error * (7.f / 16.f);
+
+                    if (j + 1 < height)
+                    {
+                        below[i - 1] += error * (3.f / 16.f);
+                        below[i] += error * (5.f / 16.f);
+                        below[i + 1] += error * (1.f / 16.f);
+                    }
+                }
+
+                progress[j].store(block_end, std::memory_order_release);
+            }
         }
-    }
+    });
 
     return converted;
 }
 
-cg::image<cg::color_space_t::Gray> cg::image_converter::rgb_to_gray(const image<color_space_t::RGB>& original)
+cg::image<cg::color_space_t::HSV>::tuple_type cg::image_converter::rgb_to_hsv_pixel(const image<color_space_t::RGB>::tuple_type& pixel)
 {
-    // Convert RGB to grayscale
-    image<color_space_t::Gray> converted(original.get_width(), original.get_height());
+    const float r = pixel[0];
+    const float g = pixel[1];
+    const float b = pixel[2];
+
+    const float c_max = std::max(std::max(r, g), b);
+    const float c_min = std::min(std::min(r, g), b);
+    const float delta = c_max - c_min;
+
+    float h = 0.f, s = 0.f, v = 0.f;
 
     ////////
     // TODO:
-    // Implement the conversion from RGB to grayscale using the luminance
-    // approximation formula presented in the lecture.
+    // Implement the conversion from RGB to HSV as described in
+    // https://de.wikipedia.org/wiki/HSV-Farbraum#Umrechnung_RGB_in_HSV/HSL
+
+    // ...
+    if (delta == 0) {
+        h = 0;
+    }
+    else if (c_max == r) {
+        h = 60.f * ((g - b) / delta);
+    }
+    else if (c_max == g) {
+        h = 60.f * (2 + (b - r) / delta);
+    }
+    else if (c_max == b) {
+        h = 60.f * (4 + (r - g) / delta);
+    }
+    if (h < 360) {
+        h += 360;
+    }
+    h /= 360;
+
+    s = c_max == c_min ? 0 : (c_max - c_min) / c_max;
 
-    for (unsigned int j = 0; j < original.get_height(); ++j)
+    v = c_max;
+
+    return {{ h, s, v }};
+}
+
+cg::image<cg::color_space_t::RGB>::tuple_type cg::image_converter::hsv_to_rgb_pixel(const image<color_space_t::HSV>::tuple_type& pixel)
+{
+    const float h = pixel[0];
+    const float s = pixel[1];
+    const float v = pixel[2];
+
+    float r = 0.f, g = 0.f, b = 0.f;
+
+    ////////
+    // TODO:
+    // Implement the conversion from HSV to RGB as described in
+    // https://de.wikipedia.org/wiki/HSV-Farbraum#Umrechnung_HSV_in_RGB
+
+    // ...
+    int h_i = std::floor(h * 6); // H = |_ h * 360 / 60 _|
+    float f = h * 6 - h_i;
+    float p = v * (1 - s);
+    float q = v * (1 - s * f);
+    float t = v * (1 - s * (1 - f));
+
+    switch (h_i % 6)
     {
-        for (unsigned int i = 0; i < original.get_width(); ++i)
-        {
-            converted(i, j)[0] = original(i, j)[0] * 0.299 + original(i, j)[1] * 0.587 + original(i, j)[2] * 0.114;
-        }
+    case 0:
+        r = v;
+        g = t;
+        b = p;
+        break;
+
+    case 1:
+        r = q;
+        g = v;
+        b = p;
+        break;
+
+    case 2:
+        r = p;
+        g = v;
+        b = t;
+        break;
+
+    case 3:
+        r = p;
+        g = q;
+        b = v;
+        break;
+
+    case 4:
+        r = t;
+        g = p;
+        b = v;
+        break;
+
+    case 5:
+        r = v;
+        g = p;
+        b = q;
+        break;
+
+    default:
+        break;
     }
 
-    return converted;
+    return {{ r, g, b }};
 }
 
-cg::image<cg::color_space_t::BW> cg::image_converter::gray_to_bw(const image<color_space_t::Gray>& original)
+cg::image<cg::color_space_t::Gray>::tuple_type cg::image_converter::rgb_to_gray_pixel(const image<color_space_t::RGB>::tuple_type& pixel)
 {
-    // Convert grayscale to black and white
-    image<color_space_t::BW> converted(original.get_width(), original.get_height());
+    ////////
+    // TODO:
+    // Implement the conversion from RGB to grayscale using the luminance
+    // approximation formula presented in the lecture.
+
+    return {{ static_cast<float>(pixel[0] * 0.299 + pixel[1] * 0.587 + pixel[2] * 0.114) }};
+}
 
+cg::image<cg::color_space_t::BW>::tuple_type cg::image_converter::gray_to_bw_pixel(const image<color_space_t::Gray>::tuple_type& pixel)
+{
     ////////
     // TODO:
     // Implement the conversion from grayscale to black and white such that
     // luminance values < 0.5 are mapped to black (0.0) and values >= 0.5
     // are mapped to white (1.0).
 
-    for (unsigned int j = 0; j < original.get_height(); ++j)
-    {
-        for (unsigned int i = 0; i < original.get_width(); ++i)
-        {
-            auto grayscale = original(i, j)[0] * 0.299 + original(i, j)[1] * 0.587 + original(i, j)[2] * 0.114;
-            converted(i, j)[0] = grayscale < 0.5 ? 0 : 1;
-        }
-    }
-
-    return converted;
+    return {{ pixel[0] < 0.5f ? 0.f : 1.f }};
 }
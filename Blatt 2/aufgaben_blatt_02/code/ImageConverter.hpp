@@ -2,6 +2,8 @@
 
 #include "Image.hpp"
 
+#include <cstddef>
+
 namespace cg
 {
 	/// <summary>
@@ -37,5 +39,69 @@ namespace cg
 		/// <param name="original">Original image</param>
 		/// <returns>Converted image</returns>
 		static image<color_space_t::BW> gray_to_bw(const image<color_space_t::Gray>& original);
+
+		/// <summary>
+		/// Convert image from grayscale to black and white using the given threshold
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="threshold">Values below are mapped to black, all others to white</param>
+		/// <returns>Converted image</returns>
+		static image<color_space_t::BW> gray_to_bw(const image<color_space_t::Gray>& original, float threshold);
+
+		/// <summary>
+		/// Convert image from grayscale to black and white using a threshold selected
+		/// from the image histogram (Otsu's method)
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <returns>Converted image</returns>
+		static image<color_space_t::BW> gray_to_bw_adaptive(const image<color_space_t::Gray>& original);
+
+		/// <summary>
+		/// Convert image from grayscale to black and white with ordered (Bayer) dithering
+		/// Each pixel is compared with a threshold from a tiled Bayer matrix; rows are processed in parallel.
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="matrix_size">Edge length of the Bayer matrix (2, 4, 8 or 16)</param>
+		/// <returns>Converted image</returns>
+		static image<color_space_t::BW> gray_to_bw_ordered(const image<color_space_t::Gray>& original, std::size_t matrix_size = 8);
+
+		/// <summary>
+		/// Convert image from grayscale to black and white with Floyd-Steinberg error diffusion
+		/// Rows are processed by several threads as a block wavefront: each row is split into blocks of
+		/// 256 pixels, and a block starts once the row above has finished the following block (it needs
+		/// one pixel beyond its own end), so every row trails the row above by one block. The result
+		/// equals serial error diffusion.
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <returns>Converted image</returns>
+		static image<color_space_t::BW> gray_to_bw_floyd_steinberg(const image<color_space_t::Gray>& original);
+
+		/// <summary>
+		/// Convert a single pixel from RGB to HSV
+		/// </summary>
+		/// <param name="pixel">Original pixel</param>
+		/// <returns>Converted pixel</returns>
+		static image<color_space_t::HSV>::tuple_type rgb_to_hsv_pixel(const image<color_space_t::RGB>::tuple_type& pixel);
+
+		/// <summary>
+		/// Convert a single pixel from HSV to RGB
+		/// </summary>
+		/// <param name="pixel">Original pixel</param>
+		/// <returns>Converted pixel</returns>
+		static image<color_space_t::RGB>::tuple_type hsv_to_rgb_pixel(const image<color_space_t::HSV>::tuple_type& pixel);
+
+		/// <summary>
+		/// Convert a single pixel from RGB to grayscale
+		/// </summary>
+		/// <param name="pixel">Original pixel</param>
+		/// <returns>Converted pixel</returns>
+		static image<color_space_t::Gray>::tuple_type rgb_to_gray_pixel(const image<color_space_t::RGB>::tuple_type& pixel);
+
+		/// <summary>
+		/// Convert a single pixel from grayscale to black and white
+		/// </summary>
+		/// <param name="pixel">Original pixel</param>
+		/// <returns>Converted pixel</returns>
+		static image<color_space_t::BW>::tuple_type gray_to_bw_pixel(const image<color_space_t::Gray>::tuple_type& pixel);
 	};
 }
\ No newline at end of file
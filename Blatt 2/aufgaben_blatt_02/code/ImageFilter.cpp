@@ -0,0 +1,456 @@
+#include "ImageFilter.hpp"
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace cg
+{
+	namespace
+	{
+		/// Minimum number of rows processed by one task
+		constexpr std::size_t row_grain = 16;
+
+		/// Number of floats per column band of the vertical recursive filter
+		constexpr std::size_t column_band = 1024;
+
+		/// <summary>
+		/// Map an index to the image according to the border handling
+		/// </summary>
+		/// <param name="index">Index, possibly outside of [0, size)</param>
+		/// <param name="size">Number of pixels in this direction</param>
+		/// <param name="border">Border handling</param>
+		/// <returns>Index inside the image, or -1 for zero pixels</returns>
+		std::ptrdiff_t border_index(std::ptrdiff_t index, const std::ptrdiff_t size, const border_t border)
+		{
+			if (index >= 0 && index < size)
+			{
+				return index;
+			}
+
+			switch (border)
+			{
+			case border_t::clamp:
+				return std::min(std::max(index, std::ptrdiff_t(0)), size - 1);
+			case border_t::mirror:
+				if (size == 1)
+				{
+					return 0;
+				}
+
+				// Reflection has a period of 2 * (size - 1)
+				index = index % (2 * (size - 1));
+				index = (index < 0) ? -index : index;
+
+				return (index < size) ? index : 2 * (size - 1) - index;
+			case border_t::wrap:
+				return ((index % size) + size) % size;
+			case border_t::zero:
+			default:
+				return -1;
+			}
+		}
+
+		/// <summary>
+		/// Copy a row including a border of the given radius on both sides
+		/// </summary>
+		/// <param name="row">Source row</param>
+		/// <param name="padded">Target of size (width + 2 * radius) * channels</param>
+		/// <param name="width">Image width</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		/// <param name="radius">Border radius</param>
+		/// <param name="border">Border handling</param>
+		void pad_row(const float* row, float* padded, const std::size_t width, const std::size_t channels, const std::size_t radius, const border_t border)
+		{
+			const auto signed_width = static_cast<std::ptrdiff_t>(width);
+			const auto signed_radius = static_cast<std::ptrdiff_t>(radius);
+
+			for (std::ptrdiff_t i = -signed_radius; i < 0; ++i)
+			{
+				const auto source = border_index(i, signed_width, border);
+
+				for (std::size_t channel = 0; channel < channels; ++channel)
+				{
+					padded[(i + signed_radius) * channels + channel] = (source < 0) ? 0.f : row[source * channels + channel];
+				}
+			}
+
+			std::copy(row, row + width * channels, padded + radius * channels);
+
+			for (std::ptrdiff_t i = signed_width; i < signed_width + signed_radius; ++i)
+			{
+				const auto source = border_index(i, signed_width, border);
+
+				for (std::size_t channel = 0; channel < channels; ++channel)
+				{
+					padded[(i + signed_radius) * channels + channel] = (source < 0) ? 0.f : row[source * channels + channel];
+				}
+			}
+		}
+
+		/// <summary>
+		/// Check that a kernel is non-empty and has a center
+		/// </summary>
+		/// <param name="kernel">Kernel</param>
+		void check_kernel(const std::vector<float>& kernel)
+		{
+			if (kernel.size() % 2 == 0)
+			{
+				throw std::runtime_error("Filter kernels must have an odd size");
+			}
+		}
+
+		/// <summary>
+		/// Coefficients of the recursive Gaussian by Young and van Vliet
+		/// </summary>
+		struct recursive_coefficients
+		{
+			float b;
+			float a1, a2, a3;
+
+			explicit recursive_coefficients(const float sigma)
+			{
+				const double q = (sigma >= 2.5f) ? 0.98711 * sigma - 0.96330 : 3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+				const double q2 = q * q;
+				const double q3 = q2 * q;
+
+				const double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+				const double b1 = 2.44413 * q + 2.85619 * q2 + 1.26661 * q3;
+				const double b2 = -(1.4281 * q2 + 1.26661 * q3);
+				const double b3 = 0.422205 * q3;
+
+				this->a1 = static_cast<float>(b1 / b0);
+				this->a2 = static_cast<float>(b2 / b0);
+				this->a3 = static_cast<float>(b3 / b0);
+				this->b = 1.f - (this->a1 + this->a2 + this->a3);
+			}
+		};
+	}
+}
+
+std::vector<float> cg::image_filter::gaussian_kernel(const float sigma)
+{
+	if (!(sigma > 0.f))
+	{
+		throw std::runtime_error("Sigma must be positive");
+	}
+
+	const auto radius = static_cast<std::ptrdiff_t>(std::ceil(3.f * sigma));
+	std::vector<float> kernel(2 * radius + 1);
+
+	double sum = 0.0;
+
+	for (std::ptrdiff_t i = -radius; i <= radius; ++i)
+	{
+		const double value = std::exp(-0.5 * static_cast<double>(i * i) / (static_cast<double>(sigma) * sigma));
+		kernel[i + radius] = static_cast<float>(value);
+		sum += value;
+	}
+
+	for (auto& value : kernel)
+	{
+		value = static_cast<float>(value / sum);
+	}
+
+	return kernel;
+}
+
+void cg::image_filter::convolve(const float* source, float* target, const std::size_t width, const std::size_t height, const std::size_t channels,
+	const std::vector<float>& horizontal, const std::vector<float>& vertical, const border_t border)
+{
+	check_kernel(horizontal);
+	check_kernel(vertical);
+
+	if (width == 0 || height == 0)
+	{
+		return;
+	}
+
+	const std::size_t row_size = width * channels;
+	const std::size_t horizontal_radius = horizontal.size() / 2;
+	const std::size_t vertical_radius = vertical.size() / 2;
+
+	std::vector<float> intermediate(row_size * height);
+
+	// Horizontal pass: out[k] = sum_t h[t] * padded[k + t * channels], contiguous in k
+	thread_pool::shared().parallel_for(0, height, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		std::vector<float> padded((width + 2 * horizontal_radius) * channels);
+
+		for (std::size_t j = first; j < last; ++j)
+		{
+			pad_row(source + j * row_size, padded.data(), width, channels, horizontal_radius, border);
+
+			float* out = intermediate.data() + j * row_size;
+			std::fill(out, out + row_size, 0.f);
+
+			for (std::size_t t = 0; t < horizontal.size(); ++t)
+			{
+				const float weight = horizontal[t];
+				const float* in = padded.data() + t * channels;
+
+				for (std::size_t k = 0; k < row_size; ++k)
+				{
+					out[k] += weight * in[k];
+				}
+			}
+		}
+	});
+
+	// Vertical pass: each output row is a weighted sum of whole input rows
+	const auto signed_height = static_cast<std::ptrdiff_t>(height);
+
+	thread_pool::shared().parallel_for(0, height, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		for (std::size_t j = first; j < last; ++j)
+		{
+			float* out = target + j * row_size;
+			std::fill(out, out + row_size, 0.f);
+
+			for (std::size_t t = 0; t < vertical.size(); ++t)
+			{
+				const auto row = border_index(static_cast<std::ptrdiff_t>(j + t) - static_cast<std::ptrdiff_t>(vertical_radius), signed_height, border);
+
+				if (row < 0)
+				{
+					continue;
+				}
+
+				const float weight = vertical[t];
+				const float* in = intermediate.data() + row * row_size;
+
+				for (std::size_t k = 0; k < row_size; ++k)
+				{
+					out[k] += weight * in[k];
+				}
+			}
+		}
+	});
+}
+
+void cg::image_filter::box_blur(const float* source, float* target, const std::size_t width, const std::size_t height, const std::size_t channels,
+	const std::size_t radius, const border_t border)
+{
+	if (width == 0 || height == 0)
+	{
+		return;
+	}
+
+	const std::size_t row_size = width * channels;
+	const std::size_t diameter = 2 * radius + 1;
+	const double scale = 1.0 / static_cast<double>(diameter);
+
+	std::vector<float> intermediate(row_size * height);
+
+	// Horizontal pass: window sums as differences of a running (prefix) sum
+	thread_pool::shared().parallel_for(0, height, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		const std::size_t padded_size = (width + 2 * radius) * channels;
+		std::vector<float> padded(padded_size);
+		std::vector<double> prefix(padded_size + channels);
+
+		for (std::size_t j = first; j < last; ++j)
+		{
+			pad_row(source + j * row_size, padded.data(), width, channels, radius, border);
+
+			std::fill(prefix.begin(), prefix.begin() + channels, 0.0);
+
+			for (std::size_t k = 0; k < padded_size; ++k)
+			{
+				prefix[k + channels] = prefix[k] + padded[k];
+			}
+
+			float* out = intermediate.data() + j * row_size;
+
+			for (std::size_t k = 0; k < row_size; ++k)
+			{
+				out[k] = static_cast<float>((prefix[k + diameter * channels] - prefix[k]) * scale);
+			}
+		}
+	});
+
+	// Vertical pass: per band of rows, slide a window of row sums down the image
+	const auto signed_height = static_cast<std::ptrdiff_t>(height);
+	const auto signed_radius = static_cast<std::ptrdiff_t>(radius);
+
+	thread_pool::shared().parallel_for(0, height, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		std::vector<double> sum(row_size, 0.0);
+
+		const auto add_row = [&](const std::ptrdiff_t j, const double sign)
+		{
+			const auto row = border_index(j, signed_height, border);
+
+			if (row >= 0)
+			{
+				const float* in = intermediate.data() + row * row_size;
+
+				for (std::size_t k = 0; k < row_size; ++k)
+				{
+					sum[k] += sign * in[k];
+				}
+			}
+		};
+
+		const auto signed_first = static_cast<std::ptrdiff_t>(first);
+
+		for (std::ptrdiff_t j = signed_first - signed_radius; j <= signed_first + signed_radius; ++j)
+		{
+			add_row(j, 1.0);
+		}
+
+		for (std::size_t j = first; j < last; ++j)
+		{
+			if (j != first)
+			{
+				add_row(static_cast<std::ptrdiff_t>(j) + signed_radius, 1.0);
+				add_row(static_cast<std::ptrdiff_t>(j) - signed_radius - 1, -1.0);
+			}
+
+			float* out = target + j * row_size;
+
+			for (std::size_t k = 0; k < row_size; ++k)
+			{
+				out[k] = static_cast<float>(sum[k] * scale);
+			}
+		}
+	});
+}
+
+void cg::image_filter::recursive_gaussian_blur(float* data, const std::size_t width, const std::size_t height, const std::size_t channels, const float sigma)
+{
+	if (!(sigma >= 0.5f))
+	{
+		throw std::runtime_error("Sigma must be at least 0.5 for the recursive Gaussian");
+	}
+
+	if (width == 0 || height == 0)
+	{
+		return;
+	}
+
+	const recursive_coefficients c(sigma);
+	const std::size_t row_size = width * channels;
+
+	// The left/top border is handled exactly by starting in the steady state of the edge value.
+	// For the right/bottom border, the causal filter continues over a clamped extension, long
+	// enough for the filter response to decay, so that the anti-causal filter starts correctly.
+	const auto extension = static_cast<std::size_t>(std::ceil(6.f * sigma)) + 3;
+
+	// Horizontal pass: causal and anti-causal filter per row and channel
+	thread_pool::shared().parallel_for(0, height, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		std::vector<float> extended(extension);
+
+		for (std::size_t j = first; j < last; ++j)
+		{
+			float* row = data + j * row_size;
+
+			for (std::size_t channel = 0; channel < channels; ++channel)
+			{
+				const float edge = row[(width - 1) * channels + channel];
+				float w1 = row[channel], w2 = w1, w3 = w1;
+
+				for (std::size_t i = 0; i < width; ++i)
+				{
+					float& value = row[i * channels + channel];
+					const float w = c.b * value + c.a1 * w1 + c.a2 * w2 + c.a3 * w3;
+
+					value = w;
+					w3 = w2;
+					w2 = w1;
+					w1 = w;
+				}
+
+				for (auto& value : extended)
+				{
+					value = c.b * edge + c.a1 * w1 + c.a2 * w2 + c.a3 * w3;
+					w3 = w2;
+					w2 = w1;
+					w1 = value;
+				}
+
+				float y1 = edge, y2 = y1, y3 = y1;
+
+				for (std::size_t i = extension; i-- > 0;)
+				{
+					const float y = c.b * extended[i] + c.a1 * y1 + c.a2 * y2 + c.a3 * y3;
+
+					y3 = y2;
+					y2 = y1;
+					y1 = y;
+				}
+
+				for (std::size_t i = width; i-- > 0;)
+				{
+					float& value = row[i * channels + channel];
+					const float y = c.b * value + c.a1 * y1 + c.a2 * y2 + c.a3 * y3;
+
+					value = y;
+					y3 = y2;
+					y2 = y1;
+					y1 = y;
+				}
+			}
+		}
+	});
+
+	// Vertical pass: run the recursion down and up the rows, vectorized over a band of columns
+	const std::size_t bands = (row_size + column_band - 1) / column_band;
+
+	thread_pool::shared().run(bands, [&](const std::size_t band)
+	{
+		const std::size_t first = band * column_band;
+		const std::size_t count = std::min(column_band, row_size - first);
+
+		const float* last_row = data + (height - 1) * row_size + first;
+		const std::vector<float> edge(last_row, last_row + count);
+
+		std::vector<float> w1(data + first, data + first + count), w2(w1), w3(w1);
+		std::vector<float> extended(extension * count);
+
+		const auto step = [&](const float* in, float* out)
+		{
+			for (std::size_t k = 0; k < count; ++k)
+			{
+				const float w = c.b * in[k] + c.a1 * w1[k] + c.a2 * w2[k] + c.a3 * w3[k];
+
+				out[k] = w;
+				w3[k] = w2[k];
+				w2[k] = w1[k];
+				w1[k] = w;
+			}
+		};
+
+		for (std::size_t j = 0; j < height; ++j)
+		{
+			float* row = data + j * row_size + first;
+			step(row, row);
+		}
+
+		for (std::size_t j = 0; j < extension; ++j)
+		{
+			step(edge.data(), extended.data() + j * count);
+		}
+
+		w1 = edge;
+		w2 = edge;
+		w3 = edge;
+
+		for (std::size_t j = extension; j-- > 0;)
+		{
+			float* row = extended.data() + j * count;
+			step(row, row);
+		}
+
+		for (std::size_t j = height; j-- > 0;)
+		{
+			float* row = data + j * row_size + first;
+			step(row, row);
+		}
+	});
+}
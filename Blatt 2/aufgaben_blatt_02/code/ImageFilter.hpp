@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Image.hpp"
+#include "ImageTraits.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace cg
+{
+	/// <summary>
+	/// Treatment of pixels outside of the image
+	/// </summary>
+	enum class border_t
+	{
+		/// Repeat the edge pixel
+		clamp,
+
+		/// Reflect at the edge pixel (without repeating it)
+		mirror,
+
+		/// Continue at the opposite edge
+		wrap,
+
+		/// Treat outside pixels as zero
+		zero
+	};
+
+	/// <summary>
+	/// Class for filtering images
+	/// All filters are separable and process each channel independently. Both passes work on
+	/// complete rows, so the inner loops run over contiguous memory and can be vectorized.
+	/// Rows are distributed over the shared thread pool.
+	/// </summary>
+	class image_filter
+	{
+	public:
+		/// <summary>
+		/// Separable convolution
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="horizontal">Horizontal kernel (odd size, centered)</param>
+		/// <param name="vertical">Vertical kernel (odd size, centered)</param>
+		/// <param name="border">Border handling</param>
+		/// <returns>Filtered image</returns>
+		template <color_space_t color_space>
+		static image<color_space> convolve(const image<color_space>& original, const std::vector<float>& horizontal, const std::vector<float>& vertical, border_t border = border_t::clamp);
+
+		/// <summary>
+		/// Box filter with constant cost per pixel (running sums)
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="radius">Filter radius; the box has an edge length of 2 * radius + 1</param>
+		/// <param name="border">Border handling</param>
+		/// <returns>Filtered image</returns>
+		template <color_space_t color_space>
+		static image<color_space> box_blur(const image<color_space>& original, std::size_t radius, border_t border = border_t::clamp);
+
+		/// <summary>
+		/// Gaussian filter using a sampled, truncated kernel (radius 3 sigma)
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="sigma">Standard deviation in pixels</param>
+		/// <param name="border">Border handling</param>
+		/// <returns>Filtered image</returns>
+		template <color_space_t color_space>
+		static image<color_space> gaussian_blur(const image<color_space>& original, float sigma, border_t border = border_t::clamp);
+
+		/// <summary>
+		/// Gaussian filter using the recursive approximation by Young and van Vliet
+		/// The cost per pixel is independent of sigma. Borders are clamped.
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="sigma">Standard deviation in pixels (at least 0.5)</param>
+		/// <returns>Filtered image</returns>
+		template <color_space_t color_space>
+		static image<color_space> recursive_gaussian_blur(const image<color_space>& original, float sigma);
+
+		/// <summary>
+		/// Create a normalized Gaussian kernel
+		/// </summary>
+		/// <param name="sigma">Standard deviation in pixels</param>
+		/// <returns>Kernel of size 2 * ceil(3 sigma) + 1</returns>
+		static std::vector<float> gaussian_kernel(float sigma);
+
+	private:
+		/// <summary>
+		/// Convolve interleaved pixel data, first horizontally, then vertically
+		/// </summary>
+		/// <param name="source">Source pixel data</param>
+		/// <param name="target">Target pixel data</param>
+		/// <param name="width">Image width</param>
+		/// <param name="height">Image height</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		/// <param name="horizontal">Horizontal kernel</param>
+		/// <param name="vertical">Vertical kernel</param>
+		/// <param name="border">Border handling</param>
+		static void convolve(const float* source, float* target, std::size_t width, std::size_t height, std::size_t channels,
+			const std::vector<float>& horizontal, const std::vector<float>& vertical, border_t border);
+
+		/// <summary>
+		/// Box filter interleaved pixel data
+		/// </summary>
+		/// <param name="source">Source pixel data</param>
+		/// <param name="target">Target pixel data</param>
+		/// <param name="width">Image width</param>
+		/// <param name="height">Image height</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		/// <param name="radius">Filter radius</param>
+		/// <param name="border">Border handling</param>
+		static void box_blur(const float* source, float* target, std::size_t width, std::size_t height, std::size_t channels,
+			std::size_t radius, border_t border);
+
+		/// <summary>
+		/// Recursive Gaussian filter on interleaved pixel data (in place)
+		/// </summary>
+		/// <param name="data">Pixel data</param>
+		/// <param name="width">Image width</param>
+		/// <param name="height">Image height</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		/// <param name="sigma">Standard deviation in pixels</param>
+		static void recursive_gaussian_blur(float* data, std::size_t width, std::size_t height, std::size_t channels, float sigma);
+	};
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_filter::convolve(const image<color_space>& original, const std::vector<float>& horizontal, const std::vector<float>& vertical, const border_t border)
+{
+	image<color_space> filtered(original.get_width(), original.get_height());
+	convolve(original.get_values(), filtered.get_values(), original.get_width(), original.get_height(), color_channels<color_space>::value, horizontal, vertical, border);
+
+	return filtered;
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_filter::box_blur(const image<color_space>& original, const std::size_t radius, const border_t border)
+{
+	image<color_space> filtered(original.get_width(), original.get_height());
+	box_blur(original.get_values(), filtered.get_values(), original.get_width(), original.get_height(), color_channels<color_space>::value, radius, border);
+
+	return filtered;
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_filter::gaussian_blur(const image<color_space>& original, const float sigma, const border_t border)
+{
+	const auto kernel = gaussian_kernel(sigma);
+
+	return convolve(original, kernel, kernel, border);
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_filter::recursive_gaussian_blur(const image<color_space>& original, const float sigma)
+{
+	image<color_space> filtered(original);
+	recursive_gaussian_blur(filtered.get_values(), original.get_width(), original.get_height(), color_channels<color_space>::value, sigma);
+
+	return filtered;
+}
@@ -0,0 +1,331 @@
+#include "ImageHistogram.hpp"
+
+#include "ImageManipulation.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+namespace cg
+{
+	namespace
+	{
+		/// Minimum number of pixels counted by one task
+		constexpr std::size_t histogram_grain = 65536;
+
+		/// <summary>
+		/// Get the bin of a value; values outside [0, 1] are clamped and NaN falls into the first bin
+		/// </summary>
+		/// <param name="value">Value</param>
+		/// <param name="scale">Number of bins minus one</param>
+		/// <returns>Bin index</returns>
+		inline std::size_t bin_index(const float value, const float scale)
+		{
+			// Both comparisons are false for NaN, std::min/std::max would pass it through
+			const float clamped = (value > 0.f) ? ((value < 1.f) ? value : 1.f) : 0.f;
+
+			return static_cast<std::size_t>(clamped * scale + 0.5f);
+		}
+	}
+}
+
+cg::histogram::histogram(const std::size_t bins) : counts(bins, 0)
+{
+	if (bins < 2)
+	{
+		throw std::runtime_error("Histograms need at least two bins");
+	}
+}
+
+std::size_t cg::histogram::get_bin_count() const
+{
+	return this->counts.size();
+}
+
+std::uint64_t cg::histogram::get_total() const
+{
+	std::uint64_t total = 0;
+
+	for (const auto count : this->counts)
+	{
+		total += count;
+	}
+
+	return total;
+}
+
+const std::vector<std::uint64_t>& cg::histogram::get_counts() const
+{
+	return this->counts;
+}
+
+std::vector<std::uint64_t>& cg::histogram::get_counts()
+{
+	return this->counts;
+}
+
+std::vector<std::uint64_t> cg::histogram::cumulative() const
+{
+	std::vector<std::uint64_t> sums(this->counts.size());
+	std::uint64_t sum = 0;
+
+	for (std::size_t index = 0; index < this->counts.size(); ++index)
+	{
+		sum += this->counts[index];
+		sums[index] = sum;
+	}
+
+	return sums;
+}
+
+std::size_t cg::histogram::bin(const float value) const
+{
+	return bin_index(value, static_cast<float>(this->counts.size() - 1));
+}
+
+float cg::histogram::value(const std::size_t index) const
+{
+	return static_cast<float>(index) / static_cast<float>(this->counts.size() - 1);
+}
+
+cg::histogram& cg::histogram::operator+=(const histogram& other)
+{
+	if (other.counts.size() != this->counts.size())
+	{
+		throw std::runtime_error("Histograms have different numbers of bins");
+	}
+
+	for (std::size_t index = 0; index < this->counts.size(); ++index)
+	{
+		this->counts[index] += other.counts[index];
+	}
+
+	return *this;
+}
+
+std::vector<cg::histogram> cg::image_histogram::compute(const float* data, const std::size_t pixels, const std::size_t channels, const std::size_t bins)
+{
+	std::vector<histogram> result(channels, histogram(bins));
+	std::mutex result_mutex;
+
+	thread_pool::shared().parallel_for(0, pixels, histogram_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		// Count into private bins, so that threads do not contend for shared counters
+		std::vector<histogram> local(channels, histogram(bins));
+
+		for (std::size_t channel = 0; channel < channels; ++channel)
+		{
+			auto& counts = local[channel].get_counts();
+			const float scale = static_cast<float>(bins - 1);
+
+			for (std::size_t index = first; index < last; ++index)
+			{
+				++counts[bin_index(data[index * channels + channel], scale)];
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(result_mutex);
+
+		for (std::size_t channel = 0; channel < channels; ++channel)
+		{
+			result[channel] += local[channel];
+		}
+	});
+
+	return result;
+}
+
+cg::histogram cg::image_histogram::compute(const image<color_space_t::Gray>& original, const std::size_t bins)
+{
+	const auto* data = original.get_values();
+
+	return compute(data, original.get_data().size(), 1, bins)[0];
+}
+
+std::array<cg::histogram, 3> cg::image_histogram::compute(const image<color_space_t::RGB>& original, const std::size_t bins)
+{
+	const auto* data = original.get_values();
+	const auto histograms = compute(data, original.get_data().size(), 3, bins);
+
+	return {{ histograms[0], histograms[1], histograms[2] }};
+}
+
+cg::image<cg::color_space_t::Gray> cg::image_histogram::equalize(const image<color_space_t::Gray>& original, const std::size_t bins)
+{
+	const auto values = compute(original, bins);
+	const auto table = equalization_table(values);
+
+	return image_manipulation::map(original, [&](const image<color_space_t::Gray>::tuple_type& pixel)
+	{
+		return image<color_space_t::Gray>::tuple_type{{ table[values.bin(pixel[0])] }};
+	});
+}
+
+cg::image<cg::color_space_t::RGB> cg::image_histogram::equalize(const image<color_space_t::RGB>& original, const std::size_t bins)
+{
+	const auto values = compute(original, bins);
+	const std::array<std::vector<float>, 3> tables = {{ equalization_table(values[0]), equalization_table(values[1]), equalization_table(values[2]) }};
+
+	return image_manipulation::map(original, [&](const image<color_space_t::RGB>::tuple_type& pixel)
+	{
+		return image<color_space_t::RGB>::tuple_type{{
+			tables[0][values[0].bin(pixel[0])],
+			tables[1][values[1].bin(pixel[1])],
+			tables[2][values[2].bin(pixel[2])] }};
+	});
+}
+
+cg::image<cg::color_space_t::Gray> cg::image_histogram::stretch_contrast(const image<color_space_t::Gray>& original, const float saturation)
+{
+	const auto range = percentile_range(compute(original), saturation);
+	const float scale = (range[1] > range[0]) ? 1.f / (range[1] - range[0]) : 1.f;
+
+	return image_manipulation::map(original, [&](const image<color_space_t::Gray>::tuple_type& pixel)
+	{
+		return image<color_space_t::Gray>::tuple_type{{ std::min(std::max((pixel[0] - range[0]) * scale, 0.f), 1.f) }};
+	});
+}
+
+cg::image<cg::color_space_t::RGB> cg::image_histogram::stretch_contrast(const image<color_space_t::RGB>& original, const float saturation)
+{
+	const auto values = compute(original);
+
+	std::array<float, 3> offset, scale;
+
+	for (std::size_t channel = 0; channel < 3; ++channel)
+	{
+		const auto range = percentile_range(values[channel], saturation);
+		offset[channel] = range[0];
+		scale[channel] = (range[1] > range[0]) ? 1.f / (range[1] - range[0]) : 1.f;
+	}
+
+	return image_manipulation::map(original, [&](const image<color_space_t::RGB>::tuple_type& pixel)
+	{
+		image<color_space_t::RGB>::tuple_type stretched;
+
+		for (std::size_t channel = 0; channel < 3; ++channel)
+		{
+			stretched[channel] = std::min(std::max((pixel[channel] - offset[channel]) * scale[channel], 0.f), 1.f);
+		}
+
+		return stretched;
+	});
+}
+
+float cg::image_histogram::otsu_threshold(const histogram& values)
+{
+	const auto& counts = values.get_counts();
+	const double total = static_cast<double>(values.get_total());
+
+	if (total == 0.0)
+	{
+		return 0.5f;
+	}
+
+	double weighted_total = 0.0;
+
+	for (std::size_t index = 0; index < counts.size(); ++index)
+	{
+		weighted_total += static_cast<double>(index) * static_cast<double>(counts[index]);
+	}
+
+	// Maximize the between-class variance w0 * w1 * (mu0 - mu1)^2 over all splits
+	double lower_count = 0.0;
+	double lower_weighted = 0.0;
+	double best_variance = -1.0;
+	std::size_t best_index = 0;
+
+	for (std::size_t index = 0; index + 1 < counts.size(); ++index)
+	{
+		lower_count += static_cast<double>(counts[index]);
+		lower_weighted += static_cast<double>(index) * static_cast<double>(counts[index]);
+
+		const double upper_count = total - lower_count;
+
+		if (lower_count == 0.0 || upper_count == 0.0)
+		{
+			continue;
+		}
+
+		const double difference = lower_weighted / lower_count - (weighted_total - lower_weighted) / upper_count;
+		const double variance = lower_count * upper_count * difference * difference;
+
+		if (variance > best_variance)
+		{
+			best_variance = variance;
+			best_index = index;
+		}
+	}
+
+	if (best_variance < 0.0)
+	{
+		return 0.5f;
+	}
+
+	// Threshold halfway between the last bin of the lower and the first bin of the upper class
+	return (static_cast<float>(best_index) + 0.5f) / static_cast<float>(counts.size() - 1);
+}
+
+float cg::image_histogram::otsu_threshold(const image<color_space_t::Gray>& original)
+{
+	return otsu_threshold(compute(original));
+}
+
+std::vector<float> cg::image_histogram::equalization_table(const histogram& values)
+{
+	const auto sums = values.cumulative();
+	const std::uint64_t total = sums.back();
+
+	// Map the first occupied bin to zero and spread the cumulative distribution over [0, 1]
+	std::uint64_t minimum = 0;
+
+	for (const auto sum : sums)
+	{
+		if (sum != 0)
+		{
+			minimum = sum;
+			break;
+		}
+	}
+
+	std::vector<float> table(sums.size());
+
+	for (std::size_t index = 0; index < sums.size(); ++index)
+	{
+		if (total == minimum)
+		{
+			table[index] = values.value(index);
+		}
+		else
+		{
+			const auto above = (sums[index] > minimum) ? sums[index] - minimum : 0;
+			table[index] = static_cast<float>(static_cast<double>(above) / static_cast<double>(total - minimum));
+		}
+	}
+
+	return table;
+}
+
+std::array<float, 2> cg::image_histogram::percentile_range(const histogram& values, const float saturation)
+{
+	const auto sums = values.cumulative();
+	const auto total = static_cast<double>(sums.back());
+	const double limit = std::min(std::max(static_cast<double>(saturation), 0.0), 0.5) * total;
+
+	std::size_t low = 0;
+
+	while (low + 1 < sums.size() && static_cast<double>(sums[low]) <= limit)
+	{
+		++low;
+	}
+
+	std::size_t high = sums.size() - 1;
+
+	while (high > low && total - static_cast<double>(sums[high - 1]) <= limit)
+	{
+		--high;
+	}
+
+	return {{ values.value(low), values.value(high) }};
+}
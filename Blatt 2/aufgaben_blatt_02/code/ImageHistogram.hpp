@@ -0,0 +1,173 @@
+#pragma once
+
+#include "Image.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cg
+{
+	/// <summary>
+	/// Histogram of the values of one color channel
+	/// Values in [0, 1] are mapped to equally spaced bins; bin i represents the value i / (bins - 1),
+	/// so that 8-bit data falls exactly into 256 bins.
+	/// </summary>
+	class histogram
+	{
+	public:
+		/// <summary>
+		/// Constructor
+		/// </summary>
+		/// <param name="bins">Number of bins (at least 2)</param>
+		explicit histogram(std::size_t bins = 256);
+
+		/// <summary>
+		/// Get number of bins
+		/// </summary>
+		/// <returns>Number of bins</returns>
+		std::size_t get_bin_count() const;
+
+		/// <summary>
+		/// Get number of values counted
+		/// </summary>
+		/// <returns>Total count</returns>
+		std::uint64_t get_total() const;
+
+		/// <summary>
+		/// Get bin counts
+		/// </summary>
+		/// <returns>Count per bin</returns>
+		const std::vector<std::uint64_t>& get_counts() const;
+		std::vector<std::uint64_t>& get_counts();
+
+		/// <summary>
+		/// Get cumulative histogram
+		/// </summary>
+		/// <returns>Number of values in bins [0, i] for each bin i</returns>
+		std::vector<std::uint64_t> cumulative() const;
+
+		/// <summary>
+		/// Get the bin of a value; values outside [0, 1] are clamped, NaN falls into the first bin
+		/// </summary>
+		/// <param name="value">Value</param>
+		/// <returns>Bin index</returns>
+		std::size_t bin(float value) const;
+
+		/// <summary>
+		/// Get the value represented by a bin
+		/// </summary>
+		/// <param name="index">Bin index</param>
+		/// <returns>Value</returns>
+		float value(std::size_t index) const;
+
+		/// <summary>
+		/// Add the counts of another histogram with the same number of bins
+		/// </summary>
+		/// <param name="other">Other histogram</param>
+		/// <returns>This histogram</returns>
+		histogram& operator+=(const histogram& other);
+
+	private:
+		/// Count per bin
+		std::vector<std::uint64_t> counts;
+	};
+
+	/// <summary>
+	/// Class for histogram-based image operations
+	/// Histograms are computed in parallel with private bins per task, merged at the end.
+	/// </summary>
+	class image_histogram
+	{
+	public:
+		/// <summary>
+		/// Compute the histogram of a grayscale image
+		/// </summary>
+		/// <param name="original">Image</param>
+		/// <param name="bins">Number of bins</param>
+		/// <returns>Histogram</returns>
+		static histogram compute(const image<color_space_t::Gray>& original, std::size_t bins = 256);
+
+		/// <summary>
+		/// Compute the histograms of the channels of an RGB image
+		/// </summary>
+		/// <param name="original">Image</param>
+		/// <param name="bins">Number of bins</param>
+		/// <returns>Histogram per channel</returns>
+		static std::array<histogram, 3> compute(const image<color_space_t::RGB>& original, std::size_t bins = 256);
+
+		/// <summary>
+		/// Equalize the histogram of a grayscale image
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="bins">Number of bins (and output levels)</param>
+		/// <returns>Equalized image</returns>
+		static image<color_space_t::Gray> equalize(const image<color_space_t::Gray>& original, std::size_t bins = 256);
+
+		/// <summary>
+		/// Equalize the histograms of all channels of an RGB image independently
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="bins">Number of bins (and output levels)</param>
+		/// <returns>Equalized image</returns>
+		static image<color_space_t::RGB> equalize(const image<color_space_t::RGB>& original, std::size_t bins = 256);
+
+		/// <summary>
+		/// Stretch the contrast of a grayscale image linearly
+		/// The given fractions of darkest and brightest pixels are saturated to black and white.
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="saturation">Fraction of pixels saturated at each end</param>
+		/// <returns>Modified image</returns>
+		static image<color_space_t::Gray> stretch_contrast(const image<color_space_t::Gray>& original, float saturation = 0.01f);
+
+		/// <summary>
+		/// Stretch the contrast of all channels of an RGB image independently
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="saturation">Fraction of pixels saturated at each end</param>
+		/// <returns>Modified image</returns>
+		static image<color_space_t::RGB> stretch_contrast(const image<color_space_t::RGB>& original, float saturation = 0.01f);
+
+		/// <summary>
+		/// Select the threshold separating two classes of values with Otsu's method
+		/// </summary>
+		/// <param name="values">Histogram</param>
+		/// <returns>Threshold; values below belong to the lower class</returns>
+		static float otsu_threshold(const histogram& values);
+
+		/// <summary>
+		/// Select the black-and-white threshold of a grayscale image with Otsu's method
+		/// </summary>
+		/// <param name="original">Image</param>
+		/// <returns>Threshold</returns>
+		static float otsu_threshold(const image<color_space_t::Gray>& original);
+
+	private:
+		/// <summary>
+		/// Compute histograms of the channels of interleaved pixel data
+		/// </summary>
+		/// <param name="data">Pixel data</param>
+		/// <param name="pixels">Number of pixels</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		/// <param name="bins">Number of bins</param>
+		/// <returns>Histogram per channel</returns>
+		static std::vector<histogram> compute(const float* data, std::size_t pixels, std::size_t channels, std::size_t bins);
+
+		/// <summary>
+		/// Create the look-up table equalizing a histogram
+		/// </summary>
+		/// <param name="values">Histogram</param>
+		/// <returns>New value per bin</returns>
+		static std::vector<float> equalization_table(const histogram& values);
+
+		/// <summary>
+		/// Find the value range containing all but the given fraction of values at each end
+		/// </summary>
+		/// <param name="values">Histogram</param>
+		/// <param name="saturation">Fraction of values excluded at each end</param>
+		/// <returns>Lowest and highest value</returns>
+		static std::array<float, 2> percentile_range(const histogram& values, float saturation);
+	};
+}
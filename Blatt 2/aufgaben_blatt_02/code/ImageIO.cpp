@@ -1,10 +1,18 @@
 #include "ImageIO.hpp"
 
+#include "ImageAllocations.hpp"
+
+#include <algorithm>
+#include <cstddef>
 #include <exception>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace cg
 {
@@ -19,15 +27,21 @@ namespace cg
 			{
 				enum file_t
 				{
-					INVALID, PLAIN_PBM, PLAIN_PGM, PLAIN_PPM, PBM, PGM, PPM
+					INVALID, PLAIN_PBM, PLAIN_PGM, PLAIN_PPM, PBM, PGM, PPM, PAM
 				}
 				file_type;
 
-				unsigned int width;
-				unsigned int height;
+				std::size_t width;
+				std::size_t height;
 				unsigned int max_value;
+
+				/// Number of channels per pixel
+				std::size_t depth;
 			};
 
+			/// Size of the blocks in which binary pixel data is read from or written to file
+			constexpr std::size_t io_chunk_size = 16 * 1024 * 1024;
+
 			/// <summary>
 			/// Read file header
 			/// </summary>
@@ -42,6 +56,13 @@ namespace cg
 			/// <param name="file_header">File header</param>
 			void save_header(std::ofstream& stream, const header& file_header);
 
+			/// <summary>
+			/// Read the remaining header lines of a PAM file
+			/// </summary>
+			/// <param name="stream">Input stream, positioned after the magic number</param>
+			/// <param name="file_header">File header to complete</param>
+			void load_pam_header(std::ifstream& stream, header& file_header);
+
 			/// <summary>
 			/// Load plain PBM image
 			/// </summary>
@@ -90,6 +111,15 @@ namespace cg
 			/// <returns>RGB image</returns>
 			image<color_space_t::RGB> load_ppm(std::ifstream& stream, const header& header);
 
+			/// <summary>
+			/// Load PAM image
+			/// Grayscale and RGB tuples are loaded as opaque, and the color is premultiplied by alpha.
+			/// </summary>
+			/// <param name="stream">Input stream</param>
+			/// <param name="header">File header</param>
+			/// <returns>RGBA image</returns>
+			image<color_space_t::RGBA> load_pam(std::ifstream& stream, const header& header);
+
 			/// <summary>
 			/// Save plain PBM image
 			/// </summary>
@@ -135,12 +165,142 @@ namespace cg
 			/// <param name="max_value">Maximum value</param>
 			void save_ppm(std::ofstream& stream, const image<color_space_t::RGB>& image, unsigned int max_value = 255);
 
+			/// <summary>
+			/// Save PAM image with tuple type RGB_ALPHA
+			/// The color is stored divided by alpha, as PAM does not premultiply.
+			/// </summary>
+			/// <param name="stream">Output stream</param>
+			/// <param name="image">RGBA image</param>
+			/// <param name="max_value">Maximum value</param>
+			void save_pam(std::ofstream& stream, const image<color_space_t::RGBA>& image, unsigned int max_value = 255);
+
+			/// <summary>
+			/// Convert a color value to an integer sample
+			/// Values outside [0, 1] (e.g. ringing of the bicubic and Lanczos resampling filters) are clamped.
+			/// </summary>
+			/// <param name="value">Color value</param>
+			/// <param name="max_value">Maximum value</param>
+			/// <returns>Sample in [0, max_value]</returns>
+			unsigned int to_sample(float value, unsigned int max_value);
+
 			/// <summary>
 			/// Read a value
 			/// </summary>
 			/// <param name="stream">Input stream</param>
 			/// <returns>Value</returns>
-			unsigned int read_value(std::ifstream& stream);
+			std::size_t read_value(std::ifstream& stream);
+
+			/// <summary>
+			/// Multiply two sizes, throwing if the result does not fit into std::size_t
+			/// </summary>
+			/// <param name="lhs">First factor</param>
+			/// <param name="rhs">Second factor</param>
+			/// <returns>Product</returns>
+			std::size_t checked_multiply(std::size_t lhs, std::size_t rhs);
+
+			/// <summary>
+			/// Get the number of rows that fit into one I/O chunk
+			/// </summary>
+			/// <param name="row_size">Size of a single row in bytes</param>
+			/// <returns>Number of rows (at least one)</returns>
+			std::size_t rows_per_chunk(std::size_t row_size);
+
+			/// <summary>
+			/// Read a block of binary data
+			/// </summary>
+			/// <param name="stream">Input stream</param>
+			/// <param name="buffer">Target buffer</param>
+			/// <param name="size">Number of bytes to read</param>
+			void read_chunk(std::ifstream& stream, char* buffer, std::size_t size);
+
+			/// <summary>
+			/// Write a block of binary data
+			/// </summary>
+			/// <param name="stream">Output stream</param>
+			/// <param name="buffer">Source buffer</param>
+			/// <param name="size">Number of bytes to write</param>
+			void write_chunk(std::ofstream& stream, const char* buffer, std::size_t size);
+
+			/// <summary>
+			/// Sequential reader decoding the pixel rows of a PGM or PPM file (plain or binary) into floats
+			/// Binary data is read in chunks of whole rows.
+			/// </summary>
+			class row_reader
+			{
+			public:
+				/// <summary>
+				/// Constructor
+				/// </summary>
+				/// <param name="stream">Input stream, positioned after the header</param>
+				/// <param name="file_header">File header</param>
+				/// <param name="channels">Number of channels per pixel</param>
+				row_reader(std::ifstream& stream, const header& file_header, std::size_t channels);
+
+				/// <summary>
+				/// Decode the next row
+				/// </summary>
+				/// <param name="row">Target buffer for width * channels values</param>
+				void read(float* row);
+
+			private:
+				std::ifstream& stream;
+				const header& file_header;
+
+				/// Number of values per row
+				const std::size_t row_values;
+
+				/// Whether the pixel data is binary, and whether it uses two bytes per value
+				const bool binary;
+				const bool wide;
+
+				/// Binary rows of the current chunk
+				std::vector<char> buffer;
+				std::size_t chunk_rows;
+				std::size_t buffered_rows;
+				std::size_t next_row;
+				std::size_t rows_read;
+			};
+
+			/// <summary>
+			/// Source columns (or rows) covered by each target column (or row) when shrinking by area averaging
+			/// </summary>
+			struct area_weights
+			{
+				/// Range [offsets[i], offsets[i + 1]) of the entries belonging to target position i
+				std::vector<std::size_t> offsets;
+
+				/// Source index and weight (fraction of the target area covered) of each entry
+				std::vector<std::size_t> indices;
+				std::vector<float> weights;
+			};
+
+			/// <summary>
+			/// Compute the area averaging weights for one axis
+			/// </summary>
+			/// <param name="source_size">Number of source pixels</param>
+			/// <param name="target_size">Number of target pixels (1 to source_size)</param>
+			/// <returns>Weights</returns>
+			area_weights compute_area_weights(std::size_t source_size, std::size_t target_size);
+
+			/// <summary>
+			/// Load a PGM or PPM image and shrink it by area averaging while reading
+			/// Only one source row and two target rows are held in memory besides the result.
+			/// </summary>
+			/// <param name="stream">Input stream</param>
+			/// <param name="header">File header</param>
+			/// <param name="width">Target width</param>
+			/// <param name="height">Target height</param>
+			/// <returns>Shrunk image</returns>
+			template <color_space_t color_space>
+			image<color_space> load_shrunk(std::ifstream& stream, const header& header, std::size_t width, std::size_t height);
+
+			/// <summary>
+			/// Get the target size for shrinking by a factor
+			/// </summary>
+			/// <param name="size">Source size</param>
+			/// <param name="scale">Scale factor in (0, 1]</param>
+			/// <returns>Target size (at least one)</returns>
+			std::size_t scaled_size(std::size_t size, float scale);
 
 			cg::image_io::header load_header(std::ifstream& stream)
 			{
@@ -176,6 +336,10 @@ namespace cg
 					{
 						file_header.file_type = header::file_t::PPM;
 					}
+					else if (magic_number[1] == '7')
+					{
+						file_header.file_type = header::file_t::PAM;
+					}
 					else
 					{
 						file_header.file_type = header::file_t::INVALID;
@@ -191,15 +355,36 @@ namespace cg
 					throw std::runtime_error("Invalid file format");
 				}
 
-				// Read extents (width, height, max. value)
-				file_header.width = read_value(stream);
-				file_header.height = read_value(stream);
-
-				if (file_header.file_type == header::file_t::PGM || file_header.file_type == header::file_t::PPM)
+				if (file_header.file_type == header::file_t::PAM)
+				{
+					load_pam_header(stream, file_header);
+				}
+				else
 				{
-					file_header.max_value = read_value(stream);
+					// Read extents (width, height, max. value)
+					file_header.width = read_value(stream);
+					file_header.height = read_value(stream);
+					file_header.max_value = 1;
+					file_header.depth = (file_header.file_type == header::file_t::PPM || file_header.file_type == header::file_t::PLAIN_PPM) ? 3 : 1;
+
+					if (file_header.file_type == header::file_t::PGM || file_header.file_type == header::file_t::PPM ||
+						file_header.file_type == header::file_t::PLAIN_PGM || file_header.file_type == header::file_t::PLAIN_PPM)
+					{
+						const auto max_value = read_value(stream);
+
+						if (max_value == 0 || max_value > 65535)
+						{
+							throw std::runtime_error("Invalid maximum value");
+						}
+
+						file_header.max_value = static_cast<unsigned int>(max_value);
+					}
 				}
 
+				// Make sure that the decoded image can be addressed
+				const std::size_t channels = (file_header.file_type == header::file_t::PAM) ? 4 : file_header.depth;
+				checked_multiply(checked_multiply(checked_multiply(file_header.width, file_header.height), channels), sizeof(float));
+
 				return file_header;
 			}
 
@@ -232,6 +417,20 @@ namespace cg
 					stream << "P6" << std::endl;
 
 					break;
+				case header::file_t::PAM:
+				{
+					static const char* const tuple_types[] = { "GRAYSCALE", "GRAYSCALE_ALPHA", "RGB", "RGB_ALPHA" };
+
+					if (file_header.depth < 1 || file_header.depth > 4)
+					{
+						throw std::runtime_error("Invalid header");
+					}
+
+					stream << "P7\n" << "WIDTH " << file_header.width << "\n" << "HEIGHT " << file_header.height << "\n" << "DEPTH " << file_header.depth << "\n"
+						<< "MAXVAL " << file_header.max_value << "\n" << "TUPLTYPE " << tuple_types[file_header.depth - 1] << "\n" << "ENDHDR" << std::endl;
+
+					return;
+				}
 				default:
 					throw std::runtime_error("Invalid header");
 				}
@@ -239,22 +438,97 @@ namespace cg
 				// Save extents
 				stream << file_header.width << " " << file_header.height << "\n";
 
-				if (file_header.file_type == header::file_t::PGM || file_header.file_type == header::file_t::PPM)
+				if (file_header.file_type == header::file_t::PGM || file_header.file_type == header::file_t::PPM ||
+					file_header.file_type == header::file_t::PLAIN_PGM || file_header.file_type == header::file_t::PLAIN_PPM)
 				{
 					stream << file_header.max_value << std::endl;
 				}
 			}
 
+			void load_pam_header(std::ifstream& stream, header& file_header)
+			{
+				std::size_t width = 0, height = 0, depth = 0, max_value = 0;
+				std::string line;
+
+				// Skip the rest of the magic number line
+				std::getline(stream, line);
+
+				while (std::getline(stream, line))
+				{
+					std::istringstream tokens(line.substr(0, line.find('#')));
+					std::string key;
+
+					if (!(tokens >> key))
+					{
+						continue;
+					}
+
+					if (key == "ENDHDR")
+					{
+						if (width == 0 || height == 0 || depth < 1 || depth > 4)
+						{
+							throw std::runtime_error("Invalid PAM header");
+						}
+
+						if (max_value == 0 || max_value > 65535)
+						{
+							throw std::runtime_error("Invalid maximum value");
+						}
+
+						file_header.width = width;
+						file_header.height = height;
+						file_header.depth = depth;
+						file_header.max_value = static_cast<unsigned int>(max_value);
+
+						return;
+					}
+
+					// The tuple type is implied by the depth
+					if (key == "TUPLTYPE")
+					{
+						continue;
+					}
+
+					std::size_t value = 0;
+
+					if (!(tokens >> value))
+					{
+						throw std::runtime_error("Invalid PAM header");
+					}
+
+					if (key == "WIDTH")
+					{
+						width = value;
+					}
+					else if (key == "HEIGHT")
+					{
+						height = value;
+					}
+					else if (key == "DEPTH")
+					{
+						depth = value;
+					}
+					else if (key == "MAXVAL")
+					{
+						max_value = value;
+					}
+					else
+					{
+						throw std::runtime_error("Invalid PAM header");
+					}
+				}
+
+				throw std::runtime_error("Unexpected end of file");
+			}
+
 			cg::image<cg::color_space_t::BW> load_plain_pbm(std::ifstream& stream, const header& header)
 			{
 				// Create image
 				cg::image<cg::color_space_t::BW> image(header.width, header.height);
 
-				std::size_t index = 0;
-
-				for (unsigned int j = 0; j < header.height; ++j)
+				for (std::size_t j = 0; j < header.height; ++j)
 				{
-					for (unsigned int i = 0; i < header.width; ++i)
+					for (std::size_t i = 0; i < header.width; ++i)
 					{
 						image(i, j)[0] = (read_value(stream) != 1) ? 1.0f : 0.0f;
 					}
@@ -268,11 +542,9 @@ namespace cg
 				// Create image
 				cg::image<cg::color_space_t::Gray> image(header.width, header.height);
 
-				std::size_t index = 0;
-
-				for (unsigned int j = 0; j < header.height; ++j)
+				for (std::size_t j = 0; j < header.height; ++j)
 				{
-					for (unsigned int i = 0; i < header.width; ++i)
+					for (std::size_t i = 0; i < header.width; ++i)
 					{
 						image(i, j)[0] = static_cast<float>(read_value(stream)) / static_cast<float>(header.max_value);
 					}
@@ -286,11 +558,9 @@ namespace cg
 				// Create image
 				cg::image<cg::color_space_t::RGB> image(header.width, header.height);
 
-				std::size_t index = 0;
-
-				for (unsigned int j = 0; j < header.height; ++j)
+				for (std::size_t j = 0; j < header.height; ++j)
 				{
-					for (unsigned int i = 0; i < header.width; ++i)
+					for (std::size_t i = 0; i < header.width; ++i)
 					{
 						image(i, j)[0] = static_cast<float>(read_value(stream)) / static_cast<float>(header.max_value);
 						image(i, j)[1] = static_cast<float>(read_value(stream)) / static_cast<float>(header.max_value);
@@ -303,31 +573,29 @@ namespace cg
 
 			cg::image<cg::color_space_t::BW> load_pbm(std::ifstream& stream, const header& header)
 			{
-				// Read image
-				std::vector<char> buffer((header.width + header.width % 8) * header.height / 8);
-				const auto* cbuffer = reinterpret_cast<unsigned char*>(buffer.data());
-
-				stream.read(buffer.data(), buffer.size());
-
 				// Create image
 				cg::image<cg::color_space_t::BW> image(header.width, header.height);
 
-				std::size_t index = buffer.size() - 1;
+				// Read image in chunks of whole rows; each row is padded to full bytes
+				const std::size_t row_size = (header.width + 7) / 8;
+				const std::size_t chunk_rows = rows_per_chunk(row_size);
+
+				std::vector<char> buffer(std::min(chunk_rows, header.height) * row_size);
+				const auto* cbuffer = reinterpret_cast<unsigned char*>(buffer.data());
 
-				for (int j = header.height - 1; j >= 0; --j)
+				for (std::size_t first_row = 0; first_row < header.height; first_row += chunk_rows)
 				{
-					for (int i = (header.width + header.width % 8) - 1; i >= 0; i -= 8)
+					const std::size_t rows = std::min(chunk_rows, header.height - first_row);
+					read_chunk(stream, buffer.data(), rows * row_size);
+
+					for (std::size_t j = 0; j < rows; ++j)
 					{
-						image((i - 0) % header.width, j)[0] = ((cbuffer[index] & 1) != 0) ? 0.0f : 1.0f;
-						image((i - 1) % header.width, j)[0] = ((cbuffer[index] & 2) != 0) ? 0.0f : 1.0f;
-						image((i - 2) % header.width, j)[0] = ((cbuffer[index] & 4) != 0) ? 0.0f : 1.0f;
-						image((i - 3) % header.width, j)[0] = ((cbuffer[index] & 8) != 0) ? 0.0f : 1.0f;
-						image((i - 4) % header.width, j)[0] = ((cbuffer[index] & 16) != 0) ? 0.0f : 1.0f;
-						image((i - 5) % header.width, j)[0] = ((cbuffer[index] & 32) != 0) ? 0.0f : 1.0f;
-						image((i - 6) % header.width, j)[0] = ((cbuffer[index] & 64) != 0) ? 0.0f : 1.0f;
-						image((i - 7) % header.width, j)[0] = ((cbuffer[index] & 128) != 0) ? 0.0f : 1.0f;
+						const auto* row = cbuffer + j * row_size;
 
-						--index;
+						for (std::size_t i = 0; i < header.width; ++i)
+						{
+							image(i, first_row + j)[0] = ((row[i / 8] & (128 >> (i % 8))) != 0) ? 0.0f : 1.0f;
+						}
 					}
 				}
 
@@ -336,29 +604,36 @@ namespace cg
 
 			cg::image<cg::color_space_t::Gray> load_pgm(std::ifstream& stream, const header& header)
 			{
-				// Read image
-				std::vector<char> buffer(header.width * header.height * ((header.max_value >= 256) ? 2 : 1));
-				const auto* cbuffer = reinterpret_cast<unsigned char*>(buffer.data());
-				const auto* wbuffer = reinterpret_cast<char16_t*>(buffer.data());
-
-				stream.read(buffer.data(), buffer.size());
-
 				// Create image
 				cg::image<cg::color_space_t::Gray> image(header.width, header.height);
 
-				std::size_t index = 0;
+				// Read image in chunks of whole rows
+				const std::size_t row_size = header.width * ((header.max_value >= 256) ? 2 : 1);
+				const std::size_t chunk_rows = rows_per_chunk(row_size);
 
-				for (unsigned int j = 0; j < header.height; ++j)
+				std::vector<char> buffer(std::min(chunk_rows, header.height) * row_size);
+				const auto* cbuffer = reinterpret_cast<unsigned char*>(buffer.data());
+				const auto* wbuffer = reinterpret_cast<char16_t*>(buffer.data());
+
+				for (std::size_t first_row = 0; first_row < header.height; first_row += chunk_rows)
 				{
-					for (unsigned int i = 0; i < header.width; ++i)
+					const std::size_t rows = std::min(chunk_rows, header.height - first_row);
+					read_chunk(stream, buffer.data(), rows * row_size);
+
+					std::size_t index = 0;
+
+					for (std::size_t j = first_row; j < first_row + rows; ++j)
 					{
-						if (header.max_value < 256)
-						{
-							image(i, j)[0] = static_cast<float>(cbuffer[index++]) / static_cast<float>(header.max_value);
-						}
-						else
+						for (std::size_t i = 0; i < header.width; ++i)
 						{
-							image(i, j)[0] = static_cast<float>(wbuffer[index++]) / static_cast<float>(header.max_value);
+							if (header.max_value < 256)
+							{
+								image(i, j)[0] = static_cast<float>(cbuffer[index++]) / static_cast<float>(header.max_value);
+							}
+							else
+							{
+								image(i, j)[0] = static_cast<float>(wbuffer[index++]) / static_cast<float>(header.max_value);
+							}
 						}
 					}
 				}
@@ -368,33 +643,90 @@ namespace cg
 
 			cg::image<cg::color_space_t::RGB> load_ppm(std::ifstream& stream, const header& header)
 			{
-				// Read image
-				std::vector<char> buffer(3 * header.width * header.height * ((header.max_value >= 256) ? 2 : 1));
+				// Create image
+				cg::image<cg::color_space_t::RGB> image(header.width, header.height);
+
+				// Read image in chunks of whole rows
+				const std::size_t row_size = 3 * header.width * ((header.max_value >= 256) ? 2 : 1);
+				const std::size_t chunk_rows = rows_per_chunk(row_size);
+
+				std::vector<char> buffer(std::min(chunk_rows, header.height) * row_size);
 				const auto* cbuffer = reinterpret_cast<unsigned char*>(buffer.data());
 				const auto* wbuffer = reinterpret_cast<char16_t*>(buffer.data());
 
-				stream.read(buffer.data(), buffer.size());
+				for (std::size_t first_row = 0; first_row < header.height; first_row += chunk_rows)
+				{
+					const std::size_t rows = std::min(chunk_rows, header.height - first_row);
+					read_chunk(stream, buffer.data(), rows * row_size);
+
+					std::size_t index = 0;
+
+					for (std::size_t j = first_row; j < first_row + rows; ++j)
+					{
+						for (std::size_t i = 0; i < header.width; ++i)
+						{
+							if (header.max_value < 256)
+							{
+								image(i, j)[0] = static_cast<float>(cbuffer[index++]) / static_cast<float>(header.max_value);
+								image(i, j)[1] = static_cast<float>(cbuffer[index++]) / static_cast<float>(header.max_value);
+								image(i, j)[2] = static_cast<float>(cbuffer[index++]) / static_cast<float>(header.max_value);
+							}
+							else
+							{
+								image(i, j)[0] = static_cast<float>(wbuffer[index++]) / static_cast<float>(header.max_value);
+								image(i, j)[1] = static_cast<float>(wbuffer[index++]) / static_cast<float>(header.max_value);
+								image(i, j)[2] = static_cast<float>(wbuffer[index++]) / static_cast<float>(header.max_value);
+							}
+						}
+					}
+				}
+
+				return image;
+			}
 
+			cg::image<cg::color_space_t::RGBA> load_pam(std::ifstream& stream, const header& header)
+			{
 				// Create image
-				cg::image<cg::color_space_t::RGB> image(header.width, header.height);
+				cg::image<cg::color_space_t::RGBA> image(header.width, header.height);
+
+				// Read image in chunks of whole rows
+				const std::size_t depth = header.depth;
+				const std::size_t row_size = depth * header.width * ((header.max_value >= 256) ? 2 : 1);
+				const std::size_t chunk_rows = rows_per_chunk(row_size);
+
+				std::vector<char> buffer(std::min(chunk_rows, header.height) * row_size);
+				const auto* cbuffer = reinterpret_cast<unsigned char*>(buffer.data());
+				const auto* wbuffer = reinterpret_cast<char16_t*>(buffer.data());
 
-				std::size_t index = 0;
+				const float scale = 1.0f / static_cast<float>(header.max_value);
+				const bool color = (depth >= 3);
+				const bool alpha = (depth % 2 == 0);
 
-				for (unsigned int j = 0; j < header.height; ++j)
+				for (std::size_t first_row = 0; first_row < header.height; first_row += chunk_rows)
 				{
-					for (unsigned int i = 0; i < header.width; ++i)
+					const std::size_t rows = std::min(chunk_rows, header.height - first_row);
+					read_chunk(stream, buffer.data(), rows * row_size);
+
+					std::size_t index = 0;
+
+					for (std::size_t j = first_row; j < first_row + rows; ++j)
 					{
-						if (header.max_value < 256)
+						for (std::size_t i = 0; i < header.width; ++i, index += depth)
 						{
-							image(i, j)[0] = static_cast<float>(cbuffer[index++]) / static_cast<float>(header.max_value);
-							image(i, j)[1] = static_cast<float>(cbuffer[index++]) / static_cast<float>(header.max_value);
-							image(i, j)[2] = static_cast<float>(cbuffer[index++]) / static_cast<float>(header.max_value);
-						}
-						else
-						{
-							image(i, j)[0] = static_cast<float>(wbuffer[index++]) / static_cast<float>(header.max_value);
-							image(i, j)[1] = static_cast<float>(wbuffer[index++]) / static_cast<float>(header.max_value);
-							image(i, j)[2] = static_cast<float>(wbuffer[index++]) / static_cast<float>(header.max_value);
+							std::array<float, 4> values;
+
+							for (std::size_t channel = 0; channel < depth; ++channel)
+							{
+								values[channel] = static_cast<float>((header.max_value < 256) ? cbuffer[index + channel] : wbuffer[index + channel]) * scale;
+							}
+
+							const float a = alpha ? values[depth - 1] : 1.0f;
+							auto& pixel = image(i, j);
+
+							pixel[0] = values[0] * a;
+							pixel[1] = (color ? values[1] : values[0]) * a;
+							pixel[2] = (color ? values[2] : values[0]) * a;
+							pixel[3] = a;
 						}
 					}
 				}
@@ -404,9 +736,9 @@ namespace cg
 
 			void save_plain_pbm(std::ofstream& stream, const cg::image<cg::color_space_t::BW>& image)
 			{
-				for (unsigned int j = 0; j < image.get_height(); ++j)
+				for (std::size_t j = 0; j < image.get_height(); ++j)
 				{
-					for (unsigned int i = 0; i < image.get_width() - 1; ++i)
+					for (std::size_t i = 0; i < image.get_width() - 1; ++i)
 					{
 						stream << ((image(i, j)[0] != 0.0f) ? 0 : 1) << " ";
 					}
@@ -417,126 +749,190 @@ namespace cg
 
 			void save_plain_pgm(std::ofstream& stream, const cg::image<cg::color_space_t::Gray>& image)
 			{
-				for (unsigned int j = 0; j < image.get_height(); ++j)
+				for (std::size_t j = 0; j < image.get_height(); ++j)
 				{
-					for (unsigned int i = 0; i < image.get_width() - 1; ++i)
+					for (std::size_t i = 0; i < image.get_width() - 1; ++i)
 					{
-						stream << static_cast<unsigned int>(image(i, j)[0] * 255.0f) << " ";
+						stream << to_sample(image(i, j)[0], 255) << " ";
 					}
 
-					stream << static_cast<unsigned int>(image(image.get_width() - 1, j)[0] * 255.0f) << std::endl;
+					stream << to_sample(image(image.get_width() - 1, j)[0], 255) << std::endl;
 				}
 			}
 
 			void save_plain_ppm(std::ofstream& stream, const cg::image<cg::color_space_t::RGB>& image)
 			{
-				for (unsigned int j = 0; j < image.get_height(); ++j)
+				for (std::size_t j = 0; j < image.get_height(); ++j)
 				{
-					for (unsigned int i = 0; i < image.get_width() - 1; ++i)
+					for (std::size_t i = 0; i < image.get_width() - 1; ++i)
 					{
-						stream << static_cast<unsigned int>(image(i, j)[0] * 255.0f) << " ";
-						stream << static_cast<unsigned int>(image(i, j)[1] * 255.0f) << " ";
-						stream << static_cast<unsigned int>(image(i, j)[2] * 255.0f) << "\t";
+						stream << to_sample(image(i, j)[0], 255) << " ";
+						stream << to_sample(image(i, j)[1], 255) << " ";
+						stream << to_sample(image(i, j)[2], 255) << "\t";
 					}
 
-					stream << static_cast<unsigned int>(image(image.get_width() - 1, j)[0] * 255.0f) << " ";
-					stream << static_cast<unsigned int>(image(image.get_width() - 1, j)[1] * 255.0f) << " ";
-					stream << static_cast<unsigned int>(image(image.get_width() - 1, j)[2] * 255.0f) << std::endl;
+					stream << to_sample(image(image.get_width() - 1, j)[0], 255) << " ";
+					stream << to_sample(image(image.get_width() - 1, j)[1], 255) << " ";
+					stream << to_sample(image(image.get_width() - 1, j)[2], 255) << std::endl;
 				}
 			}
 
 			void save_pbm(std::ofstream& stream, const cg::image<cg::color_space_t::BW>& image)
 			{
-				// Create buffer
-				std::vector<char> buffer((image.get_width() + image.get_width() % 8) * image.get_height() / 8);
-				auto* cbuffer = reinterpret_cast<unsigned char*>(buffer.data());
+				// Write image in chunks of whole rows; each row is padded to full bytes
+				const std::size_t row_size = (image.get_width() + 7) / 8;
+				const std::size_t chunk_rows = rows_per_chunk(row_size);
 
-				std::size_t index = 0;
+				std::vector<char> buffer(std::min(chunk_rows, image.get_height()) * row_size);
+				auto* cbuffer = reinterpret_cast<unsigned char*>(buffer.data());
 
-				for (unsigned int j = 0; j < image.get_height(); ++j)
+				for (std::size_t first_row = 0; first_row < image.get_height(); first_row += chunk_rows)
 				{
-					for (unsigned int i = 0; i < image.get_width(); i += 8)
-					{
-						cbuffer[index] = static_cast<unsigned char>(0);
+					const std::size_t rows = std::min(chunk_rows, image.get_height() - first_row);
+					std::fill(buffer.begin(), buffer.begin() + rows * row_size, 0);
 
-						cbuffer[index] |= (image((i + 0) % image.get_width(), j)[0] != 0.0f) ? 0 : 128;
-						cbuffer[index] |= (image((i + 1) % image.get_width(), j)[0] != 0.0f) ? 0 : 64;
-						cbuffer[index] |= (image((i + 2) % image.get_width(), j)[0] != 0.0f) ? 0 : 32;
-						cbuffer[index] |= (image((i + 3) % image.get_width(), j)[0] != 0.0f) ? 0 : 16;
-						cbuffer[index] |= (image((i + 4) % image.get_width(), j)[0] != 0.0f) ? 0 : 8;
-						cbuffer[index] |= (image((i + 5) % image.get_width(), j)[0] != 0.0f) ? 0 : 4;
-						cbuffer[index] |= (image((i + 6) % image.get_width(), j)[0] != 0.0f) ? 0 : 2;
-						cbuffer[index] |= (image((i + 7) % image.get_width(), j)[0] != 0.0f) ? 0 : 1;
+					for (std::size_t j = 0; j < rows; ++j)
+					{
+						auto* row = cbuffer + j * row_size;
 
-						++index;
+						for (std::size_t i = 0; i < image.get_width(); ++i)
+						{
+							row[i / 8] |= (image(i, first_row + j)[0] != 0.0f) ? 0 : (128 >> (i % 8));
+						}
 					}
-				}
 
-				// Save to file
-				stream.write(buffer.data(), buffer.size());
+					write_chunk(stream, buffer.data(), rows * row_size);
+				}
 			}
 
 			void save_pgm(std::ofstream& stream, const cg::image<cg::color_space_t::Gray>& image, const unsigned int max_value)
 			{
-				// Create buffer
-				std::vector<char> buffer(image.get_width() * image.get_height() * ((max_value >= 256) ? 2 : 1));
+				// Write image in chunks of whole rows
+				const std::size_t row_size = image.get_width() * ((max_value >= 256) ? 2 : 1);
+				const std::size_t chunk_rows = rows_per_chunk(row_size);
+
+				std::vector<char> buffer(std::min(chunk_rows, image.get_height()) * row_size);
 				auto* cbuffer = reinterpret_cast<unsigned char*>(buffer.data());
 				auto* wbuffer = reinterpret_cast<char16_t*>(buffer.data());
 
-				std::size_t index = 0;
-
-				for (unsigned int j = 0; j < image.get_height(); ++j)
+				for (std::size_t first_row = 0; first_row < image.get_height(); first_row += chunk_rows)
 				{
-					for (unsigned int i = 0; i < image.get_width(); ++i)
+					const std::size_t rows = std::min(chunk_rows, image.get_height() - first_row);
+
+					std::size_t index = 0;
+
+					for (std::size_t j = first_row; j < first_row + rows; ++j)
 					{
-						if (max_value < 256)
+						for (std::size_t i = 0; i < image.get_width(); ++i)
 						{
-							cbuffer[index++] = static_cast<unsigned char>(image(i, j)[0] * max_value);
-						}
-						else
-						{
-							wbuffer[index++] = static_cast<char16_t>(image(i, j)[0] * max_value);
+							if (max_value < 256)
+							{
+								cbuffer[index++] = static_cast<unsigned char>(to_sample(image(i, j)[0], max_value));
+							}
+							else
+							{
+								wbuffer[index++] = static_cast<char16_t>(to_sample(image(i, j)[0], max_value));
+							}
 						}
 					}
-				}
 
-				// Save to file
-				stream.write(buffer.data(), buffer.size());
+					write_chunk(stream, buffer.data(), rows * row_size);
+				}
 			}
 
 			void save_ppm(std::ofstream& stream, const cg::image<cg::color_space_t::RGB>& image, const unsigned int max_value)
 			{
-				// Create buffer
-				std::vector<char> buffer(3 * image.get_width() * image.get_height() * ((max_value >= 256) ? 2 : 1));
+				// Write image in chunks of whole rows
+				const std::size_t row_size = 3 * image.get_width() * ((max_value >= 256) ? 2 : 1);
+				const std::size_t chunk_rows = rows_per_chunk(row_size);
+
+				std::vector<char> buffer(std::min(chunk_rows, image.get_height()) * row_size);
 				auto* cbuffer = reinterpret_cast<unsigned char*>(buffer.data());
 				auto* wbuffer = reinterpret_cast<char16_t*>(buffer.data());
 
-				std::size_t index = 0;
-
-				for (unsigned int j = 0; j < image.get_height(); ++j)
+				for (std::size_t first_row = 0; first_row < image.get_height(); first_row += chunk_rows)
 				{
-					for (unsigned int i = 0; i < image.get_width(); ++i)
+					const std::size_t rows = std::min(chunk_rows, image.get_height() - first_row);
+
+					std::size_t index = 0;
+
+					for (std::size_t j = first_row; j < first_row + rows; ++j)
 					{
-						if (max_value < 256)
+						for (std::size_t i = 0; i < image.get_width(); ++i)
 						{
-							cbuffer[index++] = static_cast<unsigned char>(image(i, j)[0] * max_value);
-							cbuffer[index++] = static_cast<unsigned char>(image(i, j)[1] * max_value);
-							cbuffer[index++] = static_cast<unsigned char>(image(i, j)[2] * max_value);
+							if (max_value < 256)
+							{
+								cbuffer[index++] = static_cast<unsigned char>(to_sample(image(i, j)[0], max_value));
+								cbuffer[index++] = static_cast<unsigned char>(to_sample(image(i, j)[1], max_value));
+								cbuffer[index++] = static_cast<unsigned char>(to_sample(image(i, j)[2], max_value));
+							}
+							else
+							{
+								wbuffer[index++] = static_cast<char16_t>(to_sample(image(i, j)[0], max_value));
+								wbuffer[index++] = static_cast<char16_t>(to_sample(image(i, j)[1], max_value));
+								wbuffer[index++] = static_cast<char16_t>(to_sample(image(i, j)[2], max_value));
+							}
 						}
-						else
+					}
+
+					write_chunk(stream, buffer.data(), rows * row_size);
+				}
+			}
+
+			void save_pam(std::ofstream& stream, const cg::image<cg::color_space_t::RGBA>& image, const unsigned int max_value)
+			{
+				// Write image in chunks of whole rows
+				const std::size_t row_size = 4 * image.get_width() * ((max_value >= 256) ? 2 : 1);
+				const std::size_t chunk_rows = rows_per_chunk(row_size);
+
+				std::vector<char> buffer(std::min(chunk_rows, image.get_height()) * row_size);
+				auto* cbuffer = reinterpret_cast<unsigned char*>(buffer.data());
+				auto* wbuffer = reinterpret_cast<char16_t*>(buffer.data());
+
+				const auto quantize = [max_value](const float value)
+				{
+					return static_cast<unsigned int>(std::min(std::max(value, 0.0f), 1.0f) * static_cast<float>(max_value) + 0.5f);
+				};
+
+				for (std::size_t first_row = 0; first_row < image.get_height(); first_row += chunk_rows)
+				{
+					const std::size_t rows = std::min(chunk_rows, image.get_height() - first_row);
+
+					std::size_t index = 0;
+
+					for (std::size_t j = first_row; j < first_row + rows; ++j)
+					{
+						for (std::size_t i = 0; i < image.get_width(); ++i)
 						{
-							wbuffer[index++] = static_cast<char16_t>(image(i, j)[0] * max_value);
-							wbuffer[index++] = static_cast<char16_t>(image(i, j)[1] * max_value);
-							wbuffer[index++] = static_cast<char16_t>(image(i, j)[2] * max_value);
+							const auto& pixel = image(i, j);
+							const float factor = (pixel[3] > 0.0f) ? 1.0f / pixel[3] : 0.0f;
+
+							const std::array<unsigned int, 4> values = {{ quantize(pixel[0] * factor), quantize(pixel[1] * factor), quantize(pixel[2] * factor), quantize(pixel[3]) }};
+
+							for (const auto value : values)
+							{
+								if (max_value < 256)
+								{
+									cbuffer[index++] = static_cast<unsigned char>(value);
+								}
+								else
+								{
+									wbuffer[index++] = static_cast<char16_t>(value);
+								}
+							}
 						}
 					}
+
+					write_chunk(stream, buffer.data(), rows * row_size);
 				}
+			}
 
-				// Save to file
-				stream.write(buffer.data(), buffer.size());
+			unsigned int to_sample(const float value, const unsigned int max_value)
+			{
+				return static_cast<unsigned int>(std::min(std::max(value, 0.0f), 1.0f) * static_cast<float>(max_value));
 			}
 
-			unsigned int read_value(std::ifstream& stream)
+			std::size_t read_value(std::ifstream& stream)
 			{
 				std::vector<char> buffer;
 				char next_char;
@@ -587,7 +983,240 @@ namespace cg
 				}
 
 				std::string buffer_string(buffer.begin(), buffer.end());
-				return static_cast<unsigned int>(std::stoul(buffer_string));
+				const auto value = std::stoull(buffer_string);
+
+				if (value > std::numeric_limits<std::size_t>::max())
+				{
+					throw std::runtime_error("Value out of range");
+				}
+
+				return static_cast<std::size_t>(value);
+			}
+
+			std::size_t checked_multiply(const std::size_t lhs, const std::size_t rhs)
+			{
+				if (lhs != 0 && rhs > std::numeric_limits<std::size_t>::max() / lhs)
+				{
+					throw std::runtime_error("Image dimensions too large");
+				}
+
+				return lhs * rhs;
+			}
+
+			std::size_t rows_per_chunk(const std::size_t row_size)
+			{
+				return (row_size == 0 || row_size >= io_chunk_size) ? 1 : io_chunk_size / row_size;
+			}
+
+			void read_chunk(std::ifstream& stream, char* buffer, const std::size_t size)
+			{
+				// Split into pieces that are representable as std::streamsize
+				for (std::size_t offset = 0; offset < size; offset += io_chunk_size)
+				{
+					const std::size_t count = std::min(io_chunk_size, size - offset);
+					stream.read(buffer + offset, static_cast<std::streamsize>(count));
+
+					if (static_cast<std::size_t>(stream.gcount()) != count)
+					{
+						throw std::runtime_error("Unexpected end of file");
+					}
+				}
+			}
+
+			void write_chunk(std::ofstream& stream, const char* buffer, const std::size_t size)
+			{
+				for (std::size_t offset = 0; offset < size; offset += io_chunk_size)
+				{
+					const std::size_t count = std::min(io_chunk_size, size - offset);
+					stream.write(buffer + offset, static_cast<std::streamsize>(count));
+
+					if (!stream.good())
+					{
+						throw std::runtime_error("Unable to write file");
+					}
+				}
+			}
+
+			row_reader::row_reader(std::ifstream& stream, const header& file_header, const std::size_t channels) :
+				stream(stream), file_header(file_header), row_values(file_header.width * channels),
+				binary(file_header.file_type == header::file_t::PGM || file_header.file_type == header::file_t::PPM),
+				wide(file_header.max_value >= 256), chunk_rows(0), buffered_rows(0), next_row(0), rows_read(0)
+			{
+				if (this->binary)
+				{
+					this->chunk_rows = std::min(rows_per_chunk(this->row_values * (this->wide ? 2 : 1)), file_header.height);
+					this->buffer.resize(this->chunk_rows * this->row_values * (this->wide ? 2 : 1));
+				}
+			}
+
+			void row_reader::read(float* row)
+			{
+				const float scale = 1.0f / static_cast<float>(this->file_header.max_value);
+
+				if (!this->binary)
+				{
+					for (std::size_t index = 0; index < this->row_values; ++index)
+					{
+						row[index] = static_cast<float>(read_value(this->stream)) * scale;
+					}
+
+					return;
+				}
+
+				if (this->next_row == this->buffered_rows)
+				{
+					const std::size_t row_size = this->row_values * (this->wide ? 2 : 1);
+					this->buffered_rows = std::min(this->chunk_rows, this->file_header.height - this->rows_read);
+					read_chunk(this->stream, this->buffer.data(), this->buffered_rows * row_size);
+
+					this->rows_read += this->buffered_rows;
+					this->next_row = 0;
+				}
+
+				if (this->wide)
+				{
+					const auto* values = reinterpret_cast<const char16_t*>(this->buffer.data()) + this->next_row * this->row_values;
+
+					for (std::size_t index = 0; index < this->row_values; ++index)
+					{
+						row[index] = static_cast<float>(values[index]) * scale;
+					}
+				}
+				else
+				{
+					const auto* values = reinterpret_cast<const unsigned char*>(this->buffer.data()) + this->next_row * this->row_values;
+
+					for (std::size_t index = 0; index < this->row_values; ++index)
+					{
+						row[index] = static_cast<float>(values[index]) * scale;
+					}
+				}
+
+				++this->next_row;
+			}
+
+			area_weights compute_area_weights(const std::size_t source_size, const std::size_t target_size)
+			{
+				// Target pixel i covers the source interval [i * scale, (i + 1) * scale)
+				const double scale = static_cast<double>(source_size) / static_cast<double>(target_size);
+
+				area_weights weights;
+				weights.offsets.reserve(target_size + 1);
+				weights.offsets.push_back(0);
+
+				for (std::size_t position = 0; position < target_size; ++position)
+				{
+					const double begin = static_cast<double>(position) * scale;
+					const double end = std::min(static_cast<double>(position + 1) * scale, static_cast<double>(source_size));
+
+					for (auto index = static_cast<std::size_t>(begin); index < source_size && static_cast<double>(index) < end; ++index)
+					{
+						const double coverage = std::min(static_cast<double>(index + 1), end) - std::max(static_cast<double>(index), begin);
+
+						if (coverage > 0.0)
+						{
+							weights.indices.push_back(index);
+							weights.weights.push_back(static_cast<float>(coverage / scale));
+						}
+					}
+
+					weights.offsets.push_back(weights.indices.size());
+				}
+
+				return weights;
+			}
+
+			template <color_space_t color_space>
+			image<color_space> load_shrunk(std::ifstream& stream, const header& header, const std::size_t width, const std::size_t height)
+			{
+				if (width == 0 || height == 0 || width > header.width || height > header.height)
+				{
+					throw std::runtime_error("Target size must be between one pixel and the image size");
+				}
+
+				const std::size_t channels = color_channels<color_space>::value;
+				const std::size_t row_values = width * channels;
+
+				const auto columns = compute_area_weights(header.width, width);
+				const auto rows = compute_area_weights(header.height, height);
+
+				image<color_space> shrunk(width, height);
+				auto* target = shrunk.get_values();
+
+				row_reader reader(stream, header, channels);
+				std::vector<float> source_row(header.width * channels);
+				std::vector<float> reduced_row(row_values);
+
+				// A source row contributes to at most two target rows: the current one and the next
+				std::vector<float> current(row_values, 0.0f);
+				std::vector<float> next(row_values, 0.0f);
+
+				std::size_t y = 0;
+
+				for (std::size_t j = 0; j < header.height; ++j)
+				{
+					reader.read(source_row.data());
+
+					// Average horizontally
+					for (std::size_t x = 0; x < width; ++x)
+					{
+						float* out = reduced_row.data() + x * channels;
+						std::fill(out, out + channels, 0.0f);
+
+						for (std::size_t entry = columns.offsets[x]; entry < columns.offsets[x + 1]; ++entry)
+						{
+							const float weight = columns.weights[entry];
+							const float* in = source_row.data() + columns.indices[entry] * channels;
+
+							for (std::size_t channel = 0; channel < channels; ++channel)
+							{
+								out[channel] += weight * in[channel];
+							}
+						}
+					}
+
+					// Accumulate vertically into the target rows covering source row j
+					for (std::size_t target_row = y; target_row < std::min(y + 2, height); ++target_row)
+					{
+						auto& accumulator = (target_row == y) ? current : next;
+
+						for (std::size_t entry = rows.offsets[target_row]; entry < rows.offsets[target_row + 1]; ++entry)
+						{
+							if (rows.indices[entry] == j)
+							{
+								const float weight = rows.weights[entry];
+
+								for (std::size_t index = 0; index < row_values; ++index)
+								{
+									accumulator[index] += weight * reduced_row[index];
+								}
+							}
+						}
+					}
+
+					// Emit all target rows whose last source row has been read
+					while (y < height && rows.indices[rows.offsets[y + 1] - 1] == j)
+					{
+						std::copy(current.begin(), current.end(), target + y * row_values);
+						std::swap(current, next);
+						std::fill(next.begin(), next.end(), 0.0f);
+						++y;
+					}
+				}
+
+				return shrunk;
+			}
+
+			std::size_t scaled_size(const std::size_t size, const float scale)
+			{
+				if (!(scale > 0.0f && scale <= 1.0f))
+				{
+					throw std::runtime_error("Scale factor must be in (0, 1]");
+				}
+
+				const auto scaled = static_cast<std::size_t>(static_cast<double>(size) * static_cast<double>(scale) + 0.5);
+
+				return std::max(std::min(scaled, size), std::size_t(1));
 			}
 		}
 	}
@@ -595,6 +1224,8 @@ namespace cg
 
 std::shared_ptr<cg::image_base> cg::image_io::load_image(const std::string& path)
 {
+	CG_IMAGE_OPERATION("image_io::load_image");
+
 	std::ifstream image_file(path, std::iostream::in | std::iostream::binary);
 
 	if (image_file.is_open() && image_file.good())
@@ -617,6 +1248,14 @@ std::shared_ptr<cg::image_base> cg::image_io::load_image(const std::string& path
 		case cg::image_io::header::PLAIN_PPM:
 		case cg::image_io::header::PPM:
 			return std::make_shared<cg::image<cg::color_space_t::RGB>>(load_rgb_image(path));
+
+			break;
+		case cg::image_io::header::PAM:
+			return std::make_shared<cg::image<cg::color_space_t::RGBA>>(load_rgba_image(path));
+
+			break;
+		default:
+			break;
 		}
 
 		throw std::runtime_error("Unknown image file format");
@@ -627,9 +1266,12 @@ std::shared_ptr<cg::image_base> cg::image_io::load_image(const std::string& path
 
 void cg::image_io::save_image(const std::string& path, const std::shared_ptr<cg::image_base>& image, bool double_prec, const bool plain)
 {
+	CG_IMAGE_OPERATION("image_io::save_image");
+
 	const auto* bw_image = dynamic_cast<cg::image<cg::color_space_t::BW>*>(image.get());
 	const auto* gray_image = dynamic_cast<cg::image<cg::color_space_t::Gray>*>(image.get());
 	const auto* rgb_image = dynamic_cast<cg::image<cg::color_space_t::RGB>*>(image.get());
+	const auto* rgba_image = dynamic_cast<cg::image<cg::color_space_t::RGBA>*>(image.get());
 
 	if (bw_image != nullptr)
 	{
@@ -643,10 +1285,16 @@ void cg::image_io::save_image(const std::string& path, const std::shared_ptr<cg:
 	{
 		save_rgb_image(path, *rgb_image, double_prec, plain);
 	}
+	else if (rgba_image != nullptr)
+	{
+		save_rgba_image(path, *rgba_image, double_prec);
+	}
 }
 
 cg::image<cg::color_space_t::BW> cg::image_io::load_bw_image(const std::string& path)
 {
+	CG_IMAGE_OPERATION("image_io::load_bw_image");
+
 	std::ifstream image_file(path, std::iostream::in | std::iostream::binary);
 
 	if (image_file.is_open() && image_file.good())
@@ -670,6 +1318,8 @@ cg::image<cg::color_space_t::BW> cg::image_io::load_bw_image(const std::string&
 
 cg::image<cg::color_space_t::Gray> cg::image_io::load_grayscale_image(const std::string& path)
 {
+	CG_IMAGE_OPERATION("image_io::load_grayscale_image");
+
 	std::ifstream image_file(path, std::iostream::in | std::iostream::binary);
 
 	if (image_file.is_open() && image_file.good())
@@ -693,6 +1343,8 @@ cg::image<cg::color_space_t::Gray> cg::image_io::load_grayscale_image(const std:
 
 cg::image<cg::color_space_t::RGB> cg::image_io::load_rgb_image(const std::string& path)
 {
+	CG_IMAGE_OPERATION("image_io::load_rgb_image");
+
 	std::ifstream image_file(path, std::iostream::in | std::iostream::binary);
 
 	if (image_file.is_open() && image_file.good())
@@ -714,8 +1366,115 @@ cg::image<cg::color_space_t::RGB> cg::image_io::load_rgb_image(const std::string
 	throw std::runtime_error("Unable to open file");
 }
 
+cg::image<cg::color_space_t::RGBA> cg::image_io::load_rgba_image(const std::string& path)
+{
+	CG_IMAGE_OPERATION("image_io::load_rgba_image");
+
+	std::ifstream image_file(path, std::iostream::in | std::iostream::binary);
+
+	if (image_file.is_open() && image_file.good())
+	{
+		auto header = load_header(image_file);
+
+		if (header.file_type == cg::image_io::header::PAM)
+		{
+			return load_pam(image_file, header);
+		}
+
+		throw std::runtime_error("RGBA images can only be loaded from PAM files");
+	}
+
+	throw std::runtime_error("Unable to open file");
+}
+
+cg::image<cg::color_space_t::Gray> cg::image_io::load_grayscale_image(const std::string& path, const std::size_t width, const std::size_t height)
+{
+	CG_IMAGE_OPERATION("image_io::load_grayscale_image");
+
+	std::ifstream image_file(path, std::iostream::in | std::iostream::binary);
+
+	if (image_file.is_open() && image_file.good())
+	{
+		auto header = load_header(image_file);
+
+		if (header.file_type == cg::image_io::header::PGM || header.file_type == cg::image_io::header::PLAIN_PGM)
+		{
+			return load_shrunk<cg::color_space_t::Gray>(image_file, header, width, height);
+		}
+
+		throw std::runtime_error("Grayscale images can only be loaded from PGM files");
+	}
+
+	throw std::runtime_error("Unable to open file");
+}
+
+cg::image<cg::color_space_t::Gray> cg::image_io::load_grayscale_image(const std::string& path, const float scale)
+{
+	CG_IMAGE_OPERATION("image_io::load_grayscale_image");
+
+	std::ifstream image_file(path, std::iostream::in | std::iostream::binary);
+
+	if (image_file.is_open() && image_file.good())
+	{
+		auto header = load_header(image_file);
+
+		if (header.file_type == cg::image_io::header::PGM || header.file_type == cg::image_io::header::PLAIN_PGM)
+		{
+			return load_shrunk<cg::color_space_t::Gray>(image_file, header, scaled_size(header.width, scale), scaled_size(header.height, scale));
+		}
+
+		throw std::runtime_error("Grayscale images can only be loaded from PGM files");
+	}
+
+	throw std::runtime_error("Unable to open file");
+}
+
+cg::image<cg::color_space_t::RGB> cg::image_io::load_rgb_image(const std::string& path, const std::size_t width, const std::size_t height)
+{
+	CG_IMAGE_OPERATION("image_io::load_rgb_image");
+
+	std::ifstream image_file(path, std::iostream::in | std::iostream::binary);
+
+	if (image_file.is_open() && image_file.good())
+	{
+		auto header = load_header(image_file);
+
+		if (header.file_type == cg::image_io::header::PPM || header.file_type == cg::image_io::header::PLAIN_PPM)
+		{
+			return load_shrunk<cg::color_space_t::RGB>(image_file, header, width, height);
+		}
+
+		throw std::runtime_error("RGB images can only be loaded from PPM files");
+	}
+
+	throw std::runtime_error("Unable to open file");
+}
+
+cg::image<cg::color_space_t::RGB> cg::image_io::load_rgb_image(const std::string& path, const float scale)
+{
+	CG_IMAGE_OPERATION("image_io::load_rgb_image");
+
+	std::ifstream image_file(path, std::iostream::in | std::iostream::binary);
+
+	if (image_file.is_open() && image_file.good())
+	{
+		auto header = load_header(image_file);
+
+		if (header.file_type == cg::image_io::header::PPM || header.file_type == cg::image_io::header::PLAIN_PPM)
+		{
+			return load_shrunk<cg::color_space_t::RGB>(image_file, header, scaled_size(header.width, scale), scaled_size(header.height, scale));
+		}
+
+		throw std::runtime_error("RGB images can only be loaded from PPM files");
+	}
+
+	throw std::runtime_error("Unable to open file");
+}
+
 void cg::image_io::save_bw_image(const std::string& path, const cg::image<cg::color_space_t::BW>& image, const bool plain)
 {
+	CG_IMAGE_OPERATION("image_io::save_bw_image");
+
 	std::ofstream image_file(path, std::iostream::out | std::iostream::binary);
 
 	if (image_file.is_open() && image_file.good())
@@ -736,6 +1495,8 @@ void cg::image_io::save_bw_image(const std::string& path, const cg::image<cg::co
 
 void cg::image_io::save_grayscale_image(const std::string& path, const cg::image<cg::color_space_t::Gray>& image, bool double_prec, const bool plain)
 {
+	CG_IMAGE_OPERATION("image_io::save_grayscale_image");
+
 	std::ofstream image_file(path, std::iostream::out | std::iostream::binary);
 
 	if (image_file.is_open() && image_file.good())
@@ -744,7 +1505,7 @@ void cg::image_io::save_grayscale_image(const std::string& path, const cg::image
 		header.file_type = plain ? cg::image_io::header::PLAIN_PGM : cg::image_io::header::PGM;
 		header.width = image.get_width();
 		header.height = image.get_height();
-		header.max_value = double_prec ? 65535 : 255;
+		header.max_value = (double_prec && !plain) ? 65535 : 255;
 
 		save_header(image_file, header);
 		plain ? save_plain_pgm(image_file, image) : save_pgm(image_file, image, header.max_value);
@@ -757,6 +1518,8 @@ void cg::image_io::save_grayscale_image(const std::string& path, const cg::image
 
 void cg::image_io::save_rgb_image(const std::string& path, const cg::image<cg::color_space_t::RGB>& image, bool double_prec, const bool plain)
 {
+	CG_IMAGE_OPERATION("image_io::save_rgb_image");
+
 	std::ofstream image_file(path, std::iostream::out | std::iostream::binary);
 
 	if (image_file.is_open() && image_file.good())
@@ -765,7 +1528,7 @@ void cg::image_io::save_rgb_image(const std::string& path, const cg::image<cg::c
 		header.file_type = plain ? cg::image_io::header::PLAIN_PPM : cg::image_io::header::PPM;
 		header.width = image.get_width();
 		header.height = image.get_height();
-		header.max_value = double_prec ? 65535 : 255;
+		header.max_value = (double_prec && !plain) ? 65535 : 255;
 
 		save_header(image_file, header);
 		plain ? save_plain_ppm(image_file, image) : save_ppm(image_file, image, header.max_value);
@@ -775,3 +1538,27 @@ void cg::image_io::save_rgb_image(const std::string& path, const cg::image<cg::c
 		throw std::runtime_error("Unable to open file");
 	}
 }
+
+void cg::image_io::save_rgba_image(const std::string& path, const cg::image<cg::color_space_t::RGBA>& image, const bool double_prec)
+{
+	CG_IMAGE_OPERATION("image_io::save_rgba_image");
+
+	std::ofstream image_file(path, std::iostream::out | std::iostream::binary);
+
+	if (image_file.is_open() && image_file.good())
+	{
+		cg::image_io::header header;
+		header.file_type = cg::image_io::header::PAM;
+		header.width = image.get_width();
+		header.height = image.get_height();
+		header.max_value = double_prec ? 65535 : 255;
+		header.depth = 4;
+
+		save_header(image_file, header);
+		save_pam(image_file, image, header.max_value);
+	}
+	else
+	{
+		throw std::runtime_error("Unable to open file");
+	}
+}
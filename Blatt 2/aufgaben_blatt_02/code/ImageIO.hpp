@@ -2,6 +2,7 @@
 
 #include "Image.hpp"
 
+#include <cstddef>
 #include <fstream>
 #include <memory>
 #include <string>
@@ -14,6 +15,7 @@ namespace cg
 	/// PBM: Netpbm bi-level image format (http://netpbm.sourceforge.net/doc/pbm.html)
 	/// PGM: Netpbm grayscale image format (http://netpbm.sourceforge.net/doc/pgm.html)
 	/// PPM: Netpbm color image format (http://netpbm.sourceforge.net/doc/ppm.html)
+	/// PAM: Netpbm arbitrary map format, used for RGBA images (http://netpbm.sourceforge.net/doc/pam.html)
 	/// </summary>
 	namespace image_io
 	{
@@ -54,6 +56,52 @@ namespace cg
 		/// <returns>RGB image</returns>
 		image<color_space_t::RGB> load_rgb_image(const std::string& path);
 
+		/// <summary>
+		/// Load RGBA image from file
+		/// Files without alpha channel are loaded as opaque; the color is premultiplied by alpha.
+		/// </summary>
+		/// <param name="path">Path to image file</param>
+		/// <returns>RGBA image</returns>
+		image<color_space_t::RGBA> load_rgba_image(const std::string& path);
+
+		/// <summary>
+		/// Load grayscale image from file, shrinking it to the given size while reading
+		/// Each target pixel is the area-weighted average of the source pixels it covers;
+		/// the full-resolution image is never held in memory.
+		/// </summary>
+		/// <param name="path">Path to image file</param>
+		/// <param name="width">Target width (at most the image width)</param>
+		/// <param name="height">Target height (at most the image height)</param>
+		/// <returns>Shrunk grayscale image</returns>
+		image<color_space_t::Gray> load_grayscale_image(const std::string& path, std::size_t width, std::size_t height);
+
+		/// <summary>
+		/// Load grayscale image from file, shrinking it by a factor while reading
+		/// </summary>
+		/// <param name="path">Path to image file</param>
+		/// <param name="scale">Scale factor in (0, 1]</param>
+		/// <returns>Shrunk grayscale image</returns>
+		image<color_space_t::Gray> load_grayscale_image(const std::string& path, float scale);
+
+		/// <summary>
+		/// Load RGB image from file, shrinking it to the given size while reading
+		/// Each target pixel is the area-weighted average of the source pixels it covers;
+		/// the full-resolution image is never held in memory.
+		/// </summary>
+		/// <param name="path">Path to image file</param>
+		/// <param name="width">Target width (at most the image width)</param>
+		/// <param name="height">Target height (at most the image height)</param>
+		/// <returns>Shrunk RGB image</returns>
+		image<color_space_t::RGB> load_rgb_image(const std::string& path, std::size_t width, std::size_t height);
+
+		/// <summary>
+		/// Load RGB image from file, shrinking it by a factor while reading
+		/// </summary>
+		/// <param name="path">Path to image file</param>
+		/// <param name="scale">Scale factor in (0, 1]</param>
+		/// <returns>Shrunk RGB image</returns>
+		image<color_space_t::RGB> load_rgb_image(const std::string& path, float scale);
+
 		/// <summary>
 		/// Save black and white image to file
 		/// </summary>
@@ -80,5 +128,13 @@ namespace cg
 		/// <param name="double_prec">65536 colors instead of 256</param>
 		/// <param name="plain">Plain or binary</param>
 		void save_rgb_image(const std::string& path, const image<color_space_t::RGB>& image, bool double_prec = false, bool plain = false);
+
+		/// <summary>
+		/// Save RGBA image to file
+		/// </summary>
+		/// <param name="path">Path to image file</param>
+		/// <param name="image">RGBA image</param>
+		/// <param name="double_prec">65536 colors instead of 256</param>
+		void save_rgba_image(const std::string& path, const image<color_space_t::RGBA>& image, bool double_prec = false);
 	}
 }
\ No newline at end of file
@@ -1,6 +1,12 @@
 #pragma once
 
 #include "Image.hpp"
+#include "ImageAllocations.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
 
 namespace cg
 {
@@ -10,11 +16,196 @@ namespace cg
 	class image_manipulation
 	{
 	public:
+		/// <summary>
+		/// Parameters of the color-key effect
+		/// Hues are given in degrees, all other values are factors applied to saturation and value.
+		/// The defaults produce the effect for the lena example.
+		/// </summary>
+		struct color_key_parameters
+		{
+			/// Rotation of the hue
+			float hue_shift = 30.f;
+
+			/// Window of (shifted) hues that keep their color
+			float hue_min = 50.f;
+			float hue_max = 100.f;
+
+			/// Factors for pixels inside the hue window
+			float key_saturation = 0.9f;
+			float key_value = 0.7f;
+
+			/// Factors for all other pixels
+			float other_saturation = 0.f;
+			float other_value = 0.8f;
+		};
+
 		/// <summary>
 		/// Creates a Color-Key-Effect image from the lena example
 		/// </summary>
 		/// <param name="original">Original image</param>
 		/// <returns>Modified image</returns>
 		static image<color_space_t::HSV> modify_in_hsv(const image<color_space_t::HSV>& original);
+
+		/// <summary>
+		/// Creates a Color-Key-Effect image
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="parameters">Effect parameters</param>
+		/// <returns>Modified image</returns>
+		static image<color_space_t::HSV> color_key(const image<color_space_t::HSV>& original, const color_key_parameters& parameters);
+
+		/// <summary>
+		/// Apply the color-key effect to a single pixel
+		/// </summary>
+		/// <param name="pixel">Original pixel</param>
+		/// <param name="parameters">Effect parameters</param>
+		/// <returns>Modified pixel</returns>
+		static image<color_space_t::HSV>::tuple_type color_key_pixel(const image<color_space_t::HSV>::tuple_type& pixel, const color_key_parameters& parameters);
+
+		/// <summary>
+		/// Apply a function to every pixel, keeping the color space
+		/// Pixels are processed in parallel; the function must be thread-safe.
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="function">Function mapping a pixel (tuple) to the new pixel</param>
+		/// <returns>Modified image</returns>
+		template <color_space_t color_space, typename function_t>
+		static image<color_space> map(const image<color_space>& original, function_t function);
+
+		/// <summary>
+		/// Apply a function to every pixel, producing an image of another color space
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="function">Function mapping a pixel (tuple) to a pixel of the target color space</param>
+		/// <returns>Converted image</returns>
+		template <color_space_t out, color_space_t in, typename function_t>
+		static image<out> map_to(const image<in>& original, function_t function);
+
+		/// <summary>
+		/// Combine two images of the same size pixel by pixel
+		/// </summary>
+		/// <param name="first">First image, determines the color space of the result</param>
+		/// <param name="second">Second image</param>
+		/// <param name="function">Function mapping two pixels to the new pixel</param>
+		/// <returns>Combined image</returns>
+		template <color_space_t color_space, color_space_t other_color_space, typename function_t>
+		static image<color_space> zip_map(const image<color_space>& first, const image<other_color_space>& second, function_t function);
+
+		/// <summary>
+		/// Reduce all pixels to a single value
+		/// Pixels are accumulated in fixed-size blocks whose partial results are combined in order,
+		/// so the result does not depend on the number of threads.
+		/// </summary>
+		/// <param name="original">Image</param>
+		/// <param name="identity">Neutral element of the reduction</param>
+		/// <param name="accumulate">Function (value, pixel) returning the updated value</param>
+		/// <param name="combine">Function (value, value) merging two partial results</param>
+		/// <returns>Reduced value</returns>
+		template <typename value_t, color_space_t color_space, typename accumulate_t, typename combine_t>
+		static value_t reduce(const image<color_space>& original, value_t identity, accumulate_t accumulate, combine_t combine);
+
+	private:
+		/// Minimum number of pixels processed by one task
+		static constexpr std::size_t parallel_grain = 16384;
+	};
+}
+
+template <cg::color_space_t color_space, typename function_t>
+inline cg::image<color_space> cg::image_manipulation::map(const image<color_space>& original, function_t function)
+{
+	CG_IMAGE_OPERATION("image_manipulation::map");
+
+	return map_to<color_space>(original, function);
+}
+
+template <cg::color_space_t out, cg::color_space_t in, typename function_t>
+inline cg::image<out> cg::image_manipulation::map_to(const image<in>& original, function_t function)
+{
+	CG_IMAGE_OPERATION("image_manipulation::map_to");
+
+	image<out> mapped(original.get_width(), original.get_height());
+
+	const auto* source = original.get_data().data();
+	auto* target = mapped.get_data().data();
+
+	// Flat loop over the storage: the tuple size is a compile-time constant, so the
+	// function is inlined and the loop can be vectorized by the compiler
+	thread_pool::shared().parallel_for(0, original.get_data().size(), parallel_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		for (std::size_t index = first; index < last; ++index)
+		{
+			target[index] = function(source[index]);
+		}
+	});
+
+	return mapped;
+}
+
+template <cg::color_space_t color_space, cg::color_space_t other_color_space, typename function_t>
+inline cg::image<color_space> cg::image_manipulation::zip_map(const image<color_space>& first, const image<other_color_space>& second, function_t function)
+{
+	CG_IMAGE_OPERATION("image_manipulation::zip_map");
+
+	if (first.get_width() != second.get_width() || first.get_height() != second.get_height())
+	{
+		throw std::runtime_error("Image sizes do not match");
+	}
+
+	image<color_space> mapped(first.get_width(), first.get_height());
+
+	const auto* first_source = first.get_data().data();
+	const auto* second_source = second.get_data().data();
+	auto* target = mapped.get_data().data();
+
+	thread_pool::shared().parallel_for(0, first.get_data().size(), parallel_grain, [&](const std::size_t begin, const std::size_t end)
+	{
+		for (std::size_t index = begin; index < end; ++index)
+		{
+			target[index] = function(first_source[index], second_source[index]);
+		}
+	});
+
+	return mapped;
+}
+
+template <typename value_t, cg::color_space_t color_space, typename accumulate_t, typename combine_t>
+inline value_t cg::image_manipulation::reduce(const image<color_space>& original, const value_t identity, accumulate_t accumulate, combine_t combine)
+{
+	CG_IMAGE_OPERATION("image_manipulation::reduce");
+
+	const auto* source = original.get_data().data();
+	const std::size_t size = original.get_data().size();
+	const std::size_t blocks = (size + parallel_grain - 1) / parallel_grain;
+
+	// Wrapped, so that std::vector<bool> cannot pack the results of concurrent blocks into shared words
+	struct partial_t
+	{
+		value_t value;
 	};
+
+	std::vector<partial_t> partial(blocks, partial_t{identity});
+
+	thread_pool::shared().run(blocks, [&](const std::size_t block)
+	{
+		const std::size_t first = block * parallel_grain;
+		const std::size_t last = (first + parallel_grain < size) ? first + parallel_grain : size;
+
+		value_t value = identity;
+
+		for (std::size_t index = first; index < last; ++index)
+		{
+			value = accumulate(value, source[index]);
+		}
+
+		partial[block].value = value;
+	});
+
+	value_t result = identity;
+
+	for (const auto& block : partial)
+	{
+		result = combine(result, block.value);
+	}
+
+	return result;
 }
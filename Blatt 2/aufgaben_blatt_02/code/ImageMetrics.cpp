@@ -0,0 +1,277 @@
+#include "ImageMetrics.hpp"
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace cg
+{
+	namespace
+	{
+		/// Number of values reduced into one partial sum; partial sums are then added pairwise
+		constexpr std::size_t block_size = 4096;
+
+		/// Minimum number of blocks reduced by one task
+		constexpr std::size_t block_grain = 16;
+
+		/// Number of SSIM window rows whose sums are updated incrementally before they are recomputed
+		constexpr std::size_t row_block = 16;
+
+		/// Number of independent accumulators in the inner loops
+		constexpr std::size_t lanes = 8;
+
+		/// SSIM stabilization constants (0.01 * peak)^2 and (0.03 * peak)^2 for a peak value of 1
+		constexpr double ssim_c1 = 0.0001;
+		constexpr double ssim_c2 = 0.0009;
+
+		/// <summary>
+		/// Add values pairwise (the rounding error grows with log(count) instead of count)
+		/// </summary>
+		/// <param name="values">Values</param>
+		/// <param name="count">Number of values</param>
+		/// <returns>Sum</returns>
+		double pairwise_sum(const double* values, const std::size_t count)
+		{
+			if (count <= lanes)
+			{
+				double sum = 0.0;
+
+				for (std::size_t index = 0; index < count; ++index)
+				{
+					sum += values[index];
+				}
+
+				return sum;
+			}
+
+			const std::size_t half = count / 2;
+
+			return pairwise_sum(values, half) + pairwise_sum(values + half, count - half);
+		}
+
+		/// <summary>
+		/// Reduce two arrays block by block in parallel and add the block results pairwise
+		/// </summary>
+		/// <param name="count">Number of values</param>
+		/// <param name="reduce_block">Function computing the result of the values [first, last)</param>
+		/// <returns>Sum of the block results</returns>
+		template <typename block_function>
+		double blocked_sum(const std::size_t count, const block_function& reduce_block)
+		{
+			const std::size_t block_count = (count + block_size - 1) / block_size;
+			std::vector<double> block_sums(block_count);
+
+			thread_pool::shared().parallel_for(0, block_count, block_grain, [&](const std::size_t first, const std::size_t last)
+			{
+				for (std::size_t block = first; block < last; ++block)
+				{
+					block_sums[block] = reduce_block(block * block_size, std::min((block + 1) * block_size, count));
+				}
+			});
+
+			return pairwise_sum(block_sums.data(), block_sums.size());
+		}
+	}
+}
+
+constexpr std::size_t cg::image_metrics::ssim_window;
+
+double cg::image_metrics::to_psnr(const double mse)
+{
+	return (mse > 0.0) ? -10.0 * std::log10(mse) : std::numeric_limits<double>::infinity();
+}
+
+double cg::image_metrics::max_abs_diff(const float* first, const float* second, const std::size_t count)
+{
+	const std::size_t block_count = (count + block_size - 1) / block_size;
+	std::vector<float> block_maxima(block_count);
+
+	thread_pool::shared().parallel_for(0, block_count, block_grain, [&](const std::size_t first_block, const std::size_t last_block)
+	{
+		for (std::size_t block = first_block; block < last_block; ++block)
+		{
+			const std::size_t begin = block * block_size;
+			const std::size_t end = std::min(begin + block_size, count);
+
+			std::array<float, lanes> maxima = {};
+			std::size_t index = begin;
+
+			for (; index + lanes <= end; index += lanes)
+			{
+				for (std::size_t lane = 0; lane < lanes; ++lane)
+				{
+					maxima[lane] = std::max(maxima[lane], std::abs(first[index + lane] - second[index + lane]));
+				}
+			}
+
+			for (; index < end; ++index)
+			{
+				maxima[0] = std::max(maxima[0], std::abs(first[index] - second[index]));
+			}
+
+			block_maxima[block] = *std::max_element(maxima.begin(), maxima.end());
+		}
+	});
+
+	float maximum = 0.f;
+
+	for (const auto value : block_maxima)
+	{
+		maximum = std::max(maximum, value);
+	}
+
+	return static_cast<double>(maximum);
+}
+
+double cg::image_metrics::mse(const float* first, const float* second, const std::size_t count)
+{
+	if (count == 0)
+	{
+		return 0.0;
+	}
+
+	const double sum = blocked_sum(count, [&](const std::size_t begin, const std::size_t end)
+	{
+		std::array<double, lanes> sums = {};
+		std::size_t index = begin;
+
+		for (; index + lanes <= end; index += lanes)
+		{
+			for (std::size_t lane = 0; lane < lanes; ++lane)
+			{
+				const double difference = static_cast<double>(first[index + lane]) - static_cast<double>(second[index + lane]);
+				sums[lane] += difference * difference;
+			}
+		}
+
+		for (; index < end; ++index)
+		{
+			const double difference = static_cast<double>(first[index]) - static_cast<double>(second[index]);
+			sums[0] += difference * difference;
+		}
+
+		return pairwise_sum(sums.data(), sums.size());
+	});
+
+	return sum / static_cast<double>(count);
+}
+
+double cg::image_metrics::ssim(const float* first, const float* second, const std::size_t width, const std::size_t height, const std::size_t channels)
+{
+	if (width == 0 || height == 0 || channels == 0)
+	{
+		return 1.0;
+	}
+
+	const std::size_t window = std::min(ssim_window, std::min(width, height));
+	const std::size_t columns = width - window + 1;
+	const std::size_t rows = height - window + 1;
+	const double area = static_cast<double>(window * window);
+
+	// SSIM sum of each row of window positions, per channel
+	std::vector<double> row_sums(rows * channels);
+
+	// Row blocks are fixed, so that the rounding of the incremental sums does not depend on the number of threads
+	thread_pool::shared().parallel_for(0, (rows + row_block - 1) / row_block, 1, [&](const std::size_t first_block, const std::size_t last_block)
+	{
+		// Column sums of x, y, x^2, y^2 and xy over the window rows, for one channel at a time
+		std::vector<double> sum_x(width), sum_y(width), sum_xx(width), sum_yy(width), sum_xy(width);
+		std::vector<double> values(columns);
+
+		for (std::size_t block = first_block * channels; block < last_block * channels; ++block)
+		{
+			const std::size_t channel = block % channels;
+			const std::size_t first_row = (block / channels) * row_block;
+			const std::size_t last_row = std::min(first_row + row_block, rows);
+
+			const auto add_row = [&](const std::size_t j, const double sign)
+			{
+				const float* x = first + j * width * channels + channel;
+				const float* y = second + j * width * channels + channel;
+
+				for (std::size_t i = 0; i < width; ++i)
+				{
+					const double a = x[i * channels];
+					const double b = y[i * channels];
+
+					sum_x[i] += sign * a;
+					sum_y[i] += sign * b;
+					sum_xx[i] += sign * a * a;
+					sum_yy[i] += sign * b * b;
+					sum_xy[i] += sign * a * b;
+				}
+			};
+
+			std::fill(sum_x.begin(), sum_x.end(), 0.0);
+			std::fill(sum_y.begin(), sum_y.end(), 0.0);
+			std::fill(sum_xx.begin(), sum_xx.end(), 0.0);
+			std::fill(sum_yy.begin(), sum_yy.end(), 0.0);
+			std::fill(sum_xy.begin(), sum_xy.end(), 0.0);
+
+			for (std::size_t j = first_row; j < first_row + window; ++j)
+			{
+				add_row(j, 1.0);
+			}
+
+			for (std::size_t j = first_row; j < last_row; ++j)
+			{
+				// Slide the window down by one row
+				if (j > first_row)
+				{
+					add_row(j - 1, -1.0);
+					add_row(j + window - 1, 1.0);
+				}
+
+				double x = 0.0, y = 0.0, xx = 0.0, yy = 0.0, xy = 0.0;
+
+				for (std::size_t i = 0; i < window; ++i)
+				{
+					x += sum_x[i];
+					y += sum_y[i];
+					xx += sum_xx[i];
+					yy += sum_yy[i];
+					xy += sum_xy[i];
+				}
+
+				for (std::size_t i = 0; i < columns; ++i)
+				{
+					// Slide the window right by one column
+					if (i > 0)
+					{
+						x += sum_x[i + window - 1] - sum_x[i - 1];
+						y += sum_y[i + window - 1] - sum_y[i - 1];
+						xx += sum_xx[i + window - 1] - sum_xx[i - 1];
+						yy += sum_yy[i + window - 1] - sum_yy[i - 1];
+						xy += sum_xy[i + window - 1] - sum_xy[i - 1];
+					}
+
+					const double mean_x = x / area;
+					const double mean_y = y / area;
+					const double variance_x = std::max(xx / area - mean_x * mean_x, 0.0);
+					const double variance_y = std::max(yy / area - mean_y * mean_y, 0.0);
+					const double covariance = xy / area - mean_x * mean_y;
+
+					values[i] = ((2.0 * mean_x * mean_y + ssim_c1) * (2.0 * covariance + ssim_c2)) /
+						((mean_x * mean_x + mean_y * mean_y + ssim_c1) * (variance_x + variance_y + ssim_c2));
+				}
+
+				row_sums[channel * rows + j] = pairwise_sum(values.data(), values.size());
+			}
+		}
+	});
+
+	return pairwise_sum(row_sums.data(), row_sums.size()) / static_cast<double>(rows * columns * channels);
+}
+
+void cg::image_metrics::require_same_size(const image_base& first, const image_base& second)
+{
+	if (first.get_width() != second.get_width() || first.get_height() != second.get_height())
+	{
+		throw std::runtime_error("Images must have the same size");
+	}
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "Image.hpp"
+#include "ImageTraits.hpp"
+
+#include <cstddef>
+
+namespace cg
+{
+	/// <summary>
+	/// Result of comparing two images
+	/// </summary>
+	struct image_comparison
+	{
+		/// Largest absolute difference of any channel value (NaN values are only reflected by the other metrics)
+		double max_abs_diff;
+
+		/// Mean squared difference over all channel values
+		double mse;
+
+		/// Peak signal-to-noise ratio in dB for a peak value of 1 (infinity for identical images)
+		double psnr;
+
+		/// Mean structural similarity over all windows and channels (1 for identical images)
+		double ssim;
+	};
+
+	/// <summary>
+	/// Class for comparing images numerically
+	/// Sums are formed in double precision over fixed blocks of values whose partial sums are added
+	/// pairwise, so the results are stable for large images and do not depend on the number of threads.
+	/// The inner loops keep several independent accumulators and vectorize; blocks (or rows for SSIM)
+	/// are distributed over the shared thread pool.
+	/// </summary>
+	class image_metrics
+	{
+	public:
+		/// Edge length of the square SSIM window (clamped to the image size)
+		static constexpr std::size_t ssim_window = 7;
+
+		/// <summary>
+		/// Compute all metrics
+		/// </summary>
+		/// <param name="first">First image</param>
+		/// <param name="second">Second image of the same size</param>
+		/// <returns>Comparison</returns>
+		template <color_space_t color_space>
+		static image_comparison compare(const image<color_space>& first, const image<color_space>& second);
+
+		/// <summary>
+		/// Compute the largest absolute difference of any channel value
+		/// </summary>
+		/// <param name="first">First image</param>
+		/// <param name="second">Second image of the same size</param>
+		/// <returns>Maximum absolute difference</returns>
+		template <color_space_t color_space>
+		static double max_abs_diff(const image<color_space>& first, const image<color_space>& second);
+
+		/// <summary>
+		/// Compute the mean squared difference
+		/// </summary>
+		/// <param name="first">First image</param>
+		/// <param name="second">Second image of the same size</param>
+		/// <returns>Mean squared error</returns>
+		template <color_space_t color_space>
+		static double mse(const image<color_space>& first, const image<color_space>& second);
+
+		/// <summary>
+		/// Compute the peak signal-to-noise ratio for a peak value of 1
+		/// </summary>
+		/// <param name="first">First image</param>
+		/// <param name="second">Second image of the same size</param>
+		/// <returns>PSNR in dB (infinity for identical images)</returns>
+		template <color_space_t color_space>
+		static double psnr(const image<color_space>& first, const image<color_space>& second);
+
+		/// <summary>
+		/// Compute the structural similarity
+		/// Local means, variances and the covariance are taken over uniform square windows at every
+		/// position where the window fits into the image; channels are compared separately and averaged.
+		/// </summary>
+		/// <param name="first">First image</param>
+		/// <param name="second">Second image of the same size</param>
+		/// <returns>Mean SSIM</returns>
+		template <color_space_t color_space>
+		static double ssim(const image<color_space>& first, const image<color_space>& second);
+
+		/// <summary>
+		/// Convert a mean squared error to PSNR for a peak value of 1
+		/// </summary>
+		/// <param name="mse">Mean squared error</param>
+		/// <returns>PSNR in dB</returns>
+		static double to_psnr(double mse);
+
+	private:
+		/// <summary>
+		/// Largest absolute difference of two arrays
+		/// </summary>
+		/// <param name="first">First values</param>
+		/// <param name="second">Second values</param>
+		/// <param name="count">Number of values</param>
+		/// <returns>Maximum absolute difference</returns>
+		static double max_abs_diff(const float* first, const float* second, std::size_t count);
+
+		/// <summary>
+		/// Mean squared difference of two arrays
+		/// </summary>
+		/// <param name="first">First values</param>
+		/// <param name="second">Second values</param>
+		/// <param name="count">Number of values</param>
+		/// <returns>Mean squared difference</returns>
+		static double mse(const float* first, const float* second, std::size_t count);
+
+		/// <summary>
+		/// Mean SSIM of two interleaved images
+		/// </summary>
+		/// <param name="first">First pixel data</param>
+		/// <param name="second">Second pixel data</param>
+		/// <param name="width">Width</param>
+		/// <param name="height">Height</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		/// <returns>Mean SSIM</returns>
+		static double ssim(const float* first, const float* second, std::size_t width, std::size_t height, std::size_t channels);
+
+		/// <summary>
+		/// Make sure two images can be compared
+		/// </summary>
+		/// <param name="first">First image</param>
+		/// <param name="second">Second image</param>
+		static void require_same_size(const image_base& first, const image_base& second);
+	};
+}
+
+template <cg::color_space_t color_space>
+inline cg::image_comparison cg::image_metrics::compare(const image<color_space>& first, const image<color_space>& second)
+{
+	image_comparison comparison;
+	comparison.max_abs_diff = max_abs_diff(first, second);
+	comparison.mse = mse(first, second);
+	comparison.psnr = to_psnr(comparison.mse);
+	comparison.ssim = ssim(first, second);
+
+	return comparison;
+}
+
+template <cg::color_space_t color_space>
+inline double cg::image_metrics::max_abs_diff(const image<color_space>& first, const image<color_space>& second)
+{
+	require_same_size(first, second);
+
+	return max_abs_diff(first.get_values(), second.get_values(), first.get_data().size() * color_channels<color_space>::value);
+}
+
+template <cg::color_space_t color_space>
+inline double cg::image_metrics::mse(const image<color_space>& first, const image<color_space>& second)
+{
+	require_same_size(first, second);
+
+	return mse(first.get_values(), second.get_values(), first.get_data().size() * color_channels<color_space>::value);
+}
+
+template <cg::color_space_t color_space>
+inline double cg::image_metrics::psnr(const image<color_space>& first, const image<color_space>& second)
+{
+	return to_psnr(mse(first, second));
+}
+
+template <cg::color_space_t color_space>
+inline double cg::image_metrics::ssim(const image<color_space>& first, const image<color_space>& second)
+{
+	require_same_size(first, second);
+
+	return ssim(first.get_values(), second.get_values(), first.get_width(), first.get_height(), color_channels<color_space>::value);
+}
+
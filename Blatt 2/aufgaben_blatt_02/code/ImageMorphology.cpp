@@ -0,0 +1,386 @@
+#include "ImageMorphology.hpp"
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace cg
+{
+	namespace
+	{
+		/// Minimum number of rows processed by one task
+		constexpr std::size_t row_grain = 16;
+
+		/// <summary>
+		/// Get the mask of the used bits in the last word of a row
+		/// </summary>
+		/// <param name="width">Width</param>
+		/// <returns>Mask</returns>
+		inline std::uint64_t last_word_mask(const std::size_t width)
+		{
+			return (width % 64 != 0) ? (std::uint64_t(1) << (width % 64)) - 1 : ~std::uint64_t(0);
+		}
+
+		/// <summary>
+		/// Divide by 64, rounding towards negative infinity
+		/// </summary>
+		/// <param name="value">Value</param>
+		/// <returns>Quotient</returns>
+		inline std::ptrdiff_t floor_div_64(const std::ptrdiff_t value)
+		{
+			return (value >= 0) ? value / 64 : -((-value + 63) / 64);
+		}
+	}
+}
+
+cg::bit_image::bit_image(const std::size_t width, const std::size_t height) :
+	width(width), height(height), words_per_row((width + 63) / 64), words(((width + 63) / 64) * height, 0)
+{
+}
+
+cg::bit_image cg::bit_image::pack(const image<color_space_t::BW>& original, const float foreground)
+{
+	bit_image packed(original.get_width(), original.get_height());
+
+	const auto* data = original.get_values();
+	const bool white = (foreground >= 0.5f);
+
+	thread_pool::shared().parallel_for(0, packed.height, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		for (std::size_t j = first; j < last; ++j)
+		{
+			const float* in = data + j * packed.width;
+			std::uint64_t* out = packed.row(j);
+
+			for (std::size_t k = 0; k < packed.words_per_row; ++k)
+			{
+				const std::size_t count = std::min<std::size_t>(64, packed.width - 64 * k);
+				const float* values = in + 64 * k;
+				std::uint64_t word = 0;
+
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					word |= static_cast<std::uint64_t>(values[i] >= 0.5f) << i;
+				}
+
+				out[k] = white ? word : ~word & ((std::uint64_t(2) << (count - 1)) - 1);
+			}
+		}
+	});
+
+	return packed;
+}
+
+cg::image<cg::color_space_t::BW> cg::bit_image::unpack(const float foreground) const
+{
+	image<color_space_t::BW> unpacked(this->width, this->height);
+
+	auto* data = unpacked.get_values();
+	const float set = (foreground >= 0.5f) ? 1.f : 0.f;
+	const float unset = 1.f - set;
+
+	thread_pool::shared().parallel_for(0, this->height, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		for (std::size_t j = first; j < last; ++j)
+		{
+			const std::uint64_t* in = row(j);
+			float* out = data + j * this->width;
+
+			for (std::size_t k = 0; k < this->words_per_row; ++k)
+			{
+				const std::size_t count = std::min<std::size_t>(64, this->width - 64 * k);
+				const std::uint64_t word = in[k];
+
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					out[64 * k + i] = ((word >> i) & 1) ? set : unset;
+				}
+			}
+		}
+	});
+
+	return unpacked;
+}
+
+std::size_t cg::bit_image::get_width() const
+{
+	return this->width;
+}
+
+std::size_t cg::bit_image::get_height() const
+{
+	return this->height;
+}
+
+std::size_t cg::bit_image::get_words_per_row() const
+{
+	return this->words_per_row;
+}
+
+bool cg::bit_image::get(const std::size_t i, const std::size_t j) const
+{
+	return ((row(j)[i / 64] >> (i % 64)) & 1) != 0;
+}
+
+void cg::bit_image::set(const std::size_t i, const std::size_t j, const bool value)
+{
+	const std::uint64_t bit = std::uint64_t(1) << (i % 64);
+
+	if (value)
+	{
+		row(j)[i / 64] |= bit;
+	}
+	else
+	{
+		row(j)[i / 64] &= ~bit;
+	}
+}
+
+const std::uint64_t* cg::bit_image::row(const std::size_t j) const
+{
+	return this->words.data() + j * this->words_per_row;
+}
+
+std::uint64_t* cg::bit_image::row(const std::size_t j)
+{
+	return this->words.data() + j * this->words_per_row;
+}
+
+cg::structuring_element::structuring_element(const std::size_t width, const std::size_t height, const std::vector<bool>& mask,
+	const std::size_t anchor_x, const std::size_t anchor_y) : rectangular(true)
+{
+	if (mask.size() != width * height)
+	{
+		throw std::runtime_error("Mask size does not match the element size");
+	}
+
+	if (anchor_x >= width || anchor_y >= height)
+	{
+		throw std::runtime_error("Anchor must lie within the element");
+	}
+
+	for (std::size_t j = 0; j < height; ++j)
+	{
+		for (std::size_t i = 0; i < width; ++i)
+		{
+			if (mask[j * width + i])
+			{
+				this->offsets.push_back({ static_cast<std::ptrdiff_t>(i) - static_cast<std::ptrdiff_t>(anchor_x),
+					static_cast<std::ptrdiff_t>(j) - static_cast<std::ptrdiff_t>(anchor_y) });
+			}
+			else
+			{
+				this->rectangular = false;
+			}
+		}
+	}
+
+	if (this->offsets.empty())
+	{
+		throw std::runtime_error("Structuring element is empty");
+	}
+}
+
+cg::structuring_element::structuring_element(const std::size_t width, const std::size_t height, const std::vector<bool>& mask) :
+	structuring_element(width, height, mask, width / 2, height / 2)
+{
+}
+
+cg::structuring_element cg::structuring_element::rectangle(const std::size_t width, const std::size_t height)
+{
+	return structuring_element(width, height, std::vector<bool>(width * height, true));
+}
+
+const std::vector<cg::structuring_element::offset>& cg::structuring_element::get_offsets() const
+{
+	return this->offsets;
+}
+
+bool cg::structuring_element::is_rectangle() const
+{
+	return this->rectangular;
+}
+
+cg::bit_image cg::image_morphology::erode(const bit_image& original, const structuring_element& element)
+{
+	return apply(original, element, true);
+}
+
+cg::bit_image cg::image_morphology::dilate(const bit_image& original, const structuring_element& element)
+{
+	return apply(original, element, false);
+}
+
+cg::bit_image cg::image_morphology::open(const bit_image& original, const structuring_element& element)
+{
+	return apply(apply(original, element, true), element, false);
+}
+
+cg::bit_image cg::image_morphology::close(const bit_image& original, const structuring_element& element)
+{
+	return apply(apply(original, element, false), element, true);
+}
+
+cg::image<cg::color_space_t::BW> cg::image_morphology::erode(const image<color_space_t::BW>& original, const structuring_element& element, const float foreground)
+{
+	return erode(bit_image::pack(original, foreground), element).unpack(foreground);
+}
+
+cg::image<cg::color_space_t::BW> cg::image_morphology::dilate(const image<color_space_t::BW>& original, const structuring_element& element, const float foreground)
+{
+	return dilate(bit_image::pack(original, foreground), element).unpack(foreground);
+}
+
+cg::image<cg::color_space_t::BW> cg::image_morphology::open(const image<color_space_t::BW>& original, const structuring_element& element, const float foreground)
+{
+	return open(bit_image::pack(original, foreground), element).unpack(foreground);
+}
+
+cg::image<cg::color_space_t::BW> cg::image_morphology::close(const image<color_space_t::BW>& original, const structuring_element& element, const float foreground)
+{
+	return close(bit_image::pack(original, foreground), element).unpack(foreground);
+}
+
+cg::bit_image cg::image_morphology::apply(const bit_image& original, const structuring_element& element, const bool erosion)
+{
+	const auto& offsets = element.get_offsets();
+
+	if (!element.is_rectangle())
+	{
+		return apply(original, offsets, erosion);
+	}
+
+	// A rectangle is the combination of its first row and its first column
+	std::vector<structuring_element::offset> horizontal, vertical;
+
+	for (const auto& position : offsets)
+	{
+		if (position.y == offsets.front().y)
+		{
+			horizontal.push_back({ position.x, 0 });
+		}
+
+		if (position.x == offsets.front().x)
+		{
+			vertical.push_back({ 0, position.y });
+		}
+	}
+
+	return apply(apply(original, horizontal, erosion), vertical, erosion);
+}
+
+cg::bit_image cg::image_morphology::apply(const bit_image& original, const std::vector<structuring_element::offset>& offsets, const bool erosion)
+{
+	const std::size_t width = original.get_width();
+	const std::size_t height = original.get_height();
+	const std::size_t words = original.get_words_per_row();
+
+	bit_image result(width, height);
+
+	if (words == 0 || height == 0)
+	{
+		return result;
+	}
+
+	// Pixels outside the image are foreground for erosion and background for dilation
+	const std::uint64_t border = erosion ? ~std::uint64_t(0) : 0;
+	const std::uint64_t last_mask = last_word_mask(width);
+
+	std::ptrdiff_t max_shift = 0;
+
+	for (const auto& position : offsets)
+	{
+		max_shift = std::max(max_shift, std::abs(position.x));
+	}
+
+	// Copy the rows with enough border words on both sides that every shift can be read without bounds checks
+	const std::size_t padding = static_cast<std::size_t>(max_shift + 63) / 64 + 1;
+	const std::size_t stride = words + 2 * padding;
+
+	std::vector<std::uint64_t> padded(stride * height);
+
+	thread_pool::shared().parallel_for(0, height, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		for (std::size_t j = first; j < last; ++j)
+		{
+			std::uint64_t* out = padded.data() + j * stride;
+
+			std::fill(out, out + padding, border);
+			std::copy(original.row(j), original.row(j) + words, out + padding);
+			std::fill(out + padding + words, out + stride, border);
+
+			out[padding + words - 1] = (out[padding + words - 1] & last_mask) | (border & ~last_mask);
+		}
+	});
+
+	thread_pool::shared().parallel_for(0, height, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		std::vector<std::uint64_t> accumulator(words);
+
+		for (std::size_t j = first; j < last; ++j)
+		{
+			std::fill(accumulator.begin(), accumulator.end(), erosion ? ~std::uint64_t(0) : 0);
+
+			for (const auto& position : offsets)
+			{
+				// Erosion reads pixel (x + dx, y + dy), dilation pixel (x - dx, y - dy)
+				const std::ptrdiff_t shift_x = erosion ? position.x : -position.x;
+				const std::ptrdiff_t source_y = static_cast<std::ptrdiff_t>(j) + (erosion ? position.y : -position.y);
+
+				// Rows outside the image do not change the result
+				if (source_y < 0 || source_y >= static_cast<std::ptrdiff_t>(height))
+				{
+					continue;
+				}
+
+				const std::ptrdiff_t word_shift = floor_div_64(shift_x);
+				const unsigned int bit_shift = static_cast<unsigned int>(shift_x - 64 * word_shift);
+
+				const std::uint64_t* in = padded.data() + static_cast<std::size_t>(source_y) * stride + padding + word_shift;
+				std::uint64_t* out = accumulator.data();
+
+				if (bit_shift == 0)
+				{
+					if (erosion)
+					{
+						for (std::size_t k = 0; k < words; ++k)
+						{
+							out[k] &= in[k];
+						}
+					}
+					else
+					{
+						for (std::size_t k = 0; k < words; ++k)
+						{
+							out[k] |= in[k];
+						}
+					}
+				}
+				else
+				{
+					if (erosion)
+					{
+						for (std::size_t k = 0; k < words; ++k)
+						{
+							out[k] &= (in[k] >> bit_shift) | (in[k + 1] << (64 - bit_shift));
+						}
+					}
+					else
+					{
+						for (std::size_t k = 0; k < words; ++k)
+						{
+							out[k] |= (in[k] >> bit_shift) | (in[k + 1] << (64 - bit_shift));
+						}
+					}
+				}
+			}
+
+			accumulator[words - 1] &= last_mask;
+			std::copy(accumulator.begin(), accumulator.end(), result.row(j));
+		}
+	});
+
+	return result;
+}
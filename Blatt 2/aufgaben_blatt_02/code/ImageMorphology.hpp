@@ -0,0 +1,251 @@
+#pragma once
+
+#include "Image.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cg
+{
+	/// <summary>
+	/// Black-and-white image with one bit per pixel
+	/// Each row is stored in 64-bit words; bit i of word k holds pixel 64 * k + i, and a set bit
+	/// marks a foreground pixel. Unused bits of the last word in a row are zero.
+	/// </summary>
+	class bit_image
+	{
+	public:
+		/// <summary>
+		/// Constructor; all pixels are background
+		/// </summary>
+		/// <param name="width">Width</param>
+		/// <param name="height">Height</param>
+		bit_image(std::size_t width, std::size_t height);
+
+		/// <summary>
+		/// Pack a black-and-white image
+		/// </summary>
+		/// <param name="original">Black-and-white image</param>
+		/// <param name="foreground">Value of the foreground pixels (1 for white, 0 for black)</param>
+		/// <returns>Packed image</returns>
+		static bit_image pack(const image<color_space_t::BW>& original, float foreground = 1.f);
+
+		/// <summary>
+		/// Unpack into a black-and-white image
+		/// </summary>
+		/// <param name="foreground">Value of the foreground pixels (1 for white, 0 for black)</param>
+		/// <returns>Black-and-white image</returns>
+		image<color_space_t::BW> unpack(float foreground = 1.f) const;
+
+		/// <summary>
+		/// Get width
+		/// </summary>
+		/// <returns>Width</returns>
+		std::size_t get_width() const;
+
+		/// <summary>
+		/// Get height
+		/// </summary>
+		/// <returns>Height</returns>
+		std::size_t get_height() const;
+
+		/// <summary>
+		/// Get number of words per row
+		/// </summary>
+		/// <returns>Number of words</returns>
+		std::size_t get_words_per_row() const;
+
+		/// <summary>
+		/// Get a pixel
+		/// </summary>
+		/// <param name="i">Column</param>
+		/// <param name="j">Row</param>
+		/// <returns>True for foreground</returns>
+		bool get(std::size_t i, std::size_t j) const;
+
+		/// <summary>
+		/// Set a pixel
+		/// </summary>
+		/// <param name="i">Column</param>
+		/// <param name="j">Row</param>
+		/// <param name="value">True for foreground</param>
+		void set(std::size_t i, std::size_t j, bool value);
+
+		/// <summary>
+		/// Get the words of a row
+		/// </summary>
+		/// <param name="j">Row</param>
+		/// <returns>Pointer to the first word</returns>
+		const std::uint64_t* row(std::size_t j) const;
+		std::uint64_t* row(std::size_t j);
+
+	private:
+		std::size_t width;
+		std::size_t height;
+		std::size_t words_per_row;
+
+		/// Row-major words
+		std::vector<std::uint64_t> words;
+	};
+
+	/// <summary>
+	/// Structuring element for morphological operations
+	/// </summary>
+	class structuring_element
+	{
+	public:
+		/// <summary>
+		/// Position of a pixel of the element relative to its anchor
+		/// </summary>
+		struct offset
+		{
+			std::ptrdiff_t x;
+			std::ptrdiff_t y;
+		};
+
+		/// <summary>
+		/// Constructor for an arbitrary element
+		/// </summary>
+		/// <param name="width">Width of the mask</param>
+		/// <param name="height">Height of the mask</param>
+		/// <param name="mask">Row-major mask; true marks pixels belonging to the element</param>
+		/// <param name="anchor_x">Column of the anchor within the mask</param>
+		/// <param name="anchor_y">Row of the anchor within the mask</param>
+		structuring_element(std::size_t width, std::size_t height, const std::vector<bool>& mask, std::size_t anchor_x, std::size_t anchor_y);
+
+		/// <summary>
+		/// Constructor for an arbitrary element anchored at the center of the mask
+		/// </summary>
+		/// <param name="width">Width of the mask</param>
+		/// <param name="height">Height of the mask</param>
+		/// <param name="mask">Row-major mask; true marks pixels belonging to the element</param>
+		structuring_element(std::size_t width, std::size_t height, const std::vector<bool>& mask);
+
+		/// <summary>
+		/// Create a rectangular element anchored at its center
+		/// Rectangles are applied as a horizontal and a vertical line, one after the other.
+		/// </summary>
+		/// <param name="width">Width</param>
+		/// <param name="height">Height</param>
+		/// <returns>Structuring element</returns>
+		static structuring_element rectangle(std::size_t width, std::size_t height);
+
+		/// <summary>
+		/// Get the pixels of the element
+		/// </summary>
+		/// <returns>Offsets relative to the anchor</returns>
+		const std::vector<offset>& get_offsets() const;
+
+		/// <summary>
+		/// Check whether the element is a filled rectangle
+		/// </summary>
+		/// <returns>True for rectangles</returns>
+		bool is_rectangle() const;
+
+	private:
+		/// Pixels relative to the anchor, ordered by row
+		std::vector<offset> offsets;
+
+		/// Whether the element is a filled rectangle
+		bool rectangular;
+	};
+
+	/// <summary>
+	/// Class for binary morphology
+	/// The operations work on 64 pixels at once with shifts and bitwise AND/OR on packed rows.
+	/// Output rows are computed in parallel on the shared thread pool. Pixels outside the image
+	/// do not erode the border and do not dilate into the image.
+	/// </summary>
+	class image_morphology
+	{
+	public:
+		/// <summary>
+		/// Erode: keep foreground pixels whose whole neighborhood given by the element is foreground
+		/// </summary>
+		/// <param name="original">Packed image</param>
+		/// <param name="element">Structuring element</param>
+		/// <returns>Eroded image</returns>
+		static bit_image erode(const bit_image& original, const structuring_element& element);
+
+		/// <summary>
+		/// Dilate: set pixels whose neighborhood given by the reflected element contains foreground
+		/// </summary>
+		/// <param name="original">Packed image</param>
+		/// <param name="element">Structuring element</param>
+		/// <returns>Dilated image</returns>
+		static bit_image dilate(const bit_image& original, const structuring_element& element);
+
+		/// <summary>
+		/// Open: erode, then dilate (removes small foreground specks)
+		/// </summary>
+		/// <param name="original">Packed image</param>
+		/// <param name="element">Structuring element</param>
+		/// <returns>Opened image</returns>
+		static bit_image open(const bit_image& original, const structuring_element& element);
+
+		/// <summary>
+		/// Close: dilate, then erode (fills small background holes)
+		/// </summary>
+		/// <param name="original">Packed image</param>
+		/// <param name="element">Structuring element</param>
+		/// <returns>Closed image</returns>
+		static bit_image close(const bit_image& original, const structuring_element& element);
+
+		/// <summary>
+		/// Erode a black-and-white image
+		/// </summary>
+		/// <param name="original">Black-and-white image</param>
+		/// <param name="element">Structuring element</param>
+		/// <param name="foreground">Value of the foreground pixels (1 for white, 0 for black)</param>
+		/// <returns>Eroded image</returns>
+		static image<color_space_t::BW> erode(const image<color_space_t::BW>& original, const structuring_element& element, float foreground = 1.f);
+
+		/// <summary>
+		/// Dilate a black-and-white image
+		/// </summary>
+		/// <param name="original">Black-and-white image</param>
+		/// <param name="element">Structuring element</param>
+		/// <param name="foreground">Value of the foreground pixels (1 for white, 0 for black)</param>
+		/// <returns>Dilated image</returns>
+		static image<color_space_t::BW> dilate(const image<color_space_t::BW>& original, const structuring_element& element, float foreground = 1.f);
+
+		/// <summary>
+		/// Open a black-and-white image
+		/// </summary>
+		/// <param name="original">Black-and-white image</param>
+		/// <param name="element">Structuring element</param>
+		/// <param name="foreground">Value of the foreground pixels (1 for white, 0 for black)</param>
+		/// <returns>Opened image</returns>
+		static image<color_space_t::BW> open(const image<color_space_t::BW>& original, const structuring_element& element, float foreground = 1.f);
+
+		/// <summary>
+		/// Close a black-and-white image
+		/// </summary>
+		/// <param name="original">Black-and-white image</param>
+		/// <param name="element">Structuring element</param>
+		/// <param name="foreground">Value of the foreground pixels (1 for white, 0 for black)</param>
+		/// <returns>Closed image</returns>
+		static image<color_space_t::BW> close(const image<color_space_t::BW>& original, const structuring_element& element, float foreground = 1.f);
+
+	private:
+		/// <summary>
+		/// Combine shifted copies of an image
+		/// Erosion: result(x, y) = AND of original(x + dx, y + dy); dilation: OR of original(x - dx, y - dy).
+		/// </summary>
+		/// <param name="original">Packed image</param>
+		/// <param name="offsets">Offsets (dx, dy), ordered by dy</param>
+		/// <param name="erosion">Erode instead of dilate</param>
+		/// <returns>Result</returns>
+		static bit_image apply(const bit_image& original, const std::vector<structuring_element::offset>& offsets, bool erosion);
+
+		/// <summary>
+		/// Erode or dilate with a structuring element, splitting rectangles into lines
+		/// </summary>
+		/// <param name="original">Packed image</param>
+		/// <param name="element">Structuring element</param>
+		/// <param name="erosion">Erode instead of dilate</param>
+		/// <returns>Result</returns>
+		static bit_image apply(const bit_image& original, const structuring_element& element, bool erosion);
+	};
+}
@@ -0,0 +1,227 @@
+#include "ImagePyramid.hpp"
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace cg
+{
+	namespace
+	{
+		/// Minimum number of target rows processed by one task
+		constexpr std::size_t row_grain = 16;
+
+		/// <summary>
+		/// Convert a float to half precision, rounding to nearest even
+		/// </summary>
+		/// <param name="value">Float value</param>
+		/// <returns>Half precision value</returns>
+		std::uint16_t float_to_half(const float value)
+		{
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+
+			const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+			bits &= 0x7fffffffu;
+
+			if (bits >= 0x47800000u)
+			{
+				// Too large for half precision (or infinity/NaN)
+				return sign | ((bits > 0x7f800000u) ? 0x7e00u : 0x7c00u);
+			}
+
+			if (bits < 0x38800000u)
+			{
+				// Subnormal half: let the float addition do the rounding
+				float shifted;
+				std::memcpy(&shifted, &bits, sizeof(shifted));
+				shifted += 0.5f;
+
+				std::memcpy(&bits, &shifted, sizeof(bits));
+
+				return sign | static_cast<std::uint16_t>(bits - 0x3f000000u);
+			}
+
+			// Normal half: rebias the exponent and round the mantissa
+			const std::uint32_t odd = (bits >> 13) & 1u;
+			bits += 0xc8000fffu + odd;
+
+			return sign | static_cast<std::uint16_t>(bits >> 13);
+		}
+
+		/// <summary>
+		/// Convert a half precision value to float
+		/// </summary>
+		/// <param name="value">Half precision value</param>
+		/// <returns>Float value</returns>
+		float half_to_float(const std::uint16_t value)
+		{
+			const std::uint32_t exponent_mask = 0x7c00u << 13;
+
+			std::uint32_t bits = static_cast<std::uint32_t>(value & 0x7fffu) << 13;
+			const std::uint32_t exponent = bits & exponent_mask;
+			bits += (127u - 15u) << 23;
+
+			float result;
+
+			if (exponent == exponent_mask)
+			{
+				// Infinity/NaN
+				bits += (128u - 16u) << 23;
+				std::memcpy(&result, &bits, sizeof(result));
+			}
+			else if (exponent == 0)
+			{
+				// Zero/subnormal: renormalize with a float subtraction
+				bits += 1u << 23;
+				std::memcpy(&result, &bits, sizeof(result));
+				result -= 6.103515625e-05f;
+			}
+			else
+			{
+				std::memcpy(&result, &bits, sizeof(result));
+			}
+
+			return (value & 0x8000u) ? -result : result;
+		}
+
+		/// <summary>
+		/// Get the table of all half precision values converted to float
+		/// </summary>
+		/// <returns>Table with 65536 entries</returns>
+		const std::vector<float>& decode_table()
+		{
+			static const std::vector<float> table = []()
+			{
+				std::vector<float> values(65536);
+
+				for (std::size_t index = 0; index < values.size(); ++index)
+				{
+					values[index] = half_to_float(static_cast<std::uint16_t>(index));
+				}
+
+				return values;
+			}();
+
+			return table;
+		}
+
+		/// <summary>
+		/// Average 2x2 blocks of two rows
+		/// </summary>
+		/// <param name="upper">Upper source row</param>
+		/// <param name="lower">Lower source row</param>
+		/// <param name="sum">Buffer of source_width * channels values</param>
+		/// <param name="source_width">Source width</param>
+		/// <param name="target">Target row</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		void reduce_rows(const float* upper, const float* lower, float* sum, const std::size_t source_width, std::uint16_t* target, const std::size_t channels)
+		{
+			const std::size_t row_size = source_width * channels;
+			const std::size_t target_width = (source_width + 1) / 2;
+
+			// Add the two rows, then pairs of neighboring pixels
+			for (std::size_t k = 0; k < row_size; ++k)
+			{
+				sum[k] = upper[k] + lower[k];
+			}
+
+			for (std::size_t i = 0; i < source_width / 2; ++i)
+			{
+				for (std::size_t channel = 0; channel < channels; ++channel)
+				{
+					sum[i * channels + channel] = 0.25f * (sum[2 * i * channels + channel] + sum[(2 * i + 1) * channels + channel]);
+				}
+			}
+
+			if (source_width % 2 != 0)
+			{
+				for (std::size_t channel = 0; channel < channels; ++channel)
+				{
+					sum[(target_width - 1) * channels + channel] = 0.5f * sum[(source_width - 1) * channels + channel];
+				}
+			}
+
+			half_float_storage::encode(sum, target, target_width * channels);
+		}
+	}
+}
+
+void cg::half_float_storage::encode(const float* source, std::uint16_t* target, const std::size_t count)
+{
+	for (std::size_t index = 0; index < count; ++index)
+	{
+		target[index] = float_to_half(source[index]);
+	}
+}
+
+void cg::half_float_storage::decode(const std::uint16_t* source, float* target, const std::size_t count)
+{
+	const float* table = decode_table().data();
+
+	for (std::size_t index = 0; index < count; ++index)
+	{
+		target[index] = table[source[index]];
+	}
+}
+
+void cg::half_float_storage::reduce(const float* source, const std::size_t source_width, const std::size_t source_height, std::uint16_t* target, const std::size_t channels)
+{
+	const std::size_t row_size = source_width * channels;
+	const std::size_t target_row_size = ((source_width + 1) / 2) * channels;
+
+	thread_pool::shared().parallel_for(0, (source_height + 1) / 2, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		std::vector<float> sum(row_size);
+
+		for (std::size_t j = first; j < last; ++j)
+		{
+			const float* upper = source + (2 * j) * row_size;
+			const float* lower = source + std::min(2 * j + 1, source_height - 1) * row_size;
+
+			reduce_rows(upper, lower, sum.data(), source_width, target + j * target_row_size, channels);
+		}
+	});
+}
+
+void cg::half_float_storage::reduce(const std::uint16_t* source, const std::size_t source_width, const std::size_t source_height, std::uint16_t* target, const std::size_t channels)
+{
+	const std::size_t row_size = source_width * channels;
+	const std::size_t target_row_size = ((source_width + 1) / 2) * channels;
+
+	thread_pool::shared().parallel_for(0, (source_height + 1) / 2, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		std::vector<float> upper(row_size), lower(row_size), sum(row_size);
+
+		for (std::size_t j = first; j < last; ++j)
+		{
+			decode(source + (2 * j) * row_size, upper.data(), row_size);
+			decode(source + std::min(2 * j + 1, source_height - 1) * row_size, lower.data(), row_size);
+
+			reduce_rows(upper.data(), lower.data(), sum.data(), source_width, target + j * target_row_size, channels);
+		}
+	});
+}
+
+void cg::half_float_storage::write(std::ofstream& stream, const void* data, const std::size_t size)
+{
+	stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+
+	if (!stream.good())
+	{
+		throw std::runtime_error("Unable to write file");
+	}
+}
+
+void cg::half_float_storage::read(std::ifstream& stream, void* data, const std::size_t size)
+{
+	stream.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+
+	if (static_cast<std::size_t>(stream.gcount()) != size)
+	{
+		throw std::runtime_error("Unexpected end of file");
+	}
+}
@@ -0,0 +1,360 @@
+#pragma once
+
+#include "Image.hpp"
+#include "ImageTraits.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cg
+{
+	/// <summary>
+	/// Class for storing pixel data as 16-bit (IEEE 754 half precision) floats
+	/// </summary>
+	class half_float_storage
+	{
+	public:
+		/// <summary>
+		/// Convert floats to half precision, rounding to nearest even
+		/// </summary>
+		/// <param name="source">Float values</param>
+		/// <param name="target">Half precision values</param>
+		/// <param name="count">Number of values</param>
+		static void encode(const float* source, std::uint16_t* target, std::size_t count);
+
+		/// <summary>
+		/// Convert half precision values to floats
+		/// </summary>
+		/// <param name="source">Half precision values</param>
+		/// <param name="target">Float values</param>
+		/// <param name="count">Number of values</param>
+		static void decode(const std::uint16_t* source, float* target, std::size_t count);
+
+		/// <summary>
+		/// Halve the size of interleaved pixel data by averaging 2x2 blocks
+		/// For odd sizes, the last row/column is repeated. Rows are processed in parallel.
+		/// </summary>
+		/// <param name="source">Source pixel data</param>
+		/// <param name="source_width">Source width</param>
+		/// <param name="source_height">Source height</param>
+		/// <param name="target">Target pixel data of size ceil(width / 2) x ceil(height / 2)</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		static void reduce(const float* source, std::size_t source_width, std::size_t source_height, std::uint16_t* target, std::size_t channels);
+		static void reduce(const std::uint16_t* source, std::size_t source_width, std::size_t source_height, std::uint16_t* target, std::size_t channels);
+
+		/// <summary>
+		/// Write a block of values to a binary stream
+		/// </summary>
+		/// <param name="stream">Output stream</param>
+		/// <param name="data">Data</param>
+		/// <param name="size">Size in bytes</param>
+		static void write(std::ofstream& stream, const void* data, std::size_t size);
+
+		/// <summary>
+		/// Read a block of values from a binary stream
+		/// </summary>
+		/// <param name="stream">Input stream</param>
+		/// <param name="data">Data</param>
+		/// <param name="size">Size in bytes</param>
+		static void read(std::ifstream& stream, void* data, std::size_t size);
+	};
+
+	/// <summary>
+	/// Mipmap pyramid of an image
+	/// Level 0 is the original image; each further level halves the size of the previous one
+	/// down to 1x1 pixel. Levels are computed by 2x2 averaging when they are first accessed and
+	/// kept in half precision. Accessing levels is thread-safe.
+	/// </summary>
+	template <color_space_t color_space>
+	class image_pyramid
+	{
+	public:
+		/// <summary>
+		/// Constructor
+		/// </summary>
+		/// <param name="base">Original image (level 0)</param>
+		explicit image_pyramid(image<color_space> base);
+
+		/// <summary>
+		/// Get number of levels
+		/// </summary>
+		/// <returns>Number of levels, including the original image</returns>
+		std::size_t get_level_count() const;
+
+		/// <summary>
+		/// Get width of a level
+		/// </summary>
+		/// <param name="level">Level</param>
+		/// <returns>Width</returns>
+		std::size_t get_width(std::size_t level) const;
+
+		/// <summary>
+		/// Get height of a level
+		/// </summary>
+		/// <param name="level">Level</param>
+		/// <returns>Height</returns>
+		std::size_t get_height(std::size_t level) const;
+
+		/// <summary>
+		/// Get a level, computing it (and all coarser levels up to it) if necessary
+		/// </summary>
+		/// <param name="level">Level</param>
+		/// <returns>Image of the level</returns>
+		image<color_space> get_level(std::size_t level) const;
+
+		/// <summary>
+		/// Select the level to display the image at a zoom factor
+		/// This is the coarsest level that still has at least the requested resolution.
+		/// </summary>
+		/// <param name="scale">Zoom factor (1 is the original size)</param>
+		/// <returns>Level</returns>
+		std::size_t select_level(float scale) const;
+
+		/// <summary>
+		/// Compute all levels that have not been accessed yet
+		/// </summary>
+		void build() const;
+
+		/// <summary>
+		/// Save the whole pyramid to one file
+		/// </summary>
+		/// <param name="path">Path to pyramid file</param>
+		void save(const std::string& path) const;
+
+		/// <summary>
+		/// Load a pyramid saved with save()
+		/// </summary>
+		/// <param name="path">Path to pyramid file</param>
+		/// <returns>Pyramid</returns>
+		static image_pyramid load(const std::string& path);
+
+	private:
+		/// <summary>
+		/// Compute all levels up to the given one; the caller must hold the lock
+		/// </summary>
+		/// <param name="level">Level</param>
+		void build_levels(std::size_t level) const;
+
+		/// Original image
+		image<color_space> base;
+
+		/// Half precision data of the levels 1, 2, ...; empty until computed
+		mutable std::vector<std::vector<std::uint16_t>> levels;
+
+		/// Number of computed levels (the original image counts as computed)
+		mutable std::size_t built_levels;
+
+		/// Lock for computing levels
+		std::unique_ptr<std::mutex> lock;
+	};
+}
+
+template <cg::color_space_t color_space>
+inline cg::image_pyramid<color_space>::image_pyramid(image<color_space> base) : base(std::move(base)), built_levels(1), lock(new std::mutex())
+{
+	std::size_t width = this->base.get_width();
+	std::size_t height = this->base.get_height();
+
+	while (width > 1 || height > 1)
+	{
+		width = (width + 1) / 2;
+		height = (height + 1) / 2;
+
+		this->levels.emplace_back();
+	}
+}
+
+template <cg::color_space_t color_space>
+inline std::size_t cg::image_pyramid<color_space>::get_level_count() const
+{
+	return this->levels.size() + 1;
+}
+
+template <cg::color_space_t color_space>
+inline std::size_t cg::image_pyramid<color_space>::get_width(const std::size_t level) const
+{
+	if (level >= get_level_count())
+	{
+		throw std::runtime_error("Pyramid level does not exist");
+	}
+
+	std::size_t width = this->base.get_width();
+
+	for (std::size_t index = 0; index < level; ++index)
+	{
+		width = (width + 1) / 2;
+	}
+
+	return width;
+}
+
+template <cg::color_space_t color_space>
+inline std::size_t cg::image_pyramid<color_space>::get_height(const std::size_t level) const
+{
+	if (level >= get_level_count())
+	{
+		throw std::runtime_error("Pyramid level does not exist");
+	}
+
+	std::size_t height = this->base.get_height();
+
+	for (std::size_t index = 0; index < level; ++index)
+	{
+		height = (height + 1) / 2;
+	}
+
+	return height;
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_pyramid<color_space>::get_level(const std::size_t level) const
+{
+	if (level == 0)
+	{
+		return this->base;
+	}
+
+	image<color_space> result(get_width(level), get_height(level));
+
+	std::lock_guard<std::mutex> guard(*this->lock);
+	build_levels(level);
+
+	const auto& data = this->levels[level - 1];
+	half_float_storage::decode(data.data(), result.get_values(), data.size());
+
+	return result;
+}
+
+template <cg::color_space_t color_space>
+inline std::size_t cg::image_pyramid<color_space>::select_level(const float scale) const
+{
+	if (!(scale > 0.f))
+	{
+		throw std::runtime_error("Zoom factor must be positive");
+	}
+
+	if (scale >= 1.f)
+	{
+		return 0;
+	}
+
+	const auto level = static_cast<std::size_t>(std::floor(std::log2(1.0 / static_cast<double>(scale)) + 1e-9));
+
+	return std::min(level, get_level_count() - 1);
+}
+
+template <cg::color_space_t color_space>
+inline void cg::image_pyramid<color_space>::build() const
+{
+	std::lock_guard<std::mutex> guard(*this->lock);
+	build_levels(get_level_count() - 1);
+}
+
+template <cg::color_space_t color_space>
+inline void cg::image_pyramid<color_space>::save(const std::string& path) const
+{
+	build();
+
+	std::ofstream pyramid_file(path, std::iostream::out | std::iostream::binary);
+
+	if (!pyramid_file.is_open() || !pyramid_file.good())
+	{
+		throw std::runtime_error("Unable to open file");
+	}
+
+	// Header, followed by the original image as floats and all other levels as half precision values
+	pyramid_file << "CGPYRAMID\n" << static_cast<int>(color_space) << " " << this->base.get_width() << " "
+		<< this->base.get_height() << " " << get_level_count() << "\n";
+
+	half_float_storage::write(pyramid_file, this->base.get_data().data(), this->base.get_data().size() * sizeof(typename image<color_space>::tuple_type));
+
+	for (const auto& level : this->levels)
+	{
+		half_float_storage::write(pyramid_file, level.data(), level.size() * sizeof(std::uint16_t));
+	}
+}
+
+template <cg::color_space_t color_space>
+inline cg::image_pyramid<color_space> cg::image_pyramid<color_space>::load(const std::string& path)
+{
+	std::ifstream pyramid_file(path, std::iostream::in | std::iostream::binary);
+
+	if (!pyramid_file.is_open() || !pyramid_file.good())
+	{
+		throw std::runtime_error("Unable to open file");
+	}
+
+	std::string magic;
+	int file_color_space = -1;
+	std::size_t width = 0, height = 0, level_count = 0;
+
+	pyramid_file >> magic >> file_color_space >> width >> height >> level_count;
+
+	if (!pyramid_file.good() || magic != "CGPYRAMID" || pyramid_file.get() != '\n')
+	{
+		throw std::runtime_error("Invalid pyramid file");
+	}
+
+	if (file_color_space != static_cast<int>(color_space))
+	{
+		throw std::runtime_error("Pyramid file has a different color space");
+	}
+
+	image<color_space> base(width, height);
+	half_float_storage::read(pyramid_file, base.get_data().data(), base.get_data().size() * sizeof(typename image<color_space>::tuple_type));
+
+	image_pyramid pyramid(std::move(base));
+
+	if (pyramid.get_level_count() != level_count)
+	{
+		throw std::runtime_error("Invalid pyramid file");
+	}
+
+	for (std::size_t level = 1; level < level_count; ++level)
+	{
+		auto& data = pyramid.levels[level - 1];
+		data.resize(pyramid.get_width(level) * pyramid.get_height(level) * color_channels<color_space>::value);
+
+		half_float_storage::read(pyramid_file, data.data(), data.size() * sizeof(std::uint16_t));
+	}
+
+	pyramid.built_levels = level_count;
+
+	return pyramid;
+}
+
+template <cg::color_space_t color_space>
+inline void cg::image_pyramid<color_space>::build_levels(const std::size_t level) const
+{
+	static_assert(sizeof(typename image<color_space>::tuple_type) == color_channels<color_space>::value * sizeof(float), "Pixels must be stored as tightly packed floats");
+
+	const std::size_t channels = color_channels<color_space>::value;
+
+	for (; this->built_levels <= level; ++this->built_levels)
+	{
+		const std::size_t current = this->built_levels;
+		const std::size_t width = get_width(current - 1);
+		const std::size_t height = get_height(current - 1);
+
+		auto& data = this->levels[current - 1];
+		data.resize(((width + 1) / 2) * ((height + 1) / 2) * channels);
+
+		if (current == 1)
+		{
+			half_float_storage::reduce(this->base.get_values(), width, height, data.data(), channels);
+		}
+		else
+		{
+			half_float_storage::reduce(this->levels[current - 2].data(), width, height, data.data(), channels);
+		}
+	}
+}
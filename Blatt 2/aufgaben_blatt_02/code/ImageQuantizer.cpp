@@ -0,0 +1,622 @@
+#include "ImageQuantizer.hpp"
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace cg
+{
+	namespace
+	{
+		/// Minimum number of pixels processed by one task
+		constexpr std::size_t pixel_grain = 65536;
+
+		/// Bits per channel of the median cut histogram
+		constexpr std::size_t histogram_bits = 5;
+		constexpr std::size_t histogram_levels = std::size_t(1) << histogram_bits;
+
+		/// Number of cells per axis of the nearest color grid
+		constexpr std::size_t grid_cells = 16;
+
+		/// Stop refining once no palette color moves further than this
+		constexpr float convergence_distance = 1e-4f;
+
+		/// <summary>
+		/// Clamp a value to [0, 1]
+		/// </summary>
+		/// <param name="value">Value</param>
+		/// <returns>Clamped value</returns>
+		inline float saturate(const float value)
+		{
+			return std::min(std::max(value, 0.f), 1.f);
+		}
+
+		/// <summary>
+		/// Occupied bin of the median cut histogram
+		/// </summary>
+		struct color_bin
+		{
+			/// Quantized color
+			std::array<std::uint8_t, 3> key;
+
+			/// Number of pixels and sum of their colors
+			std::uint64_t count;
+			std::array<double, 3> sum;
+		};
+
+		/// <summary>
+		/// Running color sums of a palette entry
+		/// </summary>
+		struct cluster_sums
+		{
+			std::uint64_t count = 0;
+			std::array<double, 3> sum = {{ 0.0, 0.0, 0.0 }};
+		};
+
+		/// <summary>
+		/// Lookup structure for the nearest palette color
+		/// The bounding box of the image colors is split into grid_cells^3 cells; each cell lists the
+		/// palette entries whose distance to the cell is not larger than the smallest maximum distance
+		/// of any entry, which includes the nearest entry of every color in the cell. Colors outside
+		/// the box are compared with the whole palette. Candidates are stored as separate coordinate arrays so that their
+		/// distances are computed in one vectorizable loop.
+		/// </summary>
+		class palette_grid
+		{
+		public:
+			/// <summary>
+			/// Constructor
+			/// </summary>
+			/// <param name="palette">Palette with 1 to 256 entries</param>
+			/// <param name="bounds">Smallest and largest value per channel of the colors to look up</param>
+			palette_grid(const std::vector<indexed_image::color_type>& palette, const std::array<std::array<float, 2>, 3>& bounds) :
+				low({{ bounds[0][0], bounds[1][0], bounds[2][0] }}), offsets(cell_count + 2, 0)
+			{
+				for (std::size_t channel = 0; channel < 3; ++channel)
+				{
+					this->high[channel] = std::max(bounds[channel][1], bounds[channel][0]);
+					this->cell_size[channel] = std::max((this->high[channel] - this->low[channel]) / static_cast<float>(grid_cells), 1e-6f);
+				}
+
+				std::vector<std::vector<std::uint8_t>> candidates(cell_count + 1);
+
+				thread_pool::shared().parallel_for(0, cell_count, 64, [&](const std::size_t first, const std::size_t last)
+				{
+					std::vector<float> nearest(palette.size());
+
+					for (std::size_t cell = first; cell < last; ++cell)
+					{
+						const std::array<std::size_t, 3> position = {{ cell % grid_cells, (cell / grid_cells) % grid_cells, cell / (grid_cells * grid_cells) }};
+						float bound = std::numeric_limits<float>::max();
+
+						for (std::size_t entry = 0; entry < palette.size(); ++entry)
+						{
+							float near = 0.f, far = 0.f;
+
+							for (std::size_t channel = 0; channel < 3; ++channel)
+							{
+								const float low = this->low[channel] + static_cast<float>(position[channel]) * this->cell_size[channel];
+								const float high = low + this->cell_size[channel];
+								const float value = palette[entry][channel];
+
+								const float inside = (value < low) ? low - value : ((value > high) ? value - high : 0.f);
+								const float outside = std::max(value - low, high - value);
+
+								near += inside * inside;
+								far += outside * outside;
+							}
+
+							nearest[entry] = near;
+							bound = std::min(bound, far);
+						}
+
+						// Leave some slack for rounding so that no possibly nearest entry is dropped
+						bound = bound * 1.0001f + 1e-6f;
+
+						for (std::size_t entry = 0; entry < palette.size(); ++entry)
+						{
+							if (nearest[entry] <= bound)
+							{
+								candidates[cell].push_back(static_cast<std::uint8_t>(entry));
+							}
+						}
+					}
+				});
+
+				for (std::size_t entry = 0; entry < palette.size(); ++entry)
+				{
+					candidates[cell_count].push_back(static_cast<std::uint8_t>(entry));
+				}
+
+				for (std::size_t cell = 0; cell <= cell_count; ++cell)
+				{
+					this->offsets[cell + 1] = this->offsets[cell] + candidates[cell].size();
+
+					for (const auto entry : candidates[cell])
+					{
+						this->entries.push_back(entry);
+						this->red.push_back(palette[entry][0]);
+						this->green.push_back(palette[entry][1]);
+						this->blue.push_back(palette[entry][2]);
+					}
+				}
+			}
+
+			/// <summary>
+			/// Check whether a channel of a color lies within the box of the grid
+			/// </summary>
+			/// <param name="color">Color</param>
+			/// <param name="channel">Channel</param>
+			/// <returns>True if inside</returns>
+			bool inside(const float* color, const std::size_t channel) const
+			{
+				return color[channel] >= this->low[channel] && color[channel] <= this->high[channel];
+			}
+
+			/// <summary>
+			/// Get the cell coordinate of a channel of a color inside the box
+			/// </summary>
+			/// <param name="color">Color</param>
+			/// <param name="channel">Channel</param>
+			/// <returns>Cell coordinate</returns>
+			std::size_t cell_of(const float* color, const std::size_t channel) const
+			{
+				return std::min(static_cast<std::size_t>((color[channel] - this->low[channel]) / this->cell_size[channel]), grid_cells - 1);
+			}
+
+			/// <summary>
+			/// Find the nearest palette entry of a color
+			/// </summary>
+			/// <param name="color">Color</param>
+			/// <returns>Palette index; the smallest one if several entries are equally near</returns>
+			std::uint8_t nearest(const float* color) const
+			{
+				std::size_t cell = cell_count;
+
+				if (inside(color, 0) && inside(color, 1) && inside(color, 2))
+				{
+					cell = cell_of(color, 0) + grid_cells * (cell_of(color, 1) + grid_cells * cell_of(color, 2));
+				}
+
+				const std::size_t first = this->offsets[cell];
+				const std::size_t count = this->offsets[cell + 1] - first;
+
+				const float* red = this->red.data() + first;
+				const float* green = this->green.data() + first;
+				const float* blue = this->blue.data() + first;
+
+				// Compute all distances first; this loop has no dependencies and vectorizes
+				float distances[256];
+
+				for (std::size_t candidate = 0; candidate < count; ++candidate)
+				{
+					const float dr = red[candidate] - color[0];
+					const float dg = green[candidate] - color[1];
+					const float db = blue[candidate] - color[2];
+
+					distances[candidate] = dr * dr + dg * dg + db * db;
+				}
+
+				std::size_t best = 0;
+
+				for (std::size_t candidate = 1; candidate < count; ++candidate)
+				{
+					if (distances[candidate] < distances[best])
+					{
+						best = candidate;
+					}
+				}
+
+				return this->entries[first + best];
+			}
+
+		private:
+			/// Number of cells; the candidates for colors outside the box follow as an extra cell
+			static constexpr std::size_t cell_count = grid_cells * grid_cells * grid_cells;
+
+			/// Box covered by the grid and size of a cell per channel
+			std::array<float, 3> low;
+			std::array<float, 3> high;
+			std::array<float, 3> cell_size;
+
+			/// Range [offsets[c], offsets[c + 1]) of the candidates of cell c
+			std::vector<std::size_t> offsets;
+
+			/// Palette index and color of each candidate
+			std::vector<std::uint8_t> entries;
+			std::vector<float> red, green, blue;
+		};
+
+		/// <summary>
+		/// Make sure a palette fits into 8-bit indices
+		/// </summary>
+		/// <param name="size">Number of palette entries</param>
+		void check_palette_size(const std::size_t size)
+		{
+			if (size == 0 || size > 256)
+			{
+				throw std::runtime_error("Palettes must have 1 to 256 colors");
+			}
+		}
+
+		/// <summary>
+		/// Find the smallest and largest value per channel of the pixels of an image
+		/// </summary>
+		/// <param name="pixels">Pixels</param>
+		/// <returns>Minimum and maximum per channel</returns>
+		std::array<std::array<float, 2>, 3> color_bounds(const image<color_space_t::RGB>::data_type& pixels)
+		{
+			const float infinity = std::numeric_limits<float>::infinity();
+			std::array<std::array<float, 2>, 3> bounds = {{ {{ infinity, -infinity }}, {{ infinity, -infinity }}, {{ infinity, -infinity }} }};
+			std::mutex merge_mutex;
+
+			thread_pool::shared().parallel_for(0, pixels.size(), pixel_grain, [&](const std::size_t first, const std::size_t last)
+			{
+				std::array<float, 3> low = {{ infinity, infinity, infinity }}, high = {{ -infinity, -infinity, -infinity }};
+
+				for (std::size_t index = first; index < last; ++index)
+				{
+					for (std::size_t channel = 0; channel < 3; ++channel)
+					{
+						low[channel] = std::min(low[channel], pixels[index][channel]);
+						high[channel] = std::max(high[channel], pixels[index][channel]);
+					}
+				}
+
+				std::lock_guard<std::mutex> lock(merge_mutex);
+
+				for (std::size_t channel = 0; channel < 3; ++channel)
+				{
+					bounds[channel][0] = std::min(bounds[channel][0], low[channel]);
+					bounds[channel][1] = std::max(bounds[channel][1], high[channel]);
+				}
+			});
+
+			// Empty images get the unit cube
+			for (auto& range : bounds)
+			{
+				if (range[0] > range[1])
+				{
+					range = {{ 0.f, 1.f }};
+				}
+			}
+
+			return bounds;
+		}
+	}
+}
+
+cg::indexed_image::indexed_image(const std::size_t width, const std::size_t height, std::vector<color_type> palette) :
+	width(width), height(height), palette(std::move(palette)), indices(width * height, 0)
+{
+	check_palette_size(this->palette.size());
+}
+
+std::size_t cg::indexed_image::get_width() const
+{
+	return this->width;
+}
+
+std::size_t cg::indexed_image::get_height() const
+{
+	return this->height;
+}
+
+const std::vector<cg::indexed_image::color_type>& cg::indexed_image::get_palette() const
+{
+	return this->palette;
+}
+
+const std::vector<std::uint8_t>& cg::indexed_image::get_indices() const
+{
+	return this->indices;
+}
+
+std::vector<std::uint8_t>& cg::indexed_image::get_indices()
+{
+	return this->indices;
+}
+
+std::uint8_t cg::indexed_image::at(const std::size_t i, const std::size_t j) const
+{
+	return this->indices[j * this->width + i];
+}
+
+std::uint8_t& cg::indexed_image::at(const std::size_t i, const std::size_t j)
+{
+	return this->indices[j * this->width + i];
+}
+
+cg::image<cg::color_space_t::RGB> cg::indexed_image::to_rgb() const
+{
+	image<color_space_t::RGB> converted(this->width, this->height);
+	auto& pixels = converted.get_data();
+
+	thread_pool::shared().parallel_for(0, this->indices.size(), pixel_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		for (std::size_t index = first; index < last; ++index)
+		{
+			pixels[index] = this->palette[this->indices[index]];
+		}
+	});
+
+	return converted;
+}
+
+cg::indexed_image cg::image_quantizer::quantize(const image<color_space_t::RGB>& original, const std::size_t colors, const std::size_t iterations)
+{
+	return apply_palette(original, refine(original, median_cut(original, colors), iterations));
+}
+
+std::vector<cg::indexed_image::color_type> cg::image_quantizer::median_cut(const image<color_space_t::RGB>& original, const std::size_t colors)
+{
+	check_palette_size(colors);
+
+	const auto& pixels = original.get_data();
+	const std::size_t bin_count = histogram_levels * histogram_levels * histogram_levels;
+
+	const auto key_of = [](const float value)
+	{
+		return std::min(static_cast<std::size_t>(saturate(value) * static_cast<float>(histogram_levels)), histogram_levels - 1);
+	};
+
+	// Histogram of the colors quantized to 5 bits per channel, with the exact color sums per bin
+	std::vector<std::uint64_t> counts(bin_count, 0);
+	std::vector<std::array<double, 3>> sums(bin_count, {{ 0.0, 0.0, 0.0 }});
+	std::mutex merge_mutex;
+
+	thread_pool::shared().parallel_for(0, pixels.size(), 4 * pixel_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		std::vector<std::uint64_t> local_counts(bin_count, 0);
+		std::vector<std::array<double, 3>> local_sums(bin_count, {{ 0.0, 0.0, 0.0 }});
+
+		for (std::size_t index = first; index < last; ++index)
+		{
+			const auto& pixel = pixels[index];
+			const std::size_t bin = key_of(pixel[0]) + histogram_levels * (key_of(pixel[1]) + histogram_levels * key_of(pixel[2]));
+
+			++local_counts[bin];
+
+			for (std::size_t channel = 0; channel < 3; ++channel)
+			{
+				local_sums[bin][channel] += pixel[channel];
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(merge_mutex);
+
+		for (std::size_t bin = 0; bin < bin_count; ++bin)
+		{
+			counts[bin] += local_counts[bin];
+
+			for (std::size_t channel = 0; channel < 3; ++channel)
+			{
+				sums[bin][channel] += local_sums[bin][channel];
+			}
+		}
+	});
+
+	std::vector<color_bin> bins;
+
+	for (std::size_t bin = 0; bin < bin_count; ++bin)
+	{
+		if (counts[bin] != 0)
+		{
+			const std::array<std::uint8_t, 3> key = {{ static_cast<std::uint8_t>(bin % histogram_levels),
+				static_cast<std::uint8_t>((bin / histogram_levels) % histogram_levels), static_cast<std::uint8_t>(bin / (histogram_levels * histogram_levels)) }};
+
+			bins.push_back({ key, counts[bin], sums[bin] });
+		}
+	}
+
+	if (bins.empty())
+	{
+		return std::vector<indexed_image::color_type>(1, {{ 0.f, 0.f, 0.f }});
+	}
+
+	// Boxes are ranges of bins; repeatedly split the box that is widest relative to its pixel count
+	struct box
+	{
+		std::size_t first, last;
+		std::size_t axis;
+		std::uint64_t count;
+		std::size_t extent;
+	};
+
+	const auto make_box = [&](const std::size_t first, const std::size_t last)
+	{
+		std::array<std::uint8_t, 3> low = {{ 255, 255, 255 }}, high = {{ 0, 0, 0 }};
+		std::uint64_t count = 0;
+
+		for (std::size_t index = first; index < last; ++index)
+		{
+			count += bins[index].count;
+
+			for (std::size_t channel = 0; channel < 3; ++channel)
+			{
+				low[channel] = std::min(low[channel], bins[index].key[channel]);
+				high[channel] = std::max(high[channel], bins[index].key[channel]);
+			}
+		}
+
+		std::size_t axis = 0;
+
+		for (std::size_t channel = 1; channel < 3; ++channel)
+		{
+			if (high[channel] - low[channel] > high[axis] - low[axis])
+			{
+				axis = channel;
+			}
+		}
+
+		return box{ first, last, axis, count, static_cast<std::size_t>(high[axis] - low[axis]) };
+	};
+
+	std::vector<box> boxes(1, make_box(0, bins.size()));
+
+	while (boxes.size() < colors)
+	{
+		std::size_t selected = boxes.size();
+		double best_score = 0.0;
+
+		for (std::size_t index = 0; index < boxes.size(); ++index)
+		{
+			const double score = static_cast<double>(boxes[index].count) * static_cast<double>(boxes[index].extent);
+
+			if (boxes[index].last - boxes[index].first > 1 && score > best_score)
+			{
+				best_score = score;
+				selected = index;
+			}
+		}
+
+		if (selected == boxes.size())
+		{
+			break;
+		}
+
+		const box current = boxes[selected];
+		const std::size_t axis = current.axis;
+
+		std::sort(bins.begin() + current.first, bins.begin() + current.last, [axis](const color_bin& lhs, const color_bin& rhs)
+		{
+			return lhs.key[axis] < rhs.key[axis];
+		});
+
+		// Split at the median pixel, keeping at least one bin on each side
+		std::uint64_t below = 0;
+		std::size_t split = current.first + 1;
+
+		for (std::size_t index = current.first; index + 1 < current.last; ++index)
+		{
+			below += bins[index].count;
+			split = index + 1;
+
+			if (2 * below >= current.count)
+			{
+				break;
+			}
+		}
+
+		boxes[selected] = make_box(current.first, split);
+		boxes.push_back(make_box(split, current.last));
+	}
+
+	std::vector<indexed_image::color_type> palette;
+
+	for (const auto& current : boxes)
+	{
+		std::array<double, 3> sum = {{ 0.0, 0.0, 0.0 }};
+
+		for (std::size_t index = current.first; index < current.last; ++index)
+		{
+			for (std::size_t channel = 0; channel < 3; ++channel)
+			{
+				sum[channel] += bins[index].sum[channel];
+			}
+		}
+
+		const double count = static_cast<double>(current.count);
+		palette.push_back({{ static_cast<float>(sum[0] / count), static_cast<float>(sum[1] / count), static_cast<float>(sum[2] / count) }});
+	}
+
+	return palette;
+}
+
+std::vector<cg::indexed_image::color_type> cg::image_quantizer::refine(const image<color_space_t::RGB>& original, std::vector<indexed_image::color_type> palette,
+	const std::size_t iterations)
+{
+	check_palette_size(palette.size());
+
+	const auto& pixels = original.get_data();
+	const auto bounds = color_bounds(pixels);
+
+	for (std::size_t iteration = 0; iteration < iterations; ++iteration)
+	{
+		const palette_grid grid(palette, bounds);
+
+		// Assign every pixel to its nearest color and sum up the clusters privately per task
+		std::vector<cluster_sums> clusters(palette.size());
+		std::mutex merge_mutex;
+
+		thread_pool::shared().parallel_for(0, pixels.size(), pixel_grain, [&](const std::size_t first, const std::size_t last)
+		{
+			std::vector<cluster_sums> local(palette.size());
+
+			for (std::size_t index = first; index < last; ++index)
+			{
+				const auto& pixel = pixels[index];
+				auto& cluster = local[grid.nearest(pixel.data())];
+
+				++cluster.count;
+
+				for (std::size_t channel = 0; channel < 3; ++channel)
+				{
+					cluster.sum[channel] += pixel[channel];
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(merge_mutex);
+
+			for (std::size_t entry = 0; entry < palette.size(); ++entry)
+			{
+				clusters[entry].count += local[entry].count;
+
+				for (std::size_t channel = 0; channel < 3; ++channel)
+				{
+					clusters[entry].sum[channel] += local[entry].sum[channel];
+				}
+			}
+		});
+
+		// Move each color to the mean of its cluster; empty clusters keep their color
+		float movement = 0.f;
+
+		for (std::size_t entry = 0; entry < palette.size(); ++entry)
+		{
+			if (clusters[entry].count == 0)
+			{
+				continue;
+			}
+
+			for (std::size_t channel = 0; channel < 3; ++channel)
+			{
+				const auto mean = static_cast<float>(clusters[entry].sum[channel] / static_cast<double>(clusters[entry].count));
+
+				movement = std::max(movement, std::abs(mean - palette[entry][channel]));
+				palette[entry][channel] = mean;
+			}
+		}
+
+		if (movement < convergence_distance)
+		{
+			break;
+		}
+	}
+
+	return palette;
+}
+
+cg::indexed_image cg::image_quantizer::apply_palette(const image<color_space_t::RGB>& original, const std::vector<indexed_image::color_type>& palette)
+{
+	indexed_image quantized(original.get_width(), original.get_height(), palette);
+
+	const auto& pixels = original.get_data();
+	const palette_grid grid(palette, color_bounds(pixels));
+	auto& indices = quantized.get_indices();
+
+	thread_pool::shared().parallel_for(0, pixels.size(), pixel_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		for (std::size_t index = first; index < last; ++index)
+		{
+			indices[index] = grid.nearest(pixels[index].data());
+		}
+	});
+
+	return quantized;
+}
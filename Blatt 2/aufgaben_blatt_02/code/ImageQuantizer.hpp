@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Image.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cg
+{
+	/// <summary>
+	/// Image storing an 8-bit palette index per pixel
+	/// </summary>
+	class indexed_image
+	{
+	public:
+		/// Palette color (RGB)
+		using color_type = std::array<float, 3>;
+
+		/// <summary>
+		/// Constructor; all pixels refer to the first palette entry
+		/// </summary>
+		/// <param name="width">Width</param>
+		/// <param name="height">Height</param>
+		/// <param name="palette">Palette with 1 to 256 entries</param>
+		indexed_image(std::size_t width, std::size_t height, std::vector<color_type> palette);
+
+		/// <summary>
+		/// Get width
+		/// </summary>
+		/// <returns>Width</returns>
+		std::size_t get_width() const;
+
+		/// <summary>
+		/// Get height
+		/// </summary>
+		/// <returns>Height</returns>
+		std::size_t get_height() const;
+
+		/// <summary>
+		/// Get palette
+		/// </summary>
+		/// <returns>Palette</returns>
+		const std::vector<color_type>& get_palette() const;
+
+		/// <summary>
+		/// Get indices
+		/// </summary>
+		/// <returns>Row-major palette indices</returns>
+		const std::vector<std::uint8_t>& get_indices() const;
+		std::vector<std::uint8_t>& get_indices();
+
+		/// <summary>
+		/// Access the index of a pixel
+		/// </summary>
+		/// <param name="i">Column</param>
+		/// <param name="j">Row</param>
+		/// <returns>Palette index</returns>
+		std::uint8_t at(std::size_t i, std::size_t j) const;
+		std::uint8_t& at(std::size_t i, std::size_t j);
+
+		/// <summary>
+		/// Convert to an RGB image
+		/// </summary>
+		/// <returns>RGB image</returns>
+		image<color_space_t::RGB> to_rgb() const;
+
+	private:
+		std::size_t width;
+		std::size_t height;
+
+		/// Palette colors
+		std::vector<color_type> palette;
+
+		/// Palette index per pixel
+		std::vector<std::uint8_t> indices;
+	};
+
+	/// <summary>
+	/// Class for reducing RGB images to a palette of colors
+	/// The initial palette is found by median cut on a 15-bit color histogram and refined with
+	/// k-means. Nearest palette colors are looked up through a coarse 3D grid that stores the
+	/// palette entries that can be nearest for any color within a cell, so only a few distances
+	/// are computed per pixel. Histograms, assignment steps and the final mapping run on the shared
+	/// thread pool.
+	/// </summary>
+	class image_quantizer
+	{
+	public:
+		/// <summary>
+		/// Quantize an RGB image
+		/// </summary>
+		/// <param name="original">RGB image</param>
+		/// <param name="colors">Maximum number of palette colors (1 to 256)</param>
+		/// <param name="iterations">Maximum number of k-means iterations</param>
+		/// <returns>Indexed image</returns>
+		static indexed_image quantize(const image<color_space_t::RGB>& original, std::size_t colors = 256, std::size_t iterations = 8);
+
+		/// <summary>
+		/// Find a palette with median cut
+		/// </summary>
+		/// <param name="original">RGB image</param>
+		/// <param name="colors">Maximum number of palette colors (1 to 256)</param>
+		/// <returns>Palette; smaller than requested if the image has few distinct colors</returns>
+		static std::vector<indexed_image::color_type> median_cut(const image<color_space_t::RGB>& original, std::size_t colors = 256);
+
+		/// <summary>
+		/// Refine a palette with k-means
+		/// </summary>
+		/// <param name="original">RGB image</param>
+		/// <param name="palette">Initial palette</param>
+		/// <param name="iterations">Maximum number of iterations</param>
+		/// <returns>Refined palette</returns>
+		static std::vector<indexed_image::color_type> refine(const image<color_space_t::RGB>& original, std::vector<indexed_image::color_type> palette, std::size_t iterations);
+
+		/// <summary>
+		/// Map every pixel to the nearest palette color
+		/// </summary>
+		/// <param name="original">RGB image</param>
+		/// <param name="palette">Palette with 1 to 256 entries</param>
+		/// <returns>Indexed image</returns>
+		static indexed_image apply_palette(const image<color_space_t::RGB>& original, const std::vector<indexed_image::color_type>& palette);
+	};
+}
@@ -0,0 +1,290 @@
+#define _USE_MATH_DEFINES
+#include "ImageResampler.hpp"
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace cg
+{
+	namespace
+	{
+		/// Minimum number of rows processed by one task
+		constexpr std::size_t row_grain = 8;
+
+		/// <summary>
+		/// Precomputed filter taps of all output positions along one axis
+		/// </summary>
+		struct axis_weights
+		{
+			/// Number of taps per output position
+			std::size_t taps;
+
+			/// Source index and weight of each tap, output position major
+			std::vector<std::size_t> indices;
+			std::vector<float> weights;
+		};
+
+		/// <summary>
+		/// Get the radius of a reconstruction filter
+		/// </summary>
+		/// <param name="filter">Filter</param>
+		/// <returns>Radius in source pixels</returns>
+		double filter_radius(const resampling_filter_t filter)
+		{
+			switch (filter)
+			{
+			case resampling_filter_t::bilinear:
+				return 1.0;
+			case resampling_filter_t::bicubic:
+				return 2.0;
+			case resampling_filter_t::lanczos:
+			default:
+				return 3.0;
+			}
+		}
+
+		/// <summary>
+		/// Evaluate a reconstruction filter
+		/// </summary>
+		/// <param name="filter">Filter</param>
+		/// <param name="x">Distance from the filter center</param>
+		/// <returns>Filter value</returns>
+		double filter_value(const resampling_filter_t filter, double x)
+		{
+			x = std::abs(x);
+
+			switch (filter)
+			{
+			case resampling_filter_t::bilinear:
+				return (x < 1.0) ? 1.0 - x : 0.0;
+			case resampling_filter_t::bicubic:
+				// Catmull-Rom (a = -0.5)
+				if (x < 1.0)
+				{
+					return (1.5 * x - 2.5) * x * x + 1.0;
+				}
+
+				return (x < 2.0) ? ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0 : 0.0;
+			case resampling_filter_t::lanczos:
+			default:
+				if (x < 1e-8)
+				{
+					return 1.0;
+				}
+
+				return (x < 3.0) ? 3.0 * std::sin(M_PI * x) * std::sin(M_PI * x / 3.0) / (M_PI * M_PI * x * x) : 0.0;
+			}
+		}
+
+		/// <summary>
+		/// Compute the filter taps for resampling one axis
+		/// </summary>
+		/// <param name="source_size">Number of source pixels</param>
+		/// <param name="target_size">Number of target pixels</param>
+		/// <param name="filter">Reconstruction filter</param>
+		/// <returns>Filter taps</returns>
+		axis_weights compute_weights(const std::size_t source_size, const std::size_t target_size, const resampling_filter_t filter)
+		{
+			const double scale = static_cast<double>(source_size) / static_cast<double>(target_size);
+
+			// Widen the filter when shrinking, so that it also acts as low-pass filter
+			const double stretch = std::max(scale, 1.0);
+			const double radius = filter_radius(filter) * stretch;
+
+			axis_weights weights;
+			weights.taps = static_cast<std::size_t>(std::ceil(2.0 * radius)) + 1;
+			weights.indices.resize(target_size * weights.taps);
+			weights.weights.resize(target_size * weights.taps);
+
+			const auto last = static_cast<std::ptrdiff_t>(source_size) - 1;
+
+			for (std::size_t position = 0; position < target_size; ++position)
+			{
+				// Pixel centers are at integer source coordinates
+				const double center = (static_cast<double>(position) + 0.5) * scale - 0.5;
+				const auto first = static_cast<std::ptrdiff_t>(std::floor(center - radius)) + 1;
+
+				auto* indices = weights.indices.data() + position * weights.taps;
+				auto* values = weights.weights.data() + position * weights.taps;
+
+				double sum = 0.0;
+
+				for (std::size_t tap = 0; tap < weights.taps; ++tap)
+				{
+					const auto index = first + static_cast<std::ptrdiff_t>(tap);
+					const double value = filter_value(filter, (static_cast<double>(index) - center) / stretch);
+
+					indices[tap] = static_cast<std::size_t>(std::min(std::max(index, std::ptrdiff_t(0)), last));
+					values[tap] = static_cast<float>(value);
+					sum += value;
+				}
+
+				if (sum != 0.0)
+				{
+					for (std::size_t tap = 0; tap < weights.taps; ++tap)
+					{
+						values[tap] = static_cast<float>(values[tap] / sum);
+					}
+				}
+			}
+
+			return weights;
+		}
+
+		/// <summary>
+		/// Resample all rows horizontally
+		/// </summary>
+		/// <param name="source">Source pixel data</param>
+		/// <param name="source_width">Source width</param>
+		/// <param name="rows">Number of rows</param>
+		/// <param name="target">Target pixel data</param>
+		/// <param name="target_width">Target width</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		/// <param name="weights">Filter taps per target column</param>
+		void resample_rows(const float* source, const std::size_t source_width, const std::size_t rows, float* target, const std::size_t target_width,
+			const std::size_t channels, const axis_weights& weights)
+		{
+			thread_pool::shared().parallel_for(0, rows, row_grain, [&](const std::size_t first, const std::size_t last)
+			{
+				std::vector<float> sum(channels);
+
+				for (std::size_t j = first; j < last; ++j)
+				{
+					const float* in = source + j * source_width * channels;
+					float* out = target + j * target_width * channels;
+
+					for (std::size_t i = 0; i < target_width; ++i)
+					{
+						const auto* indices = weights.indices.data() + i * weights.taps;
+						const auto* values = weights.weights.data() + i * weights.taps;
+
+						std::fill(sum.begin(), sum.end(), 0.f);
+
+						for (std::size_t tap = 0; tap < weights.taps; ++tap)
+						{
+							const float* pixel = in + indices[tap] * channels;
+
+							for (std::size_t channel = 0; channel < channels; ++channel)
+							{
+								sum[channel] += values[tap] * pixel[channel];
+							}
+						}
+
+						std::copy(sum.begin(), sum.end(), out + i * channels);
+					}
+				}
+			});
+		}
+
+		/// <summary>
+		/// Resample all columns vertically; each target row is a weighted sum of whole source rows
+		/// </summary>
+		/// <param name="source">Source pixel data</param>
+		/// <param name="row_size">Number of floats per row</param>
+		/// <param name="target">Target pixel data</param>
+		/// <param name="target_height">Target height</param>
+		/// <param name="weights">Filter taps per target row</param>
+		void resample_columns(const float* source, const std::size_t row_size, float* target, const std::size_t target_height, const axis_weights& weights)
+		{
+			thread_pool::shared().parallel_for(0, target_height, row_grain, [&](const std::size_t first, const std::size_t last)
+			{
+				for (std::size_t j = first; j < last; ++j)
+				{
+					const auto* indices = weights.indices.data() + j * weights.taps;
+					const auto* values = weights.weights.data() + j * weights.taps;
+
+					float* out = target + j * row_size;
+					std::fill(out, out + row_size, 0.f);
+
+					for (std::size_t tap = 0; tap < weights.taps; ++tap)
+					{
+						const float weight = values[tap];
+						const float* in = source + indices[tap] * row_size;
+
+						for (std::size_t k = 0; k < row_size; ++k)
+						{
+							out[k] += weight * in[k];
+						}
+					}
+				}
+			});
+		}
+	}
+}
+
+void cg::image_resampler::resize(const float* source, const std::size_t source_width, const std::size_t source_height,
+	float* target, const std::size_t target_width, const std::size_t target_height, const std::size_t channels, const resampling_filter_t filter)
+{
+	if (target_width == 0 || target_height == 0)
+	{
+		return;
+	}
+
+	if (source_width == 0 || source_height == 0)
+	{
+		throw std::runtime_error("Unable to resize an empty image");
+	}
+
+	const auto horizontal = compute_weights(source_width, target_width, filter);
+	const auto vertical = compute_weights(source_height, target_height, filter);
+
+	// Choose the order of the passes that needs fewer multiply-adds
+	const double horizontal_first = static_cast<double>(source_height) * target_width * horizontal.taps + static_cast<double>(target_height) * target_width * vertical.taps;
+	const double vertical_first = static_cast<double>(source_width) * target_height * vertical.taps + static_cast<double>(target_height) * target_width * horizontal.taps;
+
+	if (horizontal_first <= vertical_first)
+	{
+		std::vector<float> intermediate(target_width * source_height * channels);
+
+		resample_rows(source, source_width, source_height, intermediate.data(), target_width, channels, horizontal);
+		resample_columns(intermediate.data(), target_width * channels, target, target_height, vertical);
+	}
+	else
+	{
+		std::vector<float> intermediate(source_width * target_height * channels);
+
+		resample_columns(source, source_width * channels, intermediate.data(), target_height, vertical);
+		resample_rows(intermediate.data(), source_width, target_height, target, target_width, channels, horizontal);
+	}
+}
+
+void cg::image_resampler::downsample(const float* source, const std::size_t source_width, const std::size_t source_height, float* target, const std::size_t channels)
+{
+	const std::size_t target_width = (source_width + 1) / 2;
+	const std::size_t target_height = (source_height + 1) / 2;
+	const std::size_t source_row = source_width * channels;
+
+	thread_pool::shared().parallel_for(0, target_height, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		std::vector<float> sum(source_row);
+
+		for (std::size_t j = first; j < last; ++j)
+		{
+			// Add the two source rows, then pairs of neighboring pixels
+			const float* upper = source + (2 * j) * source_row;
+			const float* lower = source + std::min(2 * j + 1, source_height - 1) * source_row;
+
+			for (std::size_t k = 0; k < source_row; ++k)
+			{
+				sum[k] = upper[k] + lower[k];
+			}
+
+			float* out = target + j * target_width * channels;
+
+			for (std::size_t i = 0; i < target_width; ++i)
+			{
+				const float* left = sum.data() + (2 * i) * channels;
+				const float* right = sum.data() + std::min(2 * i + 1, source_width - 1) * channels;
+
+				for (std::size_t channel = 0; channel < channels; ++channel)
+				{
+					out[i * channels + channel] = 0.25f * (left[channel] + right[channel]);
+				}
+			}
+		}
+	});
+}
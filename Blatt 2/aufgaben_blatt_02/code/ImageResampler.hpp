@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Image.hpp"
+#include "ImageTraits.hpp"
+
+#include <cstddef>
+
+namespace cg
+{
+	/// <summary>
+	/// Reconstruction filter used for resampling
+	/// </summary>
+	enum class resampling_filter_t
+	{
+		/// Linear interpolation (triangle filter, radius 1)
+		bilinear,
+
+		/// Catmull-Rom cubic (radius 2)
+		bicubic,
+
+		/// Lanczos windowed sinc (radius 3)
+		lanczos
+	};
+
+	/// <summary>
+	/// Class for resizing images
+	/// Resizing is done in two separable passes. The filter weights are computed once per output
+	/// column and row; when shrinking, the filter is widened to avoid aliasing. The passes are
+	/// split over output rows on the shared thread pool.
+	/// </summary>
+	class image_resampler
+	{
+	public:
+		/// <summary>
+		/// Resize an image
+		/// The bicubic and Lanczos filters have negative lobes, so values next to sharp edges may
+		/// overshoot the range of the input (by more than 10 % for Lanczos). They are not clamped, as the valid
+		/// range depends on the color space; the image savers clamp to [0, 1].
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <param name="width">New width</param>
+		/// <param name="height">New height</param>
+		/// <param name="filter">Reconstruction filter</param>
+		/// <returns>Resized image</returns>
+		template <color_space_t color_space>
+		static image<color_space> resize(const image<color_space>& original, std::size_t width, std::size_t height, resampling_filter_t filter = resampling_filter_t::bicubic);
+
+		/// <summary>
+		/// Halve the size of an image by averaging 2x2 blocks
+		/// For odd sizes, the last row/column is repeated.
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <returns>Image of size ceil(width / 2) x ceil(height / 2)</returns>
+		template <color_space_t color_space>
+		static image<color_space> downsample(const image<color_space>& original);
+
+	private:
+		/// <summary>
+		/// Resize interleaved pixel data
+		/// </summary>
+		/// <param name="source">Source pixel data</param>
+		/// <param name="source_width">Source width</param>
+		/// <param name="source_height">Source height</param>
+		/// <param name="target">Target pixel data</param>
+		/// <param name="target_width">Target width</param>
+		/// <param name="target_height">Target height</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		/// <param name="filter">Reconstruction filter</param>
+		static void resize(const float* source, std::size_t source_width, std::size_t source_height,
+			float* target, std::size_t target_width, std::size_t target_height, std::size_t channels, resampling_filter_t filter);
+
+		/// <summary>
+		/// Halve the size of interleaved pixel data
+		/// </summary>
+		/// <param name="source">Source pixel data</param>
+		/// <param name="source_width">Source width</param>
+		/// <param name="source_height">Source height</param>
+		/// <param name="target">Target pixel data</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		static void downsample(const float* source, std::size_t source_width, std::size_t source_height, float* target, std::size_t channels);
+	};
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_resampler::resize(const image<color_space>& original, const std::size_t width, const std::size_t height, const resampling_filter_t filter)
+{
+	image<color_space> resized(width, height);
+	resize(original.get_values(), original.get_width(), original.get_height(),
+		resized.get_values(), width, height, color_channels<color_space>::value, filter);
+
+	return resized;
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_resampler::downsample(const image<color_space>& original)
+{
+	image<color_space> downsampled((original.get_width() + 1) / 2, (original.get_height() + 1) / 2);
+	downsample(original.get_values(), original.get_width(), original.get_height(),
+		downsampled.get_values(), color_channels<color_space>::value);
+
+	return downsampled;
+}
@@ -3,9 +3,10 @@
 namespace cg
 {
 	/// Color space
+	/// RGBA images store the color premultiplied by alpha.
 	enum class color_space_t
 	{
-		BW, Gray, RGB, HSV
+		BW, Gray, RGB, HSV, RGBA
 	};
 
 	template <color_space_t color_space>
@@ -25,4 +26,10 @@ namespace cg
 	{
 		static constexpr unsigned int value = 1;
 	};
+
+	template <>
+	struct color_channels<color_space_t::RGBA>
+	{
+		static constexpr unsigned int value = 4;
+	};
 }
\ No newline at end of file
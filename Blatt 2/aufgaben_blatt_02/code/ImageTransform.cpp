@@ -0,0 +1,247 @@
+#include "ImageTransform.hpp"
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define CG_TRANSFORM_SSE
+#endif
+
+namespace cg
+{
+	namespace
+	{
+		/// Edge length of the square tiles in pixels (a 32x32 RGB tile occupies 12 KiB)
+		constexpr std::size_t tile_size = 32;
+
+		/// Minimum number of rows mirrored by one task
+		constexpr std::size_t row_grain = 16;
+
+		/// <summary>
+		/// Copy a pixel
+		/// </summary>
+		/// <param name="source">Source pixel</param>
+		/// <param name="target">Target pixel</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		inline void copy_pixel(const float* source, float* target, const std::size_t channels)
+		{
+			for (std::size_t channel = 0; channel < channels; ++channel)
+			{
+				target[channel] = source[channel];
+			}
+		}
+
+		/// <summary>
+		/// Swap two pixels
+		/// </summary>
+		/// <param name="first">First pixel</param>
+		/// <param name="second">Second pixel</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		inline void swap_pixels(float* first, float* second, const std::size_t channels)
+		{
+			for (std::size_t channel = 0; channel < channels; ++channel)
+			{
+				std::swap(first[channel], second[channel]);
+			}
+		}
+
+#ifdef CG_TRANSFORM_SSE
+		/// <summary>
+		/// Transpose a 4x4 block of single-channel pixels in registers
+		/// </summary>
+		/// <param name="source">Upper left source value</param>
+		/// <param name="source_stride">Number of floats per source row</param>
+		/// <param name="target">First target value: the upper left one, or the upper right one if reversed</param>
+		/// <param name="target_stride">Number of floats between target rows (negative to reverse the rows)</param>
+		/// <param name="reverse_columns">Store each target row in reverse order, ending at target</param>
+		inline void transpose_4x4(const float* source, const std::size_t source_stride, float* target, const std::ptrdiff_t target_stride, const bool reverse_columns)
+		{
+			__m128 row0 = _mm_loadu_ps(source);
+			__m128 row1 = _mm_loadu_ps(source + source_stride);
+			__m128 row2 = _mm_loadu_ps(source + 2 * source_stride);
+			__m128 row3 = _mm_loadu_ps(source + 3 * source_stride);
+
+			_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+			if (reverse_columns)
+			{
+				row0 = _mm_shuffle_ps(row0, row0, _MM_SHUFFLE(0, 1, 2, 3));
+				row1 = _mm_shuffle_ps(row1, row1, _MM_SHUFFLE(0, 1, 2, 3));
+				row2 = _mm_shuffle_ps(row2, row2, _MM_SHUFFLE(0, 1, 2, 3));
+				row3 = _mm_shuffle_ps(row3, row3, _MM_SHUFFLE(0, 1, 2, 3));
+				target -= 3;
+			}
+
+			_mm_storeu_ps(target, row0);
+			_mm_storeu_ps(target + target_stride, row1);
+			_mm_storeu_ps(target + 2 * target_stride, row2);
+			_mm_storeu_ps(target + 3 * target_stride, row3);
+		}
+#endif
+	}
+}
+
+void cg::image_transform::transpose(const float* source, const std::size_t width, const std::size_t height, float* target, const std::size_t channels,
+	const bool reverse_columns, const bool reverse_rows)
+{
+	// Target rows correspond to source columns; every task writes the target rows of one column of tiles
+	const std::size_t tile_columns = (width + tile_size - 1) / tile_size;
+
+	const std::size_t source_stride = width * channels;
+	const std::size_t target_stride = height * channels;
+
+	// Position of source pixel (x, y) in the target
+	const auto target_pixel = [&](const std::size_t x, const std::size_t y)
+	{
+		const std::size_t row = reverse_rows ? width - 1 - x : x;
+		const std::size_t column = reverse_columns ? height - 1 - y : y;
+
+		return target + row * target_stride + column * channels;
+	};
+
+	thread_pool::shared().parallel_for(0, tile_columns, 1, [&](const std::size_t first, const std::size_t last)
+	{
+		for (std::size_t x0 = first * tile_size; x0 < std::min(last * tile_size, width); x0 += tile_size)
+		{
+			const std::size_t x1 = std::min(x0 + tile_size, width);
+
+			for (std::size_t y0 = 0; y0 < height; y0 += tile_size)
+			{
+				const std::size_t y1 = std::min(y0 + tile_size, height);
+
+				std::size_t x_end = x0;
+				std::size_t y_end = y0;
+
+#ifdef CG_TRANSFORM_SSE
+				if (channels == 1)
+				{
+					// Full 4x4 blocks in registers; the remaining stripes are copied below
+					x_end = x0 + (x1 - x0) / 4 * 4;
+					y_end = y0 + (y1 - y0) / 4 * 4;
+
+					const auto stride = reverse_rows ? -static_cast<std::ptrdiff_t>(target_stride) : static_cast<std::ptrdiff_t>(target_stride);
+
+					for (std::size_t x = x0; x < x_end; x += 4)
+					{
+						for (std::size_t y = y0; y < y_end; y += 4)
+						{
+							transpose_4x4(source + y * source_stride + x, source_stride, target_pixel(x, y), stride, reverse_columns);
+						}
+					}
+				}
+#endif
+
+				// Pixels not covered by register blocks: columns [x_end, x1) of all rows, rows [y_end, y1) of columns [x0, x_end)
+				for (std::size_t x = x0; x < x1; ++x)
+				{
+					for (std::size_t y = (x < x_end) ? y_end : y0; y < y1; ++y)
+					{
+						copy_pixel(source + y * source_stride + x * channels, target_pixel(x, y), channels);
+					}
+				}
+			}
+		}
+	});
+}
+
+void cg::image_transform::flip(const float* source, const std::size_t width, const std::size_t height, float* target, const std::size_t channels,
+	const bool reverse_columns, const bool reverse_rows)
+{
+	const std::size_t row_size = width * channels;
+
+	if (source != target)
+	{
+		thread_pool::shared().parallel_for(0, height, row_grain, [&](const std::size_t first, const std::size_t last)
+		{
+			for (std::size_t j = first; j < last; ++j)
+			{
+				const float* in = source + (reverse_rows ? height - 1 - j : j) * row_size;
+				float* out = target + j * row_size;
+
+				if (reverse_columns)
+				{
+					for (std::size_t i = 0; i < width; ++i)
+					{
+						copy_pixel(in + (width - 1 - i) * channels, out + i * channels, channels);
+					}
+				}
+				else
+				{
+					std::memcpy(out, in, row_size * sizeof(float));
+				}
+			}
+		});
+
+		return;
+	}
+
+	// In place: every task swaps pairs of rows (or pixels within a row), so that no value is touched twice
+	const std::size_t rows = reverse_rows ? (height + 1) / 2 : height;
+
+	thread_pool::shared().parallel_for(0, rows, row_grain, [&](const std::size_t first, const std::size_t last)
+	{
+		for (std::size_t j = first; j < last; ++j)
+		{
+			float* upper = target + j * row_size;
+			float* lower = target + (reverse_rows ? height - 1 - j : j) * row_size;
+
+			if (reverse_columns)
+			{
+				// Within the same row, only the left half is swapped with the right half
+				const std::size_t count = (upper == lower) ? width / 2 : width;
+
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					swap_pixels(upper + i * channels, lower + (width - 1 - i) * channels, channels);
+				}
+			}
+			else if (upper != lower)
+			{
+				std::swap_ranges(upper, upper + row_size, lower);
+			}
+		}
+	});
+}
+
+void cg::image_transform::transpose_in_place(float* data, const std::size_t size, const std::size_t channels)
+{
+	const std::size_t tiles = (size + tile_size - 1) / tile_size;
+	const std::size_t stride = size * channels;
+
+	// Task for tile row a swaps the tiles (a, b) and (b, a) for all b >= a
+	thread_pool::shared().parallel_for(0, tiles, 1, [&](const std::size_t first, const std::size_t last)
+	{
+		for (std::size_t a = first; a < last; ++a)
+		{
+			const std::size_t y0 = a * tile_size;
+			const std::size_t y1 = std::min(y0 + tile_size, size);
+
+			for (std::size_t b = a; b < tiles; ++b)
+			{
+				const std::size_t x0 = b * tile_size;
+				const std::size_t x1 = std::min(x0 + tile_size, size);
+
+				for (std::size_t y = y0; y < y1; ++y)
+				{
+					// On diagonal tiles, only the part above the diagonal is swapped
+					for (std::size_t x = (a == b) ? y + 1 : x0; x < x1; ++x)
+					{
+						swap_pixels(data + y * stride + x * channels, data + x * stride + y * channels, channels);
+					}
+				}
+			}
+		}
+	});
+}
+
+void cg::image_transform::require_square(const image_base& target)
+{
+	if (target.get_width() != target.get_height())
+	{
+		throw std::runtime_error("In-place transpose and rotation require a square image");
+	}
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include "Image.hpp"
+#include "ImageTraits.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace cg
+{
+	/// <summary>
+	/// Class for transposing, rotating and flipping images
+	/// Transposes and 90 degree rotations copy the image in tiles that fit into the L1 cache, so that
+	/// reads and writes stay local although one of them runs across rows; single-channel tiles are
+	/// transposed in 4x4 SSE registers. Flips only move whole pixels within and between rows.
+	/// Tiles or rows are distributed over the shared thread pool.
+	/// </summary>
+	class image_transform
+	{
+	public:
+		/// <summary>
+		/// Transpose an image (mirror at the main diagonal)
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <returns>Transposed image of size height x width</returns>
+		template <color_space_t color_space>
+		static image<color_space> transpose(const image<color_space>& original);
+
+		/// <summary>
+		/// Rotate an image by 90 degrees clockwise
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <returns>Rotated image of size height x width</returns>
+		template <color_space_t color_space>
+		static image<color_space> rotate_90(const image<color_space>& original);
+
+		/// <summary>
+		/// Rotate an image by 180 degrees
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <returns>Rotated image</returns>
+		template <color_space_t color_space>
+		static image<color_space> rotate_180(const image<color_space>& original);
+
+		/// <summary>
+		/// Rotate an image by 270 degrees clockwise (90 degrees counter-clockwise)
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <returns>Rotated image of size height x width</returns>
+		template <color_space_t color_space>
+		static image<color_space> rotate_270(const image<color_space>& original);
+
+		/// <summary>
+		/// Mirror an image horizontally (left becomes right)
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <returns>Flipped image</returns>
+		template <color_space_t color_space>
+		static image<color_space> flip_horizontal(const image<color_space>& original);
+
+		/// <summary>
+		/// Mirror an image vertically (top becomes bottom)
+		/// </summary>
+		/// <param name="original">Original image</param>
+		/// <returns>Flipped image</returns>
+		template <color_space_t color_space>
+		static image<color_space> flip_vertical(const image<color_space>& original);
+
+		/// <summary>
+		/// Transpose a square image in place
+		/// </summary>
+		/// <param name="target">Square image</param>
+		template <color_space_t color_space>
+		static void transpose_in_place(image<color_space>& target);
+
+		/// <summary>
+		/// Rotate a square image by 90 degrees clockwise in place
+		/// </summary>
+		/// <param name="target">Square image</param>
+		template <color_space_t color_space>
+		static void rotate_90_in_place(image<color_space>& target);
+
+		/// <summary>
+		/// Rotate an image by 180 degrees in place
+		/// </summary>
+		/// <param name="target">Image</param>
+		template <color_space_t color_space>
+		static void rotate_180_in_place(image<color_space>& target);
+
+		/// <summary>
+		/// Rotate a square image by 270 degrees clockwise in place
+		/// </summary>
+		/// <param name="target">Square image</param>
+		template <color_space_t color_space>
+		static void rotate_270_in_place(image<color_space>& target);
+
+		/// <summary>
+		/// Mirror an image horizontally in place
+		/// </summary>
+		/// <param name="target">Image</param>
+		template <color_space_t color_space>
+		static void flip_horizontal_in_place(image<color_space>& target);
+
+		/// <summary>
+		/// Mirror an image vertically in place
+		/// </summary>
+		/// <param name="target">Image</param>
+		template <color_space_t color_space>
+		static void flip_vertical_in_place(image<color_space>& target);
+
+	private:
+		/// <summary>
+		/// Copy interleaved pixel data with rows and columns swapped
+		/// Source pixel (x, y) is written to target column (reverse_columns ? height - 1 - y : y)
+		/// of target row (reverse_rows ? width - 1 - x : x).
+		/// </summary>
+		/// <param name="source">Source pixel data</param>
+		/// <param name="width">Source width</param>
+		/// <param name="height">Source height</param>
+		/// <param name="target">Target pixel data of size height x width</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		/// <param name="reverse_columns">Reverse the order of the target columns</param>
+		/// <param name="reverse_rows">Reverse the order of the target rows</param>
+		static void transpose(const float* source, std::size_t width, std::size_t height, float* target, std::size_t channels, bool reverse_columns, bool reverse_rows);
+
+		/// <summary>
+		/// Copy interleaved pixel data, optionally mirrored
+		/// Source and target may be identical.
+		/// </summary>
+		/// <param name="source">Source pixel data</param>
+		/// <param name="width">Width</param>
+		/// <param name="height">Height</param>
+		/// <param name="target">Target pixel data</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		/// <param name="reverse_columns">Reverse the order of the pixels within each row</param>
+		/// <param name="reverse_rows">Reverse the order of the rows</param>
+		static void flip(const float* source, std::size_t width, std::size_t height, float* target, std::size_t channels, bool reverse_columns, bool reverse_rows);
+
+		/// <summary>
+		/// Transpose square interleaved pixel data in place
+		/// </summary>
+		/// <param name="data">Pixel data</param>
+		/// <param name="size">Width and height</param>
+		/// <param name="channels">Number of channels per pixel</param>
+		static void transpose_in_place(float* data, std::size_t size, std::size_t channels);
+
+		/// <summary>
+		/// Make sure an image is square
+		/// </summary>
+		/// <param name="target">Image</param>
+		static void require_square(const image_base& target);
+	};
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_transform::transpose(const image<color_space>& original)
+{
+	image<color_space> transposed(original.get_height(), original.get_width());
+	transpose(original.get_values(), original.get_width(), original.get_height(), transposed.get_values(), color_channels<color_space>::value, false, false);
+
+	return transposed;
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_transform::rotate_90(const image<color_space>& original)
+{
+	image<color_space> rotated(original.get_height(), original.get_width());
+	transpose(original.get_values(), original.get_width(), original.get_height(), rotated.get_values(), color_channels<color_space>::value, true, false);
+
+	return rotated;
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_transform::rotate_180(const image<color_space>& original)
+{
+	image<color_space> rotated(original.get_width(), original.get_height());
+	flip(original.get_values(), original.get_width(), original.get_height(), rotated.get_values(), color_channels<color_space>::value, true, true);
+
+	return rotated;
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_transform::rotate_270(const image<color_space>& original)
+{
+	image<color_space> rotated(original.get_height(), original.get_width());
+	transpose(original.get_values(), original.get_width(), original.get_height(), rotated.get_values(), color_channels<color_space>::value, false, true);
+
+	return rotated;
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_transform::flip_horizontal(const image<color_space>& original)
+{
+	image<color_space> flipped(original.get_width(), original.get_height());
+	flip(original.get_values(), original.get_width(), original.get_height(), flipped.get_values(), color_channels<color_space>::value, true, false);
+
+	return flipped;
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::image_transform::flip_vertical(const image<color_space>& original)
+{
+	image<color_space> flipped(original.get_width(), original.get_height());
+	flip(original.get_values(), original.get_width(), original.get_height(), flipped.get_values(), color_channels<color_space>::value, false, true);
+
+	return flipped;
+}
+
+template <cg::color_space_t color_space>
+inline void cg::image_transform::transpose_in_place(image<color_space>& target)
+{
+	require_square(target);
+	transpose_in_place(target.get_values(), target.get_width(), color_channels<color_space>::value);
+}
+
+template <cg::color_space_t color_space>
+inline void cg::image_transform::rotate_90_in_place(image<color_space>& target)
+{
+	require_square(target);
+	transpose_in_place(target.get_values(), target.get_width(), color_channels<color_space>::value);
+	flip(target.get_values(), target.get_width(), target.get_height(), target.get_values(), color_channels<color_space>::value, true, false);
+}
+
+template <cg::color_space_t color_space>
+inline void cg::image_transform::rotate_180_in_place(image<color_space>& target)
+{
+	flip(target.get_values(), target.get_width(), target.get_height(), target.get_values(), color_channels<color_space>::value, true, true);
+}
+
+template <cg::color_space_t color_space>
+inline void cg::image_transform::rotate_270_in_place(image<color_space>& target)
+{
+	require_square(target);
+	transpose_in_place(target.get_values(), target.get_width(), color_channels<color_space>::value);
+	flip(target.get_values(), target.get_width(), target.get_height(), target.get_values(), color_channels<color_space>::value, false, true);
+}
+
+template <cg::color_space_t color_space>
+inline void cg::image_transform::flip_horizontal_in_place(image<color_space>& target)
+{
+	flip(target.get_values(), target.get_width(), target.get_height(), target.get_values(), color_channels<color_space>::value, true, false);
+}
+
+template <cg::color_space_t color_space>
+inline void cg::image_transform::flip_vertical_in_place(image<color_space>& target)
+{
+	flip(target.get_values(), target.get_width(), target.get_height(), target.get_values(), color_channels<color_space>::value, false, true);
+}
+
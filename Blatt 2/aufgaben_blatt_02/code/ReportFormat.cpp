@@ -0,0 +1,27 @@
+#include "ReportFormat.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+std::string cg::escape_json(const std::string& text)
+{
+	std::ostringstream escaped;
+
+	for (const char character : text)
+	{
+		if (character == '"' || character == '\\')
+		{
+			escaped << '\\' << character;
+		}
+		else if (static_cast<unsigned char>(character) < 0x20)
+		{
+			escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(character) << std::dec;
+		}
+		else
+		{
+			escaped << character;
+		}
+	}
+
+	return escaped.str();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+namespace cg
+{
+	/// <summary>
+	/// Output format of instrumentation reports
+	/// </summary>
+	enum class report_format_t
+	{
+		/// Aligned table for humans
+		Text,
+		/// One JSON object per line (JSON lines)
+		JSON
+	};
+
+	/// <summary>
+	/// Escape a string for JSON
+	/// Quotes and backslashes are prefixed with a backslash, control characters are written as \u00XX.
+	/// </summary>
+	/// <param name="text">Text</param>
+	/// <returns>Escaped text (without quotes)</returns>
+	std::string escape_json(const std::string& text);
+}
@@ -0,0 +1,238 @@
+#include "StageProfiler.hpp"
+
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace cg
+{
+	namespace
+	{
+		/// <summary>
+		/// Divide by a duration, treating durations below the clock resolution as unmeasurable
+		/// </summary>
+		/// <param name="amount">Amount of work</param>
+		/// <param name="seconds">Duration</param>
+		/// <returns>Rate per second (0 if the duration is zero)</returns>
+		double rate(const std::uint64_t amount, const double seconds)
+		{
+			return (seconds > 0.0) ? static_cast<double>(amount) / seconds : 0.0;
+		}
+
+		/// <summary>
+		/// Write one stage as a JSON object
+		/// </summary>
+		/// <param name="out">Stream</param>
+		/// <param name="job">Name of the job</param>
+		/// <param name="recorded">Stage</param>
+		void write_json(std::ostream& out, const std::string& job, const stage_profiler::stage& recorded)
+		{
+			out << "{\"job\":\"" << escape_json(job) << "\",\"stage\":\"" << escape_json(recorded.name) << "\",\"operation\":\"" << escape_json(recorded.operation)
+				<< "\",\"wall_seconds\":" << recorded.wall_seconds << ",\"cpu_seconds\":" << recorded.cpu_seconds
+				<< ",\"pixels\":" << recorded.pixels << ",\"bytes\":" << recorded.bytes
+				<< ",\"megapixels_per_second\":" << rate(recorded.pixels, recorded.wall_seconds) / 1e6
+				<< ",\"bytes_per_second\":" << rate(recorded.bytes, recorded.wall_seconds);
+		}
+
+		/// <summary>
+		/// Write one stage as a table row
+		/// </summary>
+		/// <param name="out">Stream</param>
+		/// <param name="recorded">Stage</param>
+		void write_text(std::ostream& out, const stage_profiler::stage& recorded)
+		{
+			out << std::left << std::setw(10) << recorded.name << std::setw(20) << recorded.operation << std::right << std::fixed << std::setprecision(2)
+				<< std::setw(11) << recorded.wall_seconds * 1e3 << std::setw(11) << recorded.cpu_seconds * 1e3
+				<< std::setw(12) << recorded.pixels << std::setw(14) << recorded.bytes
+				<< std::setw(10) << rate(recorded.pixels, recorded.wall_seconds) / 1e6 << std::setw(10) << rate(recorded.bytes, recorded.wall_seconds) / 1e6 << std::endl;
+		}
+	}
+}
+
+cg::stage_profiler::stage_profiler(const std::string& job, const bool enabled) : job(job), enabled(enabled), cpu_start(0.0)
+{
+}
+
+bool cg::stage_profiler::is_enabled() const
+{
+	return this->enabled;
+}
+
+void cg::stage_profiler::begin(const std::string& name, const std::string& operation)
+{
+	if (!this->enabled)
+	{
+		return;
+	}
+
+	this->current_name = name;
+	this->current_operation = operation;
+	this->cpu_start = cpu_time();
+	this->wall_start = std::chrono::steady_clock::now();
+}
+
+void cg::stage_profiler::end(const std::uint64_t pixels, const std::uint64_t bytes)
+{
+	if (!this->enabled)
+	{
+		return;
+	}
+
+	const auto wall_end = std::chrono::steady_clock::now();
+	const double cpu_end = cpu_time();
+
+	stage recorded;
+	recorded.name = this->current_name;
+	recorded.operation = this->current_operation;
+	recorded.wall_seconds = std::chrono::duration<double>(wall_end - this->wall_start).count();
+	recorded.cpu_seconds = cpu_end - this->cpu_start;
+	recorded.pixels = pixels;
+	recorded.bytes = bytes;
+
+	this->stages.push_back(recorded);
+}
+
+const std::vector<cg::stage_profiler::stage>& cg::stage_profiler::get_stages() const
+{
+	return this->stages;
+}
+
+void cg::stage_profiler::report(std::ostream& out, const report_format_t format) const
+{
+	if (!this->enabled)
+	{
+		return;
+	}
+
+	stage total;
+	total.name = "total";
+	total.wall_seconds = 0.0;
+	total.cpu_seconds = 0.0;
+	total.pixels = 0;
+	total.bytes = 0;
+
+	for (const auto& recorded : this->stages)
+	{
+		total.wall_seconds += recorded.wall_seconds;
+		total.cpu_seconds += recorded.cpu_seconds;
+		total.pixels += recorded.pixels;
+		total.bytes += recorded.bytes;
+	}
+
+	const std::uint64_t rss = peak_rss();
+
+	// Format into a buffer first, so that the report is not interleaved with other output and the stream state is kept
+	std::ostringstream buffer;
+
+	if (format == report_format_t::JSON)
+	{
+		buffer << std::setprecision(6);
+
+		for (const auto& recorded : this->stages)
+		{
+			write_json(buffer, this->job, recorded);
+			buffer << "}" << std::endl;
+		}
+
+		write_json(buffer, this->job, total);
+		buffer << ",\"peak_rss_bytes\":" << rss << "}" << std::endl;
+	}
+	else
+	{
+		buffer << "Stage report: " << this->job << std::endl;
+		buffer << std::left << std::setw(10) << "stage" << std::setw(20) << "operation" << std::right << std::setw(11) << "wall ms" << std::setw(11) << "cpu ms"
+			<< std::setw(12) << "pixels" << std::setw(14) << "bytes" << std::setw(10) << "MP/s" << std::setw(10) << "MB/s" << std::endl;
+
+		for (const auto& recorded : this->stages)
+		{
+			write_text(buffer, recorded);
+		}
+
+		write_text(buffer, total);
+		buffer << "Peak RSS: " << std::fixed << std::setprecision(1) << static_cast<double>(rss) / (1024.0 * 1024.0) << " MiB" << std::endl;
+	}
+
+	out << buffer.str() << std::flush;
+}
+
+std::uint64_t cg::stage_profiler::pixels(const image_base& original)
+{
+	return static_cast<std::uint64_t>(original.get_width()) * static_cast<std::uint64_t>(original.get_height());
+}
+
+std::uint64_t cg::stage_profiler::file_size(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+	return file.good() ? static_cast<std::uint64_t>(file.tellg()) : 0;
+}
+
+std::uint64_t cg::stage_profiler::peak_rss()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return static_cast<std::uint64_t>(counters.PeakWorkingSetSize);
+	}
+
+	return 0;
+#elif defined(__unix__) || defined(__APPLE__)
+	rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+
+#if defined(__APPLE__)
+	// Bytes on macOS
+	return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+	// Kilobytes on Linux and the BSDs
+	return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+	return 0;
+#endif
+}
+
+double cg::stage_profiler::cpu_time()
+{
+#if defined(_WIN32)
+	FILETIME creation, exit, kernel, user;
+
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+	{
+		return 0.0;
+	}
+
+	// Both times are given in 100 ns units
+	const auto ticks = [](const FILETIME& time) { return (static_cast<std::uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+
+	return static_cast<double>(ticks(kernel) + ticks(user)) * 1e-7;
+#elif defined(__unix__) || defined(__APPLE__)
+	rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0.0;
+	}
+
+	return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#else
+	const std::clock_t ticks = std::clock();
+
+	return (ticks != static_cast<std::clock_t>(-1)) ? static_cast<double>(ticks) / CLOCKS_PER_SEC : 0.0;
+#endif
+}
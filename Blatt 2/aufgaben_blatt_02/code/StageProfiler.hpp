@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Image.hpp"
+#include "ReportFormat.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cg
+{
+	/// <summary>
+	/// Records wall and CPU time, pixels and bytes of the stages of an image job (load, convert, effect, save)
+	/// CPU time is the time of the whole process, so it includes all threads of the pool and exceeds the wall
+	/// time when stages run in parallel. A disabled profiler records nothing, so jobs can be instrumented
+	/// unconditionally.
+	/// </summary>
+	class stage_profiler
+	{
+	public:
+		/// <summary>
+		/// Recorded stage
+		/// </summary>
+		struct stage
+		{
+			/// Kind of stage (load, convert, effect, save)
+			std::string name;
+
+			/// Function executed in the stage
+			std::string operation;
+
+			/// Elapsed wall clock and process CPU time
+			double wall_seconds;
+			double cpu_seconds;
+
+			/// Pixels and bytes processed (file size for I/O, pixel data read and written otherwise)
+			std::uint64_t pixels;
+			std::uint64_t bytes;
+		};
+
+		/// <summary>
+		/// Constructor
+		/// </summary>
+		/// <param name="job">Name of the job, included in every report line</param>
+		/// <param name="enabled">Record stages</param>
+		explicit stage_profiler(const std::string& job, bool enabled = true);
+
+		/// <summary>
+		/// Check whether stages are recorded
+		/// </summary>
+		/// <returns>True if enabled</returns>
+		bool is_enabled() const;
+
+		/// <summary>
+		/// Start a stage
+		/// </summary>
+		/// <param name="name">Kind of stage</param>
+		/// <param name="operation">Function executed in the stage</param>
+		void begin(const std::string& name, const std::string& operation);
+
+		/// <summary>
+		/// Finish the current stage
+		/// </summary>
+		/// <param name="pixels">Number of pixels processed</param>
+		/// <param name="bytes">Number of bytes processed</param>
+		void end(std::uint64_t pixels, std::uint64_t bytes);
+
+		/// <summary>
+		/// Get the recorded stages
+		/// </summary>
+		/// <returns>Stages in the order they were finished</returns>
+		const std::vector<stage>& get_stages() const;
+
+		/// <summary>
+		/// Write the stages, their total and the peak resident set size
+		/// JSON reports have one object per stage and a final one for the total.
+		/// </summary>
+		/// <param name="out">Stream (e.g. std::cerr)</param>
+		/// <param name="format">Output format</param>
+		void report(std::ostream& out, report_format_t format) const;
+
+		/// <summary>
+		/// Get the number of pixels of an image
+		/// </summary>
+		/// <param name="original">Image</param>
+		/// <returns>Width times height</returns>
+		static std::uint64_t pixels(const image_base& original);
+
+		/// <summary>
+		/// Get the size of the pixel data of an image
+		/// </summary>
+		/// <param name="original">Image</param>
+		/// <returns>Size in bytes</returns>
+		template <color_space_t color_space>
+		static std::uint64_t bytes(const image<color_space>& original);
+
+		/// <summary>
+		/// Get the size of a file
+		/// </summary>
+		/// <param name="path">Path</param>
+		/// <returns>Size in bytes (0 if the file does not exist)</returns>
+		static std::uint64_t file_size(const std::string& path);
+
+		/// <summary>
+		/// Get the largest resident set size of the process so far
+		/// </summary>
+		/// <returns>Size in bytes (0 if unavailable on this platform)</returns>
+		static std::uint64_t peak_rss();
+
+		/// <summary>
+		/// Get the CPU time used by all threads of the process so far
+		/// Uses getrusage on POSIX and GetProcessTimes on Windows, where std::clock measures wall time.
+		/// </summary>
+		/// <returns>User and system time in seconds</returns>
+		static double cpu_time();
+
+	private:
+		/// Name of the job
+		std::string job;
+
+		/// Record stages
+		bool enabled;
+
+		/// Finished stages
+		std::vector<stage> stages;
+
+		/// Name, operation and start of the current stage
+		std::string current_name;
+		std::string current_operation;
+		std::chrono::steady_clock::time_point wall_start;
+		double cpu_start;
+	};
+}
+
+template <cg::color_space_t color_space>
+inline std::uint64_t cg::stage_profiler::bytes(const image<color_space>& original)
+{
+	return static_cast<std::uint64_t>(original.get_data().size() * sizeof(typename image<color_space>::tuple_type));
+}
@@ -0,0 +1,248 @@
+#include "ThreadPool.hpp"
+
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace cg
+{
+	namespace
+	{
+		/// Pool and queue index of the current worker thread (nullptr for other threads)
+		thread_local thread_pool* current_pool = nullptr;
+		thread_local std::size_t current_index = 0;
+
+		/// <summary>
+		/// Completion state of a batch of tasks
+		/// </summary>
+		struct batch
+		{
+			std::atomic<std::size_t> remaining;
+			std::mutex mutex;
+			std::condition_variable done;
+			std::exception_ptr error;
+		};
+	}
+}
+
+cg::thread_pool::thread_pool(const std::size_t thread_count) : pending(0), next_queue(0), stopping(false)
+{
+	std::size_t count = thread_count;
+
+	if (count == 0)
+	{
+		count = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// The calling thread participates, so one thread less is needed
+	for (std::size_t index = 0; index + 1 < count; ++index)
+	{
+		this->queues.emplace_back(new task_queue());
+	}
+
+	for (std::size_t index = 0; index + 1 < count; ++index)
+	{
+		this->workers.emplace_back(&thread_pool::work, this, index);
+	}
+}
+
+cg::thread_pool::~thread_pool()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->wake_mutex);
+		this->stopping = true;
+	}
+
+	this->wake.notify_all();
+
+	for (auto& worker : this->workers)
+	{
+		worker.join();
+	}
+}
+
+cg::thread_pool& cg::thread_pool::shared()
+{
+	static thread_pool pool;
+	return pool;
+}
+
+std::size_t cg::thread_pool::get_thread_count() const
+{
+	return this->workers.size() + 1;
+}
+
+void cg::thread_pool::run(const std::size_t count, const std::function<void(std::size_t)>& task)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// Without workers or for a single task, there is nothing to distribute
+	if (this->workers.empty() || count == 1)
+	{
+		for (std::size_t index = 0; index < count; ++index)
+		{
+			CG_TRACE_SCOPE("thread_pool::task");
+			task(index);
+		}
+
+		return;
+	}
+
+	auto state = std::make_shared<batch>();
+	state->remaining = count;
+
+	// Count the tasks before queueing them, so that no worker can take more than announced
+	this->pending += count;
+
+	// Distribute tasks; workers submitting nested work keep it in their own queue
+	const bool is_worker = (current_pool == this);
+	std::size_t queue_index = is_worker ? current_index : this->next_queue.fetch_add(1) % this->queues.size();
+
+	for (std::size_t index = 0; index < count; ++index)
+	{
+		auto& queue = *this->queues[queue_index];
+
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.emplace_back([state, &task, index]()
+			{
+				try
+				{
+					CG_TRACE_SCOPE("thread_pool::task");
+					task(index);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(state->mutex);
+
+					if (!state->error)
+					{
+						state->error = std::current_exception();
+					}
+				}
+
+				if (--state->remaining == 0)
+				{
+					std::lock_guard<std::mutex> lock(state->mutex);
+					state->done.notify_all();
+				}
+			});
+		}
+
+		if (!is_worker)
+		{
+			queue_index = (queue_index + 1) % this->queues.size();
+		}
+	}
+
+	// Synchronize with workers that are about to wait, so that the notification is not lost
+	{
+		std::lock_guard<std::mutex> lock(this->wake_mutex);
+	}
+
+	this->wake.notify_all();
+
+	// Help processing tasks until the batch is complete
+	while (state->remaining != 0)
+	{
+		std::function<void()> next_task;
+
+		if (try_pop(next_task))
+		{
+			next_task();
+		}
+		else
+		{
+			std::unique_lock<std::mutex> lock(state->mutex);
+			state->done.wait(lock, [&state]() { return state->remaining == 0; });
+		}
+	}
+
+	if (state->error)
+	{
+		std::rethrow_exception(state->error);
+	}
+}
+
+void cg::thread_pool::parallel_for(const std::size_t begin, const std::size_t end, const std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body)
+{
+	if (end <= begin)
+	{
+		return;
+	}
+
+	// Create a few chunks per thread for load balancing, but none smaller than the grain
+	const std::size_t count = end - begin;
+	const std::size_t min_chunk = std::max<std::size_t>(grain, 1);
+	const std::size_t chunk = std::max(min_chunk, (count + 4 * get_thread_count() - 1) / (4 * get_thread_count()));
+	const std::size_t chunks = (count + chunk - 1) / chunk;
+
+	run(chunks, [&](const std::size_t index)
+	{
+		const std::size_t first = begin + index * chunk;
+		body(first, std::min(end, first + chunk));
+	});
+}
+
+void cg::thread_pool::work(const std::size_t index)
+{
+	current_pool = this;
+	current_index = index;
+
+	while (true)
+	{
+		std::function<void()> task;
+
+		if (try_pop(task))
+		{
+			task();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(this->wake_mutex);
+		this->wake.wait(lock, [this]() { return this->stopping || this->pending != 0; });
+
+		if (this->stopping && this->pending == 0)
+		{
+			return;
+		}
+	}
+}
+
+bool cg::thread_pool::try_pop(std::function<void()>& task)
+{
+	const std::size_t queue_count = this->queues.size();
+	const bool is_worker = (current_pool == this);
+
+	// Own queue first (newest task, likely still in cache), then steal the oldest task of others
+	const std::size_t first = is_worker ? current_index : 0;
+
+	for (std::size_t offset = 0; offset < queue_count; ++offset)
+	{
+		auto& queue = *this->queues[(first + offset) % queue_count];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (!queue.tasks.empty())
+		{
+			if (is_worker && offset == 0)
+			{
+				task = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+			}
+			else
+			{
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+			}
+
+			--this->pending;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cg
+{
+	/// <summary>
+	/// Work-stealing thread pool
+	/// Each worker owns a task queue; idle workers steal from the other queues.
+	/// Threads waiting for a batch of tasks help executing queued tasks.
+	/// </summary>
+	class thread_pool
+	{
+	public:
+		/// <summary>
+		/// Constructor
+		/// </summary>
+		/// <param name="thread_count">Number of threads including the calling thread (0: one per hardware thread)</param>
+		explicit thread_pool(std::size_t thread_count = 0);
+
+		/// <summary>
+		/// Destructor, waits for all workers to finish
+		/// </summary>
+		~thread_pool();
+
+		thread_pool(const thread_pool&) = delete;
+		thread_pool& operator=(const thread_pool&) = delete;
+
+		/// <summary>
+		/// Get the pool shared by all image operations
+		/// </summary>
+		/// <returns>Shared thread pool</returns>
+		static thread_pool& shared();
+
+		/// <summary>
+		/// Get number of threads participating in parallel work, including the calling thread
+		/// </summary>
+		/// <returns>Number of threads</returns>
+		std::size_t get_thread_count() const;
+
+		/// <summary>
+		/// Execute tasks with indices [0, count) and wait for their completion
+		/// The first exception thrown by a task is rethrown after all tasks have finished.
+		/// </summary>
+		/// <param name="count">Number of tasks</param>
+		/// <param name="task">Task, called with the task index</param>
+		void run(std::size_t count, const std::function<void(std::size_t)>& task);
+
+		/// <summary>
+		/// Split the range [begin, end) into chunks and process them in parallel
+		/// </summary>
+		/// <param name="begin">First index</param>
+		/// <param name="end">One past the last index</param>
+		/// <param name="grain">Minimum number of indices per chunk</param>
+		/// <param name="body">Function called with the sub-range [first, last)</param>
+		void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body);
+
+	private:
+		/// Task queue of a single worker
+		struct task_queue
+		{
+			std::mutex mutex;
+			std::deque<std::function<void()>> tasks;
+		};
+
+		/// <summary>
+		/// Main loop of a worker thread
+		/// </summary>
+		/// <param name="index">Worker index</param>
+		void work(std::size_t index);
+
+		/// <summary>
+		/// Take a task from the own queue or steal one from another queue
+		/// </summary>
+		/// <param name="task">Task taken</param>
+		/// <returns>True if a task was found</returns>
+		bool try_pop(std::function<void()>& task);
+
+		/// Worker threads and their queues
+		std::vector<std::thread> workers;
+		std::vector<std::unique_ptr<task_queue>> queues;
+
+		/// Number of queued tasks not yet taken by any thread
+		std::atomic<std::size_t> pending;
+
+		/// Queue to receive the next task submitted from outside the pool
+		std::atomic<std::size_t> next_queue;
+
+		/// Wake-up signalling for idle workers
+		std::mutex wake_mutex;
+		std::condition_variable wake;
+		bool stopping;
+	};
+}
@@ -0,0 +1,214 @@
+#include "TilePipeline.hpp"
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace cg
+{
+	namespace
+	{
+		/// Working set targeted per tile, roughly the size of a per-core L2 cache
+		constexpr std::size_t tile_cache_budget = 256 * 1024;
+
+		/// Bounds for the tile edge length
+		constexpr std::size_t min_tile_size = 32;
+		constexpr std::size_t max_tile_size = 1024;
+
+		/// <summary>
+		/// Scratch buffers for the intermediate results of one tile, one per stage
+		/// </summary>
+		using scratch_buffers = std::vector<std::vector<float>>;
+
+		/// <summary>
+		/// Grow a region by the given halo, limited to the image extents
+		/// </summary>
+		/// <param name="region">Region</param>
+		/// <param name="halo">Halo size</param>
+		/// <param name="width">Image width</param>
+		/// <param name="height">Image height</param>
+		/// <returns>Enlarged region</returns>
+		image_region expand(const image_region& region, const std::size_t halo, const std::size_t width, const std::size_t height)
+		{
+			image_region expanded;
+			expanded.x = region.x - std::min(region.x, halo);
+			expanded.y = region.y - std::min(region.y, halo);
+			expanded.width = std::min(width, region.x + region.width + halo) - expanded.x;
+			expanded.height = std::min(height, region.y + region.height + halo) - expanded.y;
+
+			return expanded;
+		}
+	}
+}
+
+cg::tile_pipeline::tile_pipeline() : width(0), height(0)
+{
+}
+
+std::size_t cg::tile_pipeline::add_stage(stage new_stage)
+{
+	for (const auto input : new_stage.inputs)
+	{
+		if (input >= this->stages.size())
+		{
+			throw std::runtime_error("Invalid pipeline stage");
+		}
+	}
+
+	this->stages.push_back(std::move(new_stage));
+
+	return this->stages.size() - 1;
+}
+
+void cg::tile_pipeline::execute(const std::size_t output, void* const target, std::size_t tile_size) const
+{
+	if (output >= this->stages.size())
+	{
+		throw std::runtime_error("Invalid pipeline stage");
+	}
+
+	const auto& output_stage = this->stages[output];
+
+	// Trivial pipeline: copy the input
+	if (output_stage.source != nullptr)
+	{
+		std::memcpy(target, output_stage.source, this->width * this->height * output_stage.pixel_size);
+		return;
+	}
+
+	// Find the stages contributing to the output, and the halo each of them has to provide.
+	// Stages are stored in topological order, so a single backward sweep suffices.
+	std::vector<bool> needed(output + 1, false);
+	std::vector<std::size_t> halo(output + 1, 0);
+	needed[output] = true;
+
+	for (std::size_t id = output + 1; id-- > 0;)
+	{
+		if (!needed[id])
+		{
+			continue;
+		}
+
+		for (const auto input : this->stages[id].inputs)
+		{
+			needed[input] = true;
+			halo[input] = std::max(halo[input], halo[id] + this->stages[id].radius);
+		}
+	}
+
+	// Derive tile size from the memory needed for intermediate results
+	if (tile_size == 0)
+	{
+		std::size_t bytes_per_pixel = 0;
+		std::size_t max_halo = 0;
+
+		for (std::size_t id = 0; id < output; ++id)
+		{
+			if (needed[id] && this->stages[id].source == nullptr)
+			{
+				bytes_per_pixel += this->stages[id].pixel_size;
+				max_halo = std::max(max_halo, halo[id]);
+			}
+		}
+
+		tile_size = max_tile_size;
+
+		if (bytes_per_pixel != 0)
+		{
+			const auto edge = static_cast<std::size_t>(std::sqrt(static_cast<double>(tile_cache_budget / bytes_per_pixel)));
+			tile_size = (edge > 2 * max_halo) ? edge - 2 * max_halo : 0;
+		}
+
+		tile_size = std::min(std::max(tile_size, min_tile_size), max_tile_size);
+	}
+
+	const std::size_t tiles_x = (this->width + tile_size - 1) / tile_size;
+	const std::size_t tiles_y = (this->height + tile_size - 1) / tile_size;
+
+	// Scratch buffers are recycled between tiles to keep them warm in cache
+	std::mutex scratch_mutex;
+	std::vector<std::unique_ptr<scratch_buffers>> scratch_pool;
+
+	thread_pool::shared().run(tiles_x * tiles_y, [&](const std::size_t tile_index)
+	{
+		std::unique_ptr<scratch_buffers> scratch;
+
+		{
+			std::lock_guard<std::mutex> lock(scratch_mutex);
+
+			if (!scratch_pool.empty())
+			{
+				scratch = std::move(scratch_pool.back());
+				scratch_pool.pop_back();
+			}
+		}
+
+		if (!scratch)
+		{
+			scratch.reset(new scratch_buffers(output + 1));
+		}
+
+		image_region tile_region;
+		tile_region.x = (tile_index % tiles_x) * tile_size;
+		tile_region.y = (tile_index / tiles_x) * tile_size;
+		tile_region.width = std::min(tile_size, this->width - tile_region.x);
+		tile_region.height = std::min(tile_size, this->height - tile_region.y);
+
+		std::vector<buffer_view> views(output + 1);
+		std::vector<buffer_view> inputs;
+
+		for (std::size_t id = 0; id <= output; ++id)
+		{
+			if (!needed[id])
+			{
+				continue;
+			}
+
+			const auto& current = this->stages[id];
+			auto& view = views[id];
+			view.region = expand(tile_region, halo[id], this->width, this->height);
+
+			if (current.source != nullptr)
+			{
+				// Read inputs in place
+				view.stride = this->width;
+				view.data = const_cast<char*>(static_cast<const char*>(current.source)) + (view.region.y * this->width + view.region.x) * current.pixel_size;
+
+				continue;
+			}
+
+			if (id == output)
+			{
+				// Write the result in place
+				view.stride = this->width;
+				view.data = static_cast<char*>(target) + (view.region.y * this->width + view.region.x) * current.pixel_size;
+			}
+			else
+			{
+				auto& buffer = (*scratch)[id];
+				buffer.resize(view.region.width * view.region.height * current.pixel_size / sizeof(float));
+
+				view.stride = view.region.width;
+				view.data = buffer.data();
+			}
+
+			inputs.clear();
+
+			for (const auto input : current.inputs)
+			{
+				inputs.push_back(views[input]);
+			}
+
+			current.kernel(inputs, view);
+		}
+
+		std::lock_guard<std::mutex> lock(scratch_mutex);
+		scratch_pool.push_back(std::move(scratch));
+	});
+}
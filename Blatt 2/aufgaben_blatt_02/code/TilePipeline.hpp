@@ -0,0 +1,370 @@
+#pragma once
+
+#include "Image.hpp"
+#include "ImageTraits.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+namespace cg
+{
+	/// <summary>
+	/// Rectangular region of an image
+	/// </summary>
+	struct image_region
+	{
+		std::size_t x;
+		std::size_t y;
+		std::size_t width;
+		std::size_t height;
+	};
+
+	/// <summary>
+	/// View onto the pixels of a tile
+	/// Pixels are addressed in image coordinates. Coordinates outside of the tile are clamped
+	/// to its border, which results in clamp-to-edge behaviour at the image borders.
+	/// </summary>
+	/// <tparam name="color_space">Color space (RGB, HSV, ...)</tparam>
+	template <color_space_t color_space>
+	class tile
+	{
+	public:
+		/// Tuple type for storing all color channels of a pixel
+		using tuple_type = typename image<color_space>::tuple_type;
+
+		/// <summary>
+		/// Constructor
+		/// </summary>
+		/// <param name="data">Pointer to the first pixel of the tile</param>
+		/// <param name="region">Covered image region</param>
+		/// <param name="stride">Number of pixels between two consecutive rows</param>
+		tile(tuple_type* data, const image_region& region, std::size_t stride);
+
+		/// <summary>
+		/// Get covered image region
+		/// </summary>
+		/// <returns>Image region</returns>
+		const image_region& get_region() const;
+
+		/// <summary>
+		/// Access pixel
+		/// </summary>
+		/// <param name="i">Index in x direction (image coordinates)</param>
+		/// <param name="j">Index in y direction (image coordinates)</param>
+		/// <returns>Pixel value</returns>
+		const tuple_type& at(std::ptrdiff_t i, std::ptrdiff_t j) const;
+		tuple_type& at(std::ptrdiff_t i, std::ptrdiff_t j);
+
+		const tuple_type& operator()(std::ptrdiff_t i, std::ptrdiff_t j) const;
+		tuple_type& operator()(std::ptrdiff_t i, std::ptrdiff_t j);
+
+		/// <summary>
+		/// Access a row of the tile without clamping
+		/// </summary>
+		/// <param name="j">Index in y direction (image coordinates)</param>
+		/// <returns>Pointer to the leftmost pixel of the row</returns>
+		const tuple_type* row(std::size_t j) const;
+		tuple_type* row(std::size_t j);
+
+	private:
+		/// Tile data
+		tuple_type* data;
+		image_region region;
+		std::size_t stride;
+	};
+
+	/// <summary>
+	/// Executor for pipelines of image operations
+	/// The stages form a directed acyclic graph and are evaluated tile by tile, so that intermediate
+	/// results stay in cache-sized buffers. Stages declare their footprint: pointwise stages only read
+	/// the pixel they write, stencil stages read a neighborhood of the given radius (halo).
+	/// Tiles are processed in parallel on the shared thread pool.
+	/// </summary>
+	class tile_pipeline
+	{
+	public:
+		/// <summary>
+		/// Handle for a stage of the pipeline
+		/// </summary>
+		/// <tparam name="color_space">Color space of the stage result</tparam>
+		template <color_space_t color_space>
+		struct node
+		{
+			std::size_t id;
+		};
+
+		/// <summary>
+		/// Constructor
+		/// </summary>
+		tile_pipeline();
+
+		/// <summary>
+		/// Add an input image; all inputs must have the same size
+		/// The image is referenced and must outlive the pipeline.
+		/// </summary>
+		/// <param name="source">Input image</param>
+		/// <returns>Stage handle</returns>
+		template <color_space_t color_space>
+		node<color_space> add_source(const image<color_space>& source);
+
+		/// <summary>
+		/// Add a pointwise stage
+		/// </summary>
+		/// <param name="input">Input stage</param>
+		/// <param name="function">Function mapping an input pixel to an output pixel</param>
+		/// <returns>Stage handle</returns>
+		template <color_space_t out, color_space_t in, typename function_t>
+		node<out> add_pointwise(node<in> input, function_t function);
+
+		/// <summary>
+		/// Add a pointwise stage combining two inputs
+		/// </summary>
+		/// <param name="first">First input stage</param>
+		/// <param name="second">Second input stage</param>
+		/// <param name="function">Function mapping two input pixels to an output pixel</param>
+		/// <returns>Stage handle</returns>
+		template <color_space_t out, color_space_t in1, color_space_t in2, typename function_t>
+		node<out> add_pointwise(node<in1> first, node<in2> second, function_t function);
+
+		/// <summary>
+		/// Add a stencil stage
+		/// The function is called once per tile with the input tile (including a halo of the given
+		/// radius, where available) and the output tile to be filled completely.
+		/// </summary>
+		/// <param name="input">Input stage</param>
+		/// <param name="radius">Radius of the neighborhood read for each output pixel</param>
+		/// <param name="function">Function (const tile&lt;in&gt;&amp; input, tile&lt;out&gt;&amp; output)</param>
+		/// <returns>Stage handle</returns>
+		template <color_space_t out, color_space_t in, typename function_t>
+		node<out> add_stencil(node<in> input, std::size_t radius, function_t function);
+
+		/// <summary>
+		/// Evaluate the pipeline
+		/// </summary>
+		/// <param name="output">Stage whose result is returned</param>
+		/// <param name="tile_size">Edge length of the tiles (0: derive from cache size)</param>
+		/// <returns>Resulting image</returns>
+		template <color_space_t color_space>
+		image<color_space> run(node<color_space> output, std::size_t tile_size = 0) const;
+
+	private:
+		/// Type-erased view onto stage data
+		struct buffer_view
+		{
+			void* data;
+			image_region region;
+			std::size_t stride;
+		};
+
+		/// Type-erased stage function
+		using kernel_type = std::function<void(const std::vector<buffer_view>& inputs, const buffer_view& output)>;
+
+		/// Stage of the pipeline
+		struct stage
+		{
+			std::vector<std::size_t> inputs;
+			std::size_t pixel_size;
+			std::size_t radius;
+			kernel_type kernel;
+			const void* source;
+		};
+
+		/// <summary>
+		/// Add a stage after checking its inputs
+		/// </summary>
+		/// <param name="new_stage">Stage</param>
+		/// <returns>Stage index</returns>
+		std::size_t add_stage(stage new_stage);
+
+		/// <summary>
+		/// Evaluate the pipeline into the given pixel storage
+		/// </summary>
+		/// <param name="output">Index of the stage to evaluate</param>
+		/// <param name="target">Pixel storage of the result image</param>
+		/// <param name="tile_size">Edge length of the tiles (0: derive from cache size)</param>
+		void execute(std::size_t output, void* target, std::size_t tile_size) const;
+
+		/// Stages in topological order
+		std::vector<stage> stages;
+
+		/// Size of the images processed
+		std::size_t width;
+		std::size_t height;
+	};
+}
+
+template <cg::color_space_t color_space>
+inline cg::tile<color_space>::tile(tuple_type* const data, const image_region& region, const std::size_t stride)
+	: data(data), region(region), stride(stride)
+{
+}
+
+template <cg::color_space_t color_space>
+inline const cg::image_region& cg::tile<color_space>::get_region() const
+{
+	return this->region;
+}
+
+template <cg::color_space_t color_space>
+inline const typename cg::tile<color_space>::tuple_type& cg::tile<color_space>::at(const std::ptrdiff_t i, const std::ptrdiff_t j) const
+{
+	const auto x = static_cast<std::ptrdiff_t>(this->region.x);
+	const auto y = static_cast<std::ptrdiff_t>(this->region.y);
+
+	const auto local_i = static_cast<std::size_t>(std::min(std::max(i, x), x + static_cast<std::ptrdiff_t>(this->region.width) - 1) - x);
+	const auto local_j = static_cast<std::size_t>(std::min(std::max(j, y), y + static_cast<std::ptrdiff_t>(this->region.height) - 1) - y);
+
+	return this->data[local_i + local_j * this->stride];
+}
+
+template <cg::color_space_t color_space>
+inline typename cg::tile<color_space>::tuple_type& cg::tile<color_space>::at(const std::ptrdiff_t i, const std::ptrdiff_t j)
+{
+	return const_cast<tuple_type&>(static_cast<const tile&>(*this).at(i, j));
+}
+
+template <cg::color_space_t color_space>
+inline const typename cg::tile<color_space>::tuple_type& cg::tile<color_space>::operator()(const std::ptrdiff_t i, const std::ptrdiff_t j) const
+{
+	return at(i, j);
+}
+
+template <cg::color_space_t color_space>
+inline typename cg::tile<color_space>::tuple_type& cg::tile<color_space>::operator()(const std::ptrdiff_t i, const std::ptrdiff_t j)
+{
+	return at(i, j);
+}
+
+template <cg::color_space_t color_space>
+inline const typename cg::tile<color_space>::tuple_type* cg::tile<color_space>::row(const std::size_t j) const
+{
+	return this->data + (j - this->region.y) * this->stride;
+}
+
+template <cg::color_space_t color_space>
+inline typename cg::tile<color_space>::tuple_type* cg::tile<color_space>::row(const std::size_t j)
+{
+	return this->data + (j - this->region.y) * this->stride;
+}
+
+template <cg::color_space_t color_space>
+inline cg::tile_pipeline::node<color_space> cg::tile_pipeline::add_source(const image<color_space>& source)
+{
+	// The first stage is always a source, since all other stages require inputs
+	if (this->stages.empty())
+	{
+		this->width = source.get_width();
+		this->height = source.get_height();
+	}
+	else if (this->width != source.get_width() || this->height != source.get_height())
+	{
+		throw std::runtime_error("Pipeline inputs must have the same size");
+	}
+
+	stage new_stage;
+	new_stage.pixel_size = sizeof(typename image<color_space>::tuple_type);
+	new_stage.radius = 0;
+	new_stage.source = source.get_data().data();
+
+	return node<color_space>{ add_stage(new_stage) };
+}
+
+template <cg::color_space_t out, cg::color_space_t in, typename function_t>
+inline cg::tile_pipeline::node<out> cg::tile_pipeline::add_pointwise(const node<in> input, function_t function)
+{
+	using in_tuple = typename image<in>::tuple_type;
+	using out_tuple = typename image<out>::tuple_type;
+
+	stage new_stage;
+	new_stage.inputs.push_back(input.id);
+	new_stage.pixel_size = sizeof(out_tuple);
+	new_stage.radius = 0;
+	new_stage.source = nullptr;
+	new_stage.kernel = [function](const std::vector<buffer_view>& inputs, const buffer_view& output)
+	{
+		const tile<in> source(static_cast<in_tuple*>(inputs[0].data), inputs[0].region, inputs[0].stride);
+		tile<out> target(static_cast<out_tuple*>(output.data), output.region, output.stride);
+
+		for (std::size_t j = output.region.y; j < output.region.y + output.region.height; ++j)
+		{
+			const in_tuple* source_row = &source.at(output.region.x, j);
+			out_tuple* target_row = target.row(j);
+
+			for (std::size_t i = 0; i < output.region.width; ++i)
+			{
+				target_row[i] = function(source_row[i]);
+			}
+		}
+	};
+
+	return node<out>{ add_stage(new_stage) };
+}
+
+template <cg::color_space_t out, cg::color_space_t in1, cg::color_space_t in2, typename function_t>
+inline cg::tile_pipeline::node<out> cg::tile_pipeline::add_pointwise(const node<in1> first, const node<in2> second, function_t function)
+{
+	using first_tuple = typename image<in1>::tuple_type;
+	using second_tuple = typename image<in2>::tuple_type;
+	using out_tuple = typename image<out>::tuple_type;
+
+	stage new_stage;
+	new_stage.inputs.push_back(first.id);
+	new_stage.inputs.push_back(second.id);
+	new_stage.pixel_size = sizeof(out_tuple);
+	new_stage.radius = 0;
+	new_stage.source = nullptr;
+	new_stage.kernel = [function](const std::vector<buffer_view>& inputs, const buffer_view& output)
+	{
+		const tile<in1> first_source(static_cast<first_tuple*>(inputs[0].data), inputs[0].region, inputs[0].stride);
+		const tile<in2> second_source(static_cast<second_tuple*>(inputs[1].data), inputs[1].region, inputs[1].stride);
+		tile<out> target(static_cast<out_tuple*>(output.data), output.region, output.stride);
+
+		for (std::size_t j = output.region.y; j < output.region.y + output.region.height; ++j)
+		{
+			const first_tuple* first_row = &first_source.at(output.region.x, j);
+			const second_tuple* second_row = &second_source.at(output.region.x, j);
+			out_tuple* target_row = target.row(j);
+
+			for (std::size_t i = 0; i < output.region.width; ++i)
+			{
+				target_row[i] = function(first_row[i], second_row[i]);
+			}
+		}
+	};
+
+	return node<out>{ add_stage(new_stage) };
+}
+
+template <cg::color_space_t out, cg::color_space_t in, typename function_t>
+inline cg::tile_pipeline::node<out> cg::tile_pipeline::add_stencil(const node<in> input, const std::size_t radius, function_t function)
+{
+	using in_tuple = typename image<in>::tuple_type;
+	using out_tuple = typename image<out>::tuple_type;
+
+	stage new_stage;
+	new_stage.inputs.push_back(input.id);
+	new_stage.pixel_size = sizeof(out_tuple);
+	new_stage.radius = radius;
+	new_stage.source = nullptr;
+	new_stage.kernel = [function](const std::vector<buffer_view>& inputs, const buffer_view& output)
+	{
+		const tile<in> source(static_cast<in_tuple*>(inputs[0].data), inputs[0].region, inputs[0].stride);
+		tile<out> target(static_cast<out_tuple*>(output.data), output.region, output.stride);
+
+		function(source, target);
+	};
+
+	return node<out>{ add_stage(new_stage) };
+}
+
+template <cg::color_space_t color_space>
+inline cg::image<color_space> cg::tile_pipeline::run(const node<color_space> output, const std::size_t tile_size) const
+{
+	image<color_space> result(this->width, this->height);
+	execute(output.id, result.get_data().data(), tile_size);
+
+	return result;
+}
@@ -0,0 +1,182 @@
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace cg
+{
+	namespace
+	{
+		static_assert((trace::buffer_capacity & (trace::buffer_capacity - 1)) == 0, "Trace buffer capacity must be a power of two");
+
+		/// <summary>
+		/// Recorded span
+		/// </summary>
+		struct span
+		{
+			const char* name;
+			std::uint64_t start;
+			std::uint64_t end;
+		};
+
+		/// <summary>
+		/// Ring buffer of the spans of one thread
+		/// Only the owning thread writes; the counter is published with release semantics, so that a
+		/// dump after the thread finished its work sees all spans.
+		/// </summary>
+		struct span_buffer
+		{
+			explicit span_buffer(const std::size_t thread) : thread(thread), spans(new span[trace::buffer_capacity]), written(0)
+			{
+			}
+
+			/// Sequential number of the thread, used as tid
+			const std::size_t thread;
+
+			std::unique_ptr<span[]> spans;
+
+			/// Number of spans ever written
+			std::atomic<std::uint64_t> written;
+		};
+
+		/// <summary>
+		/// All buffers of the process, dumped when the program exits
+		/// </summary>
+		class span_registry
+		{
+		public:
+			~span_registry()
+			{
+				const char* path = std::getenv("CG_TRACE_FILE");
+
+				try
+				{
+					write((path != nullptr && *path != '\0') ? path : "cg_trace.json");
+				}
+				catch (const std::exception& e)
+				{
+					std::cerr << e.what() << std::endl;
+				}
+			}
+
+			/// <summary>
+			/// Create the buffer of the calling thread
+			/// </summary>
+			/// <returns>Buffer, owned by the registry</returns>
+			span_buffer* add_buffer()
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+
+				this->buffers.emplace_back(new span_buffer(this->buffers.size()));
+				return this->buffers.back().get();
+			}
+
+			/// <summary>
+			/// Write all spans as Chrome trace JSON
+			/// </summary>
+			/// <param name="path">Path of the file</param>
+			void write(const std::string& path)
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				std::ofstream file(path);
+
+				if (!file.is_open())
+				{
+					throw std::runtime_error("Unable to open trace file " + path);
+				}
+
+				file << std::fixed << std::setprecision(3);
+				file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+
+				// Report times relative to the earliest span still in a buffer
+				std::uint64_t origin = std::numeric_limits<std::uint64_t>::max();
+
+				for (const auto& buffer : this->buffers)
+				{
+					const std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+
+					for (std::uint64_t index = (written > trace::buffer_capacity) ? written - trace::buffer_capacity : 0; index < written; ++index)
+					{
+						origin = std::min(origin, buffer->spans[index & (trace::buffer_capacity - 1)].start);
+					}
+				}
+
+				bool first = true;
+
+				for (const auto& buffer : this->buffers)
+				{
+					// Name the thread in the viewer
+					file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread
+						<< ",\"args\":{\"name\":\"thread " << buffer->thread << "\"}}";
+					first = false;
+
+					// Only the newest spans are kept once the ring buffer wrapped around
+					const std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+					const std::uint64_t oldest = (written > trace::buffer_capacity) ? written - trace::buffer_capacity : 0;
+
+					for (std::uint64_t index = oldest; index < written; ++index)
+					{
+						const span& recorded = buffer->spans[index & (trace::buffer_capacity - 1)];
+						// Names are string literals from the library and need no escaping
+						file << ",\n{\"name\":\"" << recorded.name << "\",\"cat\":\"cg\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread
+							<< ",\"ts\":" << static_cast<double>(recorded.start - origin) / 1e3 << ",\"dur\":" << static_cast<double>(recorded.end - recorded.start) / 1e3 << "}";
+					}
+				}
+
+				file << std::endl << "]}" << std::endl;
+
+				if (!file.good())
+				{
+					throw std::runtime_error("Unable to write trace file " + path);
+				}
+			}
+
+			/// Guards the list of buffers, not their contents
+			std::mutex mutex;
+			std::vector<std::unique_ptr<span_buffer>> buffers;
+		};
+
+		/// <summary>
+		/// Get the registry, created on first use
+		/// </summary>
+		/// <returns>Registry</returns>
+		span_registry& registry()
+		{
+			static span_registry instance;
+			return instance;
+		}
+
+		/// Buffer of the current thread (nullptr until its first span)
+		thread_local span_buffer* current_buffer = nullptr;
+	}
+}
+
+constexpr std::size_t cg::trace::buffer_capacity;
+
+void cg::trace::record(const char* name, const std::uint64_t start, const std::uint64_t end)
+{
+	if (current_buffer == nullptr)
+	{
+		current_buffer = registry().add_buffer();
+	}
+
+	span_buffer& buffer = *current_buffer;
+	const std::uint64_t index = buffer.written.load(std::memory_order_relaxed);
+
+	buffer.spans[index & (buffer_capacity - 1)] = span{ name, start, end };
+	buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void cg::trace::dump(const std::string& path)
+{
+	registry().write(path);
+}
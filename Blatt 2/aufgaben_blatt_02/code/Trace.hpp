@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cg
+{
+	/// <summary>
+	/// Scoped trace spans exported in the Chrome trace event format (chrome://tracing, Perfetto)
+	/// Spans are placed with CG_TRACE_SCOPE, which compiles to nothing unless CG_TRACE is defined
+	/// (CMake option CG_ENABLE_TRACE). Every thread records into its own ring buffer without locking;
+	/// only the first span of a thread takes a lock to register the buffer. When a buffer is full the
+	/// oldest spans are overwritten. At exit, all buffers are written to the file named by the
+	/// environment variable CG_TRACE_FILE (default: cg_trace.json).
+	/// </summary>
+	class trace
+	{
+	public:
+		/// Number of spans kept per thread (power of two)
+		static constexpr std::size_t buffer_capacity = 65536;
+
+		/// <summary>
+		/// Span recorded from construction to destruction
+		/// </summary>
+		class scope
+		{
+		public:
+			/// <summary>
+			/// Constructor, starts the span
+			/// </summary>
+			/// <param name="name">Name of the span; must be a string literal (only the pointer is kept)</param>
+			explicit scope(const char* name);
+
+			/// <summary>
+			/// Destructor, records the span
+			/// </summary>
+			~scope();
+
+			scope(const scope&) = delete;
+			scope& operator=(const scope&) = delete;
+
+		private:
+			const char* name;
+			std::uint64_t start;
+		};
+
+		/// <summary>
+		/// Get the current time
+		/// </summary>
+		/// <returns>Nanoseconds of a monotonic clock</returns>
+		static std::uint64_t now();
+
+		/// <summary>
+		/// Record a span of the calling thread
+		/// </summary>
+		/// <param name="name">Name of the span; must outlive the trace (string literal)</param>
+		/// <param name="start">Start time from now()</param>
+		/// <param name="end">End time from now()</param>
+		static void record(const char* name, std::uint64_t start, std::uint64_t end);
+
+		/// <summary>
+		/// Write all recorded spans as Chrome trace JSON
+		/// Must not be called while other threads record spans.
+		/// </summary>
+		/// <param name="path">Path of the file</param>
+		static void dump(const std::string& path);
+	};
+}
+
+inline cg::trace::scope::scope(const char* name) : name(name), start(now())
+{
+}
+
+inline cg::trace::scope::~scope()
+{
+	record(this->name, this->start, now());
+}
+
+inline std::uint64_t cg::trace::now()
+{
+	return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#ifdef CG_TRACE
+#define CG_TRACE_CONCAT_IMPL(first, second) first##second
+#define CG_TRACE_CONCAT(first, second) CG_TRACE_CONCAT_IMPL(first, second)
+#define CG_TRACE_SCOPE(name) const ::cg::trace::scope CG_TRACE_CONCAT(cg_trace_scope_, __LINE__)(name)
+#else
+#define CG_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,741 @@
+#include "Image.hpp"
+#include "ImageConverter.hpp"
+#include "ImageIO.hpp"
+#include "ImageManipulation.hpp"
+#include "ReportFormat.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CG_BENCHMARK_TSC
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define CG_BENCHMARK_TSC
+#endif
+
+#ifndef CG_IMAGE_DIRECTORY
+#define CG_IMAGE_DIRECTORY "../images"
+#endif
+
+namespace
+{
+	/// <summary>
+	/// Command line options
+	/// </summary>
+	struct options
+	{
+		/// Output format: json (one object per line), csv or text
+		std::string format = "json";
+
+		/// Directory containing the bundled images
+		std::string image_directory = CG_IMAGE_DIRECTORY;
+
+		/// Directory for the files written by the I/O benchmarks
+		std::string scratch_directory;
+
+		/// Only run benchmarks whose name contains this string
+		std::string filter;
+
+		/// Largest synthetic image in megapixels
+		double max_megapixels = 100.0;
+
+		/// Largest image for the (slow) plain text formats in megapixels
+		double max_plain_megapixels = 12.0;
+
+		/// Minimum number of runs per benchmark, and minimum total time to keep repeating for
+		std::size_t repetitions = 3;
+		double min_seconds = 0.25;
+	};
+
+	/// <summary>
+	/// Timing of a benchmark
+	/// </summary>
+	struct measurement
+	{
+		std::size_t runs;
+		double best_seconds;
+		double median_seconds;
+
+		/// Time stamp counter ticks of the best run (0 if unavailable)
+		std::uint64_t best_cycles;
+	};
+
+	/// <summary>
+	/// Image a group of benchmarks runs on
+	/// </summary>
+	struct test_image
+	{
+		std::string name;
+		std::unique_ptr<cg::image<cg::color_space_t::RGB>> rgb;
+		std::unique_ptr<cg::image<cg::color_space_t::Gray>> gray;
+	};
+
+	/// Maximum number of runs per benchmark
+	constexpr std::size_t max_runs = 1000;
+
+	/// <summary>
+	/// Read the time stamp counter
+	/// </summary>
+	/// <returns>Ticks (0 if unavailable)</returns>
+	inline std::uint64_t read_cycles()
+	{
+#ifdef CG_BENCHMARK_TSC
+		return __rdtsc();
+#else
+		return 0;
+#endif
+	}
+
+	/// <summary>
+	/// Writer for benchmark results
+	/// Results are written as soon as they are available, so that aborted runs keep their output.
+	/// </summary>
+	class report
+	{
+	public:
+		/// <summary>
+		/// Constructor
+		/// </summary>
+		/// <param name="format">Output format (json, csv or text)</param>
+		explicit report(const std::string& format) : format(format)
+		{
+			if (format == "csv")
+			{
+				std::cout << "benchmark,image,width,height,megapixels,bytes,threads,runs,best_seconds,median_seconds,megapixels_per_second,bytes_per_second,cycles_per_pixel" << std::endl;
+			}
+			else if (format == "text")
+			{
+				std::cout << std::left << std::setw(36) << "benchmark" << std::setw(24) << "image" << std::right << std::setw(12) << "size" << std::setw(10) << "MP/s"
+					<< std::setw(12) << "MB/s" << std::setw(12) << "cycles/px" << std::setw(12) << "best ms" << std::endl;
+			}
+			else if (format != "json")
+			{
+				throw std::runtime_error("Unknown output format: " + format);
+			}
+		}
+
+		/// <summary>
+		/// Write a result
+		/// </summary>
+		/// <param name="benchmark">Benchmark name</param>
+		/// <param name="image">Image name</param>
+		/// <param name="width">Image width</param>
+		/// <param name="height">Image height</param>
+		/// <param name="bytes">Bytes processed per run (read plus written)</param>
+		/// <param name="timing">Timing</param>
+		void add(const std::string& benchmark, const std::string& image, const std::size_t width, const std::size_t height, const std::uint64_t bytes, const measurement& timing)
+		{
+			const double pixels = static_cast<double>(width) * static_cast<double>(height);
+			const double megapixels_per_second = pixels / 1e6 / timing.best_seconds;
+			const double bytes_per_second = static_cast<double>(bytes) / timing.best_seconds;
+			const double cycles_per_pixel = static_cast<double>(timing.best_cycles) / pixels;
+			const std::size_t threads = cg::thread_pool::shared().get_thread_count();
+
+			std::ostringstream line;
+			line << std::setprecision(6);
+
+			if (this->format == "json")
+			{
+				line << "{\"benchmark\":\"" << cg::escape_json(benchmark) << "\",\"image\":\"" << cg::escape_json(image) << "\",\"width\":" << width << ",\"height\":" << height
+					<< ",\"megapixels\":" << pixels / 1e6 << ",\"bytes\":" << bytes << ",\"threads\":" << threads << ",\"runs\":" << timing.runs
+					<< ",\"best_seconds\":" << timing.best_seconds << ",\"median_seconds\":" << timing.median_seconds
+					<< ",\"megapixels_per_second\":" << megapixels_per_second << ",\"bytes_per_second\":" << bytes_per_second << ",\"cycles_per_pixel\":";
+
+				if (timing.best_cycles != 0)
+				{
+					line << cycles_per_pixel;
+				}
+				else
+				{
+					line << "null";
+				}
+
+				line << "}";
+			}
+			else if (this->format == "csv")
+			{
+				line << benchmark << "," << image << "," << width << "," << height << "," << pixels / 1e6 << "," << bytes << "," << threads << "," << timing.runs << ","
+					<< timing.best_seconds << "," << timing.median_seconds << "," << megapixels_per_second << "," << bytes_per_second << ",";
+
+				if (timing.best_cycles != 0)
+				{
+					line << cycles_per_pixel;
+				}
+			}
+			else
+			{
+				std::ostringstream size;
+				size << width << "x" << height;
+
+				line << std::left << std::setw(36) << benchmark << std::setw(24) << image << std::right << std::fixed << std::setprecision(1) << std::setw(12) << size.str()
+					<< std::setw(10) << megapixels_per_second << std::setw(12) << bytes_per_second / 1e6 << std::setw(12) << cycles_per_pixel
+					<< std::setw(12) << timing.best_seconds * 1e3;
+			}
+
+			std::cout << line.str() << std::endl;
+		}
+
+	private:
+		std::string format;
+	};
+
+	/// <summary>
+	/// Run a function repeatedly and time it
+	/// </summary>
+	/// <param name="settings">Options</param>
+	/// <param name="function">Function to time</param>
+	/// <returns>Timing</returns>
+	measurement measure(const options& settings, const std::function<void()>& function)
+	{
+		std::vector<double> seconds;
+		std::vector<std::uint64_t> cycles;
+		double total = 0.0;
+
+		while (seconds.size() < std::max<std::size_t>(settings.repetitions, 1) || (total < settings.min_seconds && seconds.size() < max_runs))
+		{
+			const auto start = std::chrono::steady_clock::now();
+			const auto start_cycles = read_cycles();
+
+			function();
+
+			const auto end_cycles = read_cycles();
+			const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			seconds.push_back(elapsed);
+			cycles.push_back(end_cycles - start_cycles);
+			total += elapsed;
+		}
+
+		const auto best = std::min_element(seconds.begin(), seconds.end()) - seconds.begin();
+
+		std::vector<double> sorted(seconds);
+		std::sort(sorted.begin(), sorted.end());
+
+		return measurement{ seconds.size(), seconds[best], sorted[sorted.size() / 2], cycles[best] };
+	}
+
+	/// <summary>
+	/// Get the size of a file
+	/// </summary>
+	/// <param name="path">Path</param>
+	/// <returns>Size in bytes</returns>
+	std::uint64_t file_size(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+		return file.good() ? static_cast<std::uint64_t>(file.tellg()) : 0;
+	}
+
+	/// <summary>
+	/// Get the number of bytes of the pixel data of an image
+	/// </summary>
+	/// <param name="original">Image</param>
+	/// <returns>Size in bytes</returns>
+	template <cg::color_space_t color_space>
+	std::uint64_t image_bytes(const cg::image<color_space>& original)
+	{
+		return static_cast<std::uint64_t>(original.get_data().size() * sizeof(typename cg::image<color_space>::tuple_type));
+	}
+
+	/// <summary>
+	/// Create a synthetic RGB image with smooth gradients, edges and noise
+	/// </summary>
+	/// <param name="width">Width</param>
+	/// <param name="height">Height</param>
+	/// <returns>Image</returns>
+	cg::image<cg::color_space_t::RGB> synthetic_image(const std::size_t width, const std::size_t height)
+	{
+		cg::image<cg::color_space_t::RGB> generated(width, height);
+		auto& pixels = generated.get_data();
+
+		cg::thread_pool::shared().parallel_for(0, height, 16, [&](const std::size_t first, const std::size_t last)
+		{
+			for (std::size_t j = first; j < last; ++j)
+			{
+				for (std::size_t i = 0; i < width; ++i)
+				{
+					// Cheap deterministic hash as noise
+					std::uint32_t hash = static_cast<std::uint32_t>(i * 73856093u) ^ static_cast<std::uint32_t>(j * 19349663u);
+					hash = (hash ^ (hash >> 13)) * 0x5bd1e995u;
+					const float noise = static_cast<float>(hash >> 24) / 255.f * 0.1f;
+
+					const float u = static_cast<float>(i) / static_cast<float>(width);
+					const float v = static_cast<float>(j) / static_cast<float>(height);
+					const float stripe = (((i / 64) + (j / 64)) % 2 == 0) ? 0.2f : 0.f;
+
+					pixels[j * width + i] = {{ std::min(u * 0.8f + noise + stripe, 1.f), std::min(v * 0.8f + noise, 1.f), std::min((1.f - u) * 0.7f + noise + stripe * 0.5f, 1.f) }};
+				}
+			}
+		});
+
+		return generated;
+	}
+
+	/// <summary>
+	/// Save a grayscale or RGB image as plain PGM/PPM with 16-bit values
+	/// image_io writes plain files with 8-bit values only, but reads both.
+	/// </summary>
+	/// <param name="path">Path</param>
+	/// <param name="values">Channel values of all pixels</param>
+	/// <param name="width">Width</param>
+	/// <param name="height">Height</param>
+	/// <param name="channels">Number of channels (1 or 3)</param>
+	void save_plain_wide(const std::string& path, const float* values, const std::size_t width, const std::size_t height, const std::size_t channels)
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << ((channels == 1) ? "P2" : "P3") << "\n" << width << " " << height << "\n65535\n";
+
+		std::string line;
+
+		for (std::size_t j = 0; j < height; ++j)
+		{
+			line.clear();
+
+			for (std::size_t k = 0; k < width * channels; ++k)
+			{
+				line += std::to_string(static_cast<unsigned int>(std::min(std::max(values[j * width * channels + k], 0.f), 1.f) * 65535.f));
+				line += ' ';
+			}
+
+			line += '\n';
+			file << line;
+		}
+
+		if (!file.good())
+		{
+			throw std::runtime_error("Unable to write file");
+		}
+	}
+
+	/// <summary>
+	/// Runs all benchmarks of an image
+	/// </summary>
+	class benchmark_runner
+	{
+	public:
+		/// <summary>
+		/// Constructor
+		/// </summary>
+		/// <param name="settings">Options</param>
+		/// <param name="output">Report</param>
+		benchmark_runner(const options& settings, report& output) : settings(settings), output(output)
+		{
+		}
+
+		/// <summary>
+		/// Run all benchmarks on an image, releasing intermediate images as early as possible
+		/// </summary>
+		/// <param name="input">Image; consumed</param>
+		void run(test_image& input)
+		{
+			if (input.rgb)
+			{
+				run_rgb(input);
+			}
+
+			run_gray(input);
+		}
+
+	private:
+		const options& settings;
+		report& output;
+
+		/// <summary>
+		/// Check whether a benchmark is selected
+		/// </summary>
+		/// <param name="name">Benchmark name</param>
+		/// <returns>True if selected</returns>
+		bool selected(const std::string& name) const
+		{
+			return name.find(this->settings.filter) != std::string::npos;
+		}
+
+		/// <summary>
+		/// Time an in-memory operation
+		/// </summary>
+		/// <param name="name">Benchmark name</param>
+		/// <param name="input">Test image</param>
+		/// <param name="original">Input of the operation</param>
+		/// <param name="operation">Operation</param>
+		template <cg::color_space_t in, typename function_t>
+		void compute(const std::string& name, const test_image& input, const cg::image<in>& original, const function_t& operation)
+		{
+			if (!selected(name))
+			{
+				return;
+			}
+
+			std::uint64_t bytes = 0;
+
+			const auto timing = measure(this->settings, [&]()
+			{
+				const auto result = operation(original);
+				bytes = image_bytes(original) + image_bytes(result);
+			});
+
+			this->output.add(name, input.name, original.get_width(), original.get_height(), bytes, timing);
+		}
+
+		/// <summary>
+		/// Time saving and loading an image in one file format
+		/// </summary>
+		/// <param name="name">Benchmark name suffix (format and precision)</param>
+		/// <param name="input">Test image</param>
+		/// <param name="width">Image width</param>
+		/// <param name="height">Image height</param>
+		/// <param name="plain">Plain text format</param>
+		/// <param name="save">Function saving the image to the given path; empty to time loading only</param>
+		/// <param name="load">Function loading the image from the given path</param>
+		/// <param name="prepare">Function writing the file to load if save is empty</param>
+		void io(const std::string& name, const test_image& input, const std::size_t width, const std::size_t height, const bool plain,
+			const std::function<void(const std::string&)>& save, const std::function<void(const std::string&)>& load, const std::function<void(const std::string&)>& prepare)
+		{
+			const bool save_selected = save && selected("save_" + name);
+			const bool load_selected = selected("load_" + name);
+
+			if ((!save_selected && !load_selected) || (plain && static_cast<double>(width) * static_cast<double>(height) > this->settings.max_plain_megapixels * 1e6))
+			{
+				return;
+			}
+
+			const std::string path = this->settings.scratch_directory + "/cg_benchmark_" + name;
+
+			if (save_selected)
+			{
+				const auto timing = measure(this->settings, [&]() { save(path); });
+				this->output.add("save_" + name, input.name, width, height, file_size(path), timing);
+			}
+			else
+			{
+				save ? save(path) : prepare(path);
+			}
+
+			if (load_selected)
+			{
+				const auto timing = measure(this->settings, [&]() { load(path); });
+				this->output.add("load_" + name, input.name, width, height, file_size(path), timing);
+			}
+
+			std::remove(path.c_str());
+		}
+
+		/// <summary>
+		/// Run the benchmarks on the RGB image and its HSV conversion; releases the RGB image
+		/// </summary>
+		/// <param name="input">Test image</param>
+		void run_rgb(test_image& input)
+		{
+			using namespace cg;
+
+			const auto& rgb = *input.rgb;
+			const std::size_t width = rgb.get_width();
+			const std::size_t height = rgb.get_height();
+
+			compute("rgb_to_gray", input, rgb, [](const image<color_space_t::RGB>& original) { return image_converter::rgb_to_gray(original); });
+			compute("rgb_to_hsv", input, rgb, [](const image<color_space_t::RGB>& original) { return image_converter::rgb_to_hsv(original); });
+
+			for (const bool plain : { false, true })
+			{
+				for (const bool wide : { false, true })
+				{
+					const std::string name = std::string("ppm_") + (plain ? "plain_" : "binary_") + (wide ? "16bit" : "8bit");
+					const auto load = [](const std::string& path) { image_io::load_rgb_image(path); };
+
+					if (plain && wide)
+					{
+						io(name, input, width, height, plain, nullptr, load, [&](const std::string& path)
+						{
+							save_plain_wide(path, rgb.get_values(), width, height, 3);
+						});
+					}
+					else
+					{
+						io(name, input, width, height, plain, [&](const std::string& path) { image_io::save_rgb_image(path, rgb, wide, plain); }, load, nullptr);
+					}
+				}
+			}
+
+			if (!input.gray)
+			{
+				input.gray.reset(new image<color_space_t::Gray>(image_converter::rgb_to_gray(rgb)));
+			}
+
+			if (selected("hsv_to_rgb") || selected("modify_in_hsv"))
+			{
+				const image<color_space_t::HSV> hsv = image_converter::rgb_to_hsv(rgb);
+				input.rgb.reset();
+
+				compute("hsv_to_rgb", input, hsv, [](const image<color_space_t::HSV>& original) { return image_converter::hsv_to_rgb(original); });
+				compute("modify_in_hsv", input, hsv, [](const image<color_space_t::HSV>& original) { return image_manipulation::modify_in_hsv(original); });
+			}
+
+			input.rgb.reset();
+		}
+
+		/// <summary>
+		/// Run the benchmarks on the grayscale image and its black-and-white conversion; releases both
+		/// </summary>
+		/// <param name="input">Test image</param>
+		void run_gray(test_image& input)
+		{
+			using namespace cg;
+
+			const auto& gray = *input.gray;
+			const std::size_t width = gray.get_width();
+			const std::size_t height = gray.get_height();
+
+			compute("gray_to_bw", input, gray, [](const image<color_space_t::Gray>& original) { return image_converter::gray_to_bw(original); });
+			compute("gray_to_bw_threshold", input, gray, [](const image<color_space_t::Gray>& original) { return image_converter::gray_to_bw(original, 0.5f); });
+			compute("gray_to_bw_adaptive", input, gray, [](const image<color_space_t::Gray>& original) { return image_converter::gray_to_bw_adaptive(original); });
+			compute("gray_to_bw_ordered", input, gray, [](const image<color_space_t::Gray>& original) { return image_converter::gray_to_bw_ordered(original); });
+			compute("gray_to_bw_floyd_steinberg", input, gray, [](const image<color_space_t::Gray>& original) { return image_converter::gray_to_bw_floyd_steinberg(original); });
+
+			for (const bool plain : { false, true })
+			{
+				for (const bool wide : { false, true })
+				{
+					const std::string name = std::string("pgm_") + (plain ? "plain_" : "binary_") + (wide ? "16bit" : "8bit");
+					const auto load = [](const std::string& path) { image_io::load_grayscale_image(path); };
+
+					if (plain && wide)
+					{
+						io(name, input, width, height, plain, nullptr, load, [&](const std::string& path)
+						{
+							save_plain_wide(path, gray.get_values(), width, height, 1);
+						});
+					}
+					else
+					{
+						io(name, input, width, height, plain, [&](const std::string& path) { image_io::save_grayscale_image(path, gray, wide, plain); }, load, nullptr);
+					}
+				}
+			}
+
+			if (selected("save_pbm_binary") || selected("load_pbm_binary") || selected("save_pbm_plain") || selected("load_pbm_plain"))
+			{
+				const image<color_space_t::BW> bw = image_converter::gray_to_bw(gray);
+				input.gray.reset();
+
+				for (const bool plain : { false, true })
+				{
+					io(std::string("pbm_") + (plain ? "plain" : "binary"), input, width, height, plain,
+						[&](const std::string& path) { image_io::save_bw_image(path, bw, plain); },
+						[](const std::string& path) { image_io::load_bw_image(path); }, nullptr);
+				}
+			}
+
+			input.gray.reset();
+		}
+	};
+
+	/// <summary>
+	/// Get the default directory for temporary files
+	/// </summary>
+	/// <returns>Directory</returns>
+	std::string temporary_directory()
+	{
+		for (const char* variable : { "TMPDIR", "TEMP", "TMP" })
+		{
+			const char* value = std::getenv(variable);
+
+			if (value != nullptr && *value != '\0')
+			{
+				return value;
+			}
+		}
+
+		return ".";
+	}
+
+	/// <summary>
+	/// Print the command line help
+	/// </summary>
+	void print_usage()
+	{
+		std::cerr << "Usage: ImageBenchmark [options]" << std::endl
+			<< "  --format json|csv|text   Output format (default: json, one object per line)" << std::endl
+			<< "  --images <directory>     Directory with lena.ppm, ginkgo.ppm and seattle.pgm" << std::endl
+			<< "  --scratch <directory>    Directory for the files written by the I/O benchmarks" << std::endl
+			<< "  --filter <text>          Only run benchmarks whose name contains the text" << std::endl
+			<< "  --max-mp <megapixels>    Largest synthetic image (default: 100)" << std::endl
+			<< "  --max-plain-mp <mp>      Largest image for plain text formats (default: 12)" << std::endl
+			<< "  --repetitions <count>    Minimum number of runs per benchmark (default: 3)" << std::endl
+			<< "  --min-time <seconds>     Keep repeating until this much time was spent (default: 0.25)" << std::endl;
+	}
+
+	/// <summary>
+	/// Parse the command line
+	/// </summary>
+	/// <param name="argc">Number of arguments</param>
+	/// <param name="argv">Arguments</param>
+	/// <returns>Options</returns>
+	options parse_options(const int argc, const char** argv)
+	{
+		options settings;
+		settings.scratch_directory = temporary_directory();
+
+		for (int index = 1; index < argc; ++index)
+		{
+			const std::string argument(argv[index]);
+
+			if (argument == "--help")
+			{
+				print_usage();
+				std::exit(0);
+			}
+
+			if (index + 1 >= argc)
+			{
+				throw std::runtime_error("Missing value for " + argument);
+			}
+
+			const std::string value(argv[++index]);
+
+			if (argument == "--format")
+			{
+				settings.format = value;
+			}
+			else if (argument == "--images")
+			{
+				settings.image_directory = value;
+			}
+			else if (argument == "--scratch")
+			{
+				settings.scratch_directory = value;
+			}
+			else if (argument == "--filter")
+			{
+				settings.filter = value;
+			}
+			else if (argument == "--max-mp")
+			{
+				settings.max_megapixels = std::stod(value);
+			}
+			else if (argument == "--max-plain-mp")
+			{
+				settings.max_plain_megapixels = std::stod(value);
+			}
+			else if (argument == "--repetitions")
+			{
+				settings.repetitions = static_cast<std::size_t>(std::stoul(value));
+			}
+			else if (argument == "--min-time")
+			{
+				settings.min_seconds = std::stod(value);
+			}
+			else
+			{
+				throw std::runtime_error("Unknown option: " + argument);
+			}
+		}
+
+		return settings;
+	}
+}
+
+int main(const int argc, const char** argv)
+{
+	try
+	{
+		const options settings = parse_options(argc, argv);
+		report output(settings.format);
+		benchmark_runner runner(settings, output);
+
+		// Bundled images; one that is missing or unreadable is skipped, so that the other results are still reported
+		const struct
+		{
+			const char* file;
+			bool gray;
+		}
+		bundled[] =
+		{
+			{ "lena.ppm", false },
+			{ "ginkgo.ppm", false },
+			{ "seattle.pgm", true }
+		};
+
+		for (const auto& image : bundled)
+		{
+			const std::string path = settings.image_directory + "/" + image.file;
+
+			test_image input;
+			input.name = image.file;
+
+			try
+			{
+				if (image.gray)
+				{
+					input.gray.reset(new cg::image<cg::color_space_t::Gray>(cg::image_io::load_grayscale_image(path)));
+				}
+				else
+				{
+					input.rgb.reset(new cg::image<cg::color_space_t::RGB>(cg::image_io::load_rgb_image(path)));
+				}
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << "Skipping " << path << ": " << e.what() << std::endl;
+				continue;
+			}
+
+			runner.run(input);
+		}
+
+		// Synthetic images from VGA to 100 megapixels
+		const struct
+		{
+			const char* name;
+			std::size_t width;
+			std::size_t height;
+		}
+		sizes[] =
+		{
+			{ "synthetic_vga", 640, 480 },
+			{ "synthetic_hd", 1280, 720 },
+			{ "synthetic_full_hd", 1920, 1080 },
+			{ "synthetic_4k", 3840, 2160 },
+			{ "synthetic_24mp", 6000, 4000 },
+			{ "synthetic_100mp", 10000, 10000 }
+		};
+
+		for (const auto& size : sizes)
+		{
+			if (static_cast<double>(size.width) * static_cast<double>(size.height) > settings.max_megapixels * 1e6)
+			{
+				continue;
+			}
+
+			test_image input;
+			input.name = size.name;
+			input.rgb.reset(new cg::image<cg::color_space_t::RGB>(synthetic_image(size.width, size.height)));
+
+			runner.run(input);
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		print_usage();
+
+		return 1;
+	}
+
+	return 0;
+}
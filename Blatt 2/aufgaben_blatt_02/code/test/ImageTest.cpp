@@ -0,0 +1,82 @@
+#include "Image.hpp"
+#include "ImageHistogram.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+
+namespace
+{
+	/// Number of failed checks
+	int failures = 0;
+
+	/// <summary>
+	/// Report a failed check
+	/// </summary>
+	/// <param name="passed">Result of the check</param>
+	/// <param name="name">Name of the check</param>
+	void check(const bool passed, const std::string& name)
+	{
+		if (!passed)
+		{
+			std::cerr << "FAILED: " << name << std::endl;
+			++failures;
+		}
+	}
+
+	/// <summary>
+	/// Check that histograms and equalization map NaN and out-of-range values to valid bins
+	/// </summary>
+	void test_histogram_clamping()
+	{
+		using namespace cg;
+
+		const float nan = std::numeric_limits<float>::quiet_NaN();
+
+		image<color_space_t::Gray> gray(4, 1);
+		gray(0, 0)[0] = nan;
+		gray(1, 0)[0] = -1.f;
+		gray(2, 0)[0] = 0.5f;
+		gray(3, 0)[0] = 2.f;
+
+		const histogram values = image_histogram::compute(gray);
+		const auto& counts = values.get_counts();
+
+		check(values.bin(nan) == 0, "NaN falls into the first bin");
+		check(values.get_total() == 4, "every pixel is counted once");
+		check(counts[0] == 2 && counts[128] == 1 && counts[255] == 1, "values are clamped to [0, 1]");
+
+		const auto equalized = image_histogram::equalize(gray);
+		bool finite = true;
+
+		for (std::size_t i = 0; i < equalized.get_width(); ++i)
+		{
+			finite = finite && std::isfinite(equalized(i, 0)[0]);
+		}
+
+		check(finite, "equalization of an image with NaN");
+
+		image<color_space_t::RGB> rgb(2, 1);
+		rgb(0, 0) = {{ nan, 0.25f, 1.f }};
+		rgb(1, 0) = {{ 0.f, nan, nan }};
+
+		const auto channels = image_histogram::compute(rgb);
+		check(channels[0].get_counts()[0] == 2 && channels[1].get_counts()[0] == 1 && channels[2].get_counts()[0] == 1, "NaN in RGB channels");
+	}
+}
+
+int main()
+{
+	test_histogram_clamping();
+
+	if (failures != 0)
+	{
+		std::cerr << failures << " checks failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "All checks passed" << std::endl;
+	return EXIT_SUCCESS;
+}